@@ -0,0 +1,121 @@
+// arena.h - per-query bump allocator on 2 MB huge pages
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Contest {
+
+/*
+ * Arena: memory of one query, released in bulk when the query ends.
+ *
+ * Hash table storage and intermediate value_t pages are allocated millions of times per
+ * batch and probed at random. The arena hands them out from 2 MB aligned chunks advised
+ * as transparent huge pages (one TLB entry per 2 MB instead of per 4 KB) with an atomic
+ * bump pointer, so threads allocate without locks; freeing a small block is a no-op.
+ * Blocks above kLargeBytes get their own huge-page mapping, which is unmapped on free
+ * (vectors that grow do not pile up dead copies).
+ *
+ * Every block is 64-byte aligned: blocks of different threads never share a cache line.
+ *
+ * ARENA=0 allocates from the heap instead (for experiments); ARENA_HUGETLB=1 tries
+ * explicitly reserved huge pages (MAP_HUGETLB) before falling back to madvise.
+ */
+class Arena {
+public:
+    static constexpr std::size_t kHugePage = 2u << 20;
+    static constexpr std::size_t kChunkBytes = 16u << 20;      // Small blocks come from these
+    static constexpr std::size_t kLargeBytes = 1u << 20;       // Own mapping from here on
+    static constexpr std::size_t kAlign = 64;
+
+    Arena() = default;
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t bytes);
+    void deallocate(void* p, std::size_t bytes);
+
+    // Unmap everything (every block handed out becomes invalid)
+    void release();
+
+    // Bytes mapped so far
+    std::size_t bytes_mapped() const { return mapped_.load(std::memory_order_relaxed); }
+
+    // Arena of the running query (nullptr = heap): the calling thread's Scope if it has one,
+    // the installed arena otherwise
+    static Arena* current();
+    // Make arena the one of the running query (nullptr = none)
+    static void install(Arena* arena);
+    static bool enabled();                                     // ARENA != 0
+
+    // Override current() on this thread, e.g. Scope(nullptr) for data outliving the query
+    class Scope {
+    public:
+        explicit Scope(Arena* arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        Arena* prev_;
+        bool prev_set_;
+    };
+
+private:
+    struct Chunk {
+        char* base;
+        std::size_t size;
+        std::atomic<std::size_t> used{0};
+    };
+
+    static void* map(std::size_t bytes);                       // Huge-page aligned mapping
+
+    std::atomic<Chunk*> current_{nullptr};
+    std::mutex mutex_;                                         // Guards chunks_/large_
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    std::vector<std::pair<void*, std::size_t>> large_;
+    std::atomic<std::size_t> mapped_{0};
+};
+
+// STL allocator over the arena current() at construction (heap when there is none).
+// Containers keep their allocator, so a vector resized by worker threads still draws
+// from the arena of the query that created it.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ArenaAllocator() noexcept : arena_(Arena::current()) {}
+    explicit ArenaAllocator(Arena* arena) noexcept : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        if (!arena_) return std::allocator<T>().allocate(n);
+        return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (!arena_) std::allocator<T>().deallocate(p, n);
+        else arena_->deallocate(p, n * sizeof(T));
+    }
+
+    Arena* arena() const noexcept { return arena_; }
+
+    friend bool operator==(const ArenaAllocator& a, const ArenaAllocator& b) noexcept { return a.arena_ == b.arena_; }
+    friend bool operator!=(const ArenaAllocator& a, const ArenaAllocator& b) noexcept { return a.arena_ != b.arena_; }
+
+private:
+    Arena* arena_;
+};
+
+} // namespace Contest
@@ -2,9 +2,12 @@
 
 #include <vector>
 #include <cstddef>
+#include <memory>
 #include "plan.h"
 #include "table.h"
 #include "late_materialization.h"
+#include "runtime_filter.h"
+#include "arena.h"
 
 namespace Contest {
 
@@ -15,9 +18,12 @@ static inline bool get_bitmap_local_col(const uint8_t* bitmap, uint16_t idx) {
     return bitmap[byte_idx] & (1u << bit);
 }
 
+// One page of an intermediate column, drawn from the query arena (Arena::current())
+using ValuePage = std::vector<value_t, ArenaAllocator<value_t>>;
+
 // Column storage with optional zero-copy for INT32 without NULLs to avoid materialization
 struct column_t {
-    std::vector<std::vector<value_t>> pages;    // Pages of stored value_t
+    std::vector<ValuePage> pages;               // Pages of stored value_t
 
     const Column* src_column = nullptr;         // Source for zero-copy (INT32 without NULL)
     std::vector<size_t> page_offsets;           // Cumulative offsets per page
@@ -26,6 +32,11 @@ struct column_t {
     size_t values_per_page = 1024;              // Page size in number of value_t
     size_t num_values = 0;                      // Total stored values
 
+    // Row-id intermediate: value i is ref_source[row_ids[i]]. Join outputs reference the
+    // scan output columns instead of copying value_t; all columns of one source share row_ids.
+    std::shared_ptr<const column_t> ref_source;             // Base column (never indirect itself)
+    std::shared_ptr<const std::vector<uint32_t>> row_ids;   // Rows of ref_source, one per value
+
     mutable size_t cached_page_idx = 0;         // Page cache for sequential access
 
     column_t() = default;
@@ -41,7 +52,12 @@ struct column_t {
         ++num_values;
     }
 
+    bool is_indirect() const { return ref_source != nullptr; }
+
     const value_t& get(size_t row_idx) const {
+        // ROW-ID path: read the base column
+        if (ref_source) return ref_source->get((*row_ids)[row_idx]);
+
         // ZERO-COPY path: avoids materialization and bitmap checks
         if (is_zero_copy && src_column != nullptr) {
             static thread_local value_t tmp;
@@ -95,6 +111,8 @@ struct column_t {
 
     // Thread-safe accessor without shared mutable state (returns by value)
     value_t get_cached(size_t row_idx, size_t& page_cache) const {
+        if (ref_source) return ref_source->get_cached((*row_ids)[row_idx], page_cache);
+
         if (is_zero_copy && src_column != nullptr) {
             size_t page_idx = page_cache;
             if (page_idx >= page_offsets.size() - 1) page_idx = 0;
@@ -107,6 +125,12 @@ struct column_t {
             else if (page_idx + 1 < page_offsets.size() - 1 && row_idx >= page_offsets[page_idx + 1] &&
                      row_idx < page_offsets[page_idx + 2]) {
                 ++page_idx;
+            }
+            // Random access (through row ids): equally filled pages need no search
+            else if (const size_t guess = page_offsets[1] ? row_idx / page_offsets[1] : 0;
+                     guess + 1 < page_offsets.size() && row_idx >= page_offsets[guess] &&
+                     row_idx < page_offsets[guess + 1]) {
+                page_idx = guess;
             } else {
                 size_t left = 0, right = page_offsets.size() - 1;
                 while (left < right - 1) {
@@ -158,9 +182,13 @@ struct ColumnBuffer {
 };
 
 // Columnar operations
+// Rows failing any of the runtime filters, or not set in the optional row selection
+// (one byte per base row), are not materialized
 ColumnBuffer scan_columnar_to_columnbuffer(const Plan& plan,
     const ScanNode& scan,
-    const std::vector<std::tuple<size_t, DataType>>& output_attrs);
+    const std::vector<std::tuple<size_t, DataType>>& output_attrs,
+    const std::vector<ScanFilter>& filters = {},
+    const std::vector<uint8_t>* selection = nullptr);
 
 ColumnBuffer join_columnbuffer_hash(const Plan& plan,
     const JoinNode& join,
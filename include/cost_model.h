@@ -0,0 +1,74 @@
+// cost_model.h - measured costs that decide thread counts and morsel sizes
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Contest {
+
+class ThreadPool;
+
+/*
+ * Self-calibrating cost model.
+ *
+ * Whether an operator should run in parallel depends on how long its work takes compared
+ * to waking the pool, and both differ a lot between machines (a 40-core server and a
+ * 4-core instance disagree by an order of magnitude). Instead of fixed row thresholds, the
+ * context measures once:
+ *
+ * - wakeup_ns:      one ThreadPool::run() over every thread with empty tasks
+ * - probe_cache_ns: one batched probe of a hash table that fits in L2
+ * - probe_dram_ns:  one batched probe of a hash table twice the LLC, capped at
+ *                   kMaxDramProbeBytes (on hosts with a larger LLC this is partly an LLC cost)
+ * - cell_ns:        one output cell gathered through a row id (materialization)
+ *
+ * Operators turn their input size into time with these and ask threads_for() and
+ * morsel_rows(). The measurements are kept in a profile (profile_path()) and read from there
+ * by later processes, so only the first one on a host pays for calibrating.
+ * COST_PROFILE=<file> chooses the file; COST_CALIBRATION=0 skips the measurement and uses
+ * defaults().
+ */
+struct CostModel {
+    double wakeup_ns = 20000;
+    double probe_cache_ns = 3;
+    double probe_dram_ns = 15;
+    double cell_ns = 2;
+
+    // Threads worth using for items of item_ns each, at most max_threads: every thread
+    // must get kMinWakeupsPerThread wake-up costs worth of work.
+    std::size_t threads_for(std::size_t items, double item_ns, std::size_t max_threads) const;
+
+    // Items per morsel so that one morsel takes about kMorselNs (claiming one stays noise)
+    std::size_t morsel_rows(double item_ns) const;
+
+    // Cost of one probe into a table of table_bytes (cache cost up to L2, DRAM cost from
+    // the LLC on, geometric interpolation in between)
+    double probe_ns(std::size_t table_bytes) const;
+
+    // Constants close to the former hard-coded thresholds
+    static CostModel defaults() { return CostModel{}; }
+    // Measure on pool (a few hundred milliseconds, most of it building the DRAM table)
+    static CostModel calibrate(ThreadPool& pool);
+
+    // Persisted profile ("name value" lines); load() returns false if path cannot be read
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    // COST_PROFILE, else <temp dir>/join_cost_profile_<num_threads>t (the wake-up cost depends
+    // on the pool size); empty if there is no temp directory
+    static std::string profile_path(std::size_t num_threads);
+
+    // Model of the current context (defaults() before/without a context)
+    static const CostModel& current();
+    // Make model the current one (nullptr restores defaults())
+    static void install(const CostModel* model);
+    // Process-wide model: loaded or calibrated on first use, see above
+    static const CostModel& process_default();
+
+    static constexpr double kMinWakeupsPerThread = 4;    // Wake-up overhead stays below 25%
+    static constexpr double kMorselNs = 20000;           // Target time of one morsel
+    static constexpr std::size_t kMinMorselRows = 256;
+    static constexpr std::size_t kMaxMorselRows = 1u << 16;
+    static constexpr std::size_t kMaxDramProbeBytes = std::size_t{64} << 20;
+};
+
+} // namespace Contest
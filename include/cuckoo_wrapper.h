@@ -3,6 +3,8 @@
 
 #include "hashtable_interface.h" 
 #include "cuckoo.h" 
+#include "key_groups.h"
+#include "plan.h"
 #include <memory>
 #include <stdexcept>
 
@@ -24,38 +26,16 @@ public:
     bool build_from_zero_copy_int32(const Column* src_column,
                                     const std::vector<std::size_t>& page_offsets,
                                     std::size_t num_rows) override {
-        // Cuckoo backend doesn't support zero-copy directly, so we materialize entries
         if (num_rows == 0 || src_column == nullptr || page_offsets.size() < 2) {
             return false;
         }
-
-        std::vector<HashEntry<Key>> entries;
-        entries.reserve(num_rows);
-
-        const std::size_t npages = page_offsets.size() - 1;
-        for (std::size_t page_idx = 0; page_idx < npages; ++page_idx) {
-            const std::size_t base = page_offsets[page_idx];
-            const std::size_t end = page_offsets[page_idx + 1];
-            const std::size_t n = end - base;
-            auto* page = src_column->pages[page_idx]->data;
-            auto* data = reinterpret_cast<const int32_t*>(page + 4);
-
-            for (std::size_t i = 0; i < n; ++i) {
-                entries.push_back({static_cast<Key>(data[i]), static_cast<uint32_t>(base + i)});
-            }
-        }
-
-        build_from_entries(entries);
+        // Pages are partitioned and grouped in place, no entry vector is materialized
+        backend_.build(group_keys<Key>(src_column, page_offsets, num_rows));
         return true;
     }
 
     void build_from_entries(const std::vector<HashEntry<Key>>& entries) override {
-        // Adapter layer: the backend expects std::pair<Key,size_t>.
-        // The conversion has some overhead; this is not the default fastest path (unchained).
-        std::vector<std::pair<Key, size_t>> pairs;
-        pairs.reserve(entries.size());
-        for (const auto &e : entries) pairs.emplace_back(e.key, static_cast<size_t>(e.row_id));
-        backend_.build_from_entries(pairs);
+        backend_.build(group_keys<Key>(entries));
     }
 
     const HashEntry<Key>* probe(const Key& key, size_t& len) const override {
@@ -68,12 +48,8 @@ public:
         // Return the pointer to the HashEntry
         return result.first; 
     }
-};
 
-template <typename Key>
-std::unique_ptr<IHashTable<Key>> create_hashtable() {
-   
-    return std::make_unique<CuckooHashTableWrapper<Key>>();
-}
+    size_t memory_usage() const override { return backend_.memory_usage(); }
+};
 
-} // namespace Contest
\ No newline at end of file
+} // namespace Contest
@@ -0,0 +1,165 @@
+// dense_array_table.h - direct-mapped "array join" table for dense INT32 build keys
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "plan.h"
+#include "hash_common.h"
+#include "hashtable_interface.h"
+#include "thread_pool.h"
+
+namespace Contest {
+
+/*
+ * Array join.
+ *
+ * Build sides of PK-FK joins are mostly primary keys whose values fill a small range
+ * [min, max]. Then key - min indexes an array directly, and a probe is one bitmap test plus
+ * one load, with no hashing and no bucket scan:
+ *
+ * - unique keys: slots_[key - min] holds the (key, row_id) entry, valid_ marks used slots
+ * - duplicates:  entries_ is grouped by key (counting sort), offsets_[key - min] is the
+ *                start of the group and offsets_[key - min + 1] its end
+ *
+ * The unique layout is tried first (parallel, one owner per slot); the first duplicate
+ * switches to the grouped layout.
+ */
+
+constexpr std::size_t kDenseMaxRangeFactor = 4;           // Slots per build row at most
+constexpr uint64_t kDenseMaxRange = 1ull << 30;           // Keeps offsets_ / slots_ allocatable
+
+// Whether keys in [min_key, max_key] from num_rows rows are dense enough for an array join
+inline bool dense_array_fits(int32_t min_key, int32_t max_key, std::size_t num_rows) {
+    if (num_rows == 0 || max_key < min_key) return false;
+    const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max_key) - min_key) + 1;
+    return range <= kDenseMaxRange && range <= kDenseMaxRangeFactor * static_cast<uint64_t>(num_rows);
+}
+
+class DenseArrayTable : public IHashTable<int32_t> {
+public:
+    using Key = int32_t;
+
+    DenseArrayTable(Key min_key, Key max_key)
+        : min_(min_key), range_(static_cast<uint64_t>(static_cast<int64_t>(max_key) - min_key) + 1) {}
+
+    void reserve(size_t /*capacity*/) override {}        // Sized by the key range
+
+    void build_from_entries(const std::vector<HashEntry<Key>>& entries) override {
+        const std::size_t n = entries.size();
+        constexpr std::size_t kChunk = 1u << 16;
+        build((n + kChunk - 1) / kChunk, n, [&](std::size_t chunk, auto&& emit) {
+            const std::size_t end = std::min(n, (chunk + 1) * kChunk);
+            for (std::size_t i = chunk * kChunk; i < end; ++i) emit(entries[i].key, entries[i].row_id);
+        });
+    }
+
+    bool build_from_zero_copy_int32(const Column* src_column, const std::vector<std::size_t>& page_offsets,
+                                    std::size_t num_rows) override {
+        build(page_offsets.size() - 1, num_rows, [&](std::size_t page, auto&& emit) {
+            const std::size_t base = page_offsets[page];
+            const std::size_t n = page_offsets[page + 1] - base;
+            auto* data = reinterpret_cast<const int32_t*>(src_column->pages[page]->data + 4);
+            for (std::size_t i = 0; i < n; ++i) emit(data[i], static_cast<uint32_t>(base + i));
+        });
+        return true;
+    }
+
+    const HashEntry<Key>* probe(const Key& key, size_t& len) const override {
+        len = 0;
+        const uint64_t d = static_cast<uint64_t>(static_cast<int64_t>(key) - min_);
+        if (d >= range_) return nullptr;                    // Also catches key < min
+        if (unique_) {
+            if (!(valid_[d / 64].load(std::memory_order_relaxed) & (1ull << (d % 64)))) return nullptr;
+            len = 1;
+            return &slots_[d];
+        }
+        len = offsets_[d + 1] - offsets_[d];
+        return len ? &entries_[offsets_[d]] : nullptr;
+    }
+
+    void probe_batch(const Key* keys, size_t n, std::vector<ProbeMatch>& out) const override {
+        for (size_t i = 0; i < n; ++i) {
+            size_t len = 0;
+            const HashEntry<Key>* group = probe(keys[i], len);
+            for (size_t k = 0; k < len; ++k) out.push_back(ProbeMatch{static_cast<uint32_t>(i), group[k].row_id});
+        }
+    }
+
+    size_t count_batch(const Key* keys, size_t n) const override {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            size_t len = 0;
+            probe(keys[i], len);
+            count += len;
+        }
+        return count;
+    }
+
+    bool unique() const { return unique_; }
+
+    size_t memory_usage() const override {
+        if (unique_) return range_ * sizeof(HashEntry<Key>) + (range_ + 63) / 64 * sizeof(uint64_t);
+        return offsets_.size() * sizeof(uint32_t) + entries_.size() * sizeof(HashEntry<Key>);
+    }
+
+private:
+    // for_each_chunk(chunk, emit) must call emit(key, row_id) for every entry of the chunk;
+    // all keys are within [min_, min_ + range_).
+    template <typename ForEachChunk>
+    void build(std::size_t num_chunks, std::size_t num_rows, ForEachChunk&& for_each_chunk) {
+        ThreadPool& pool = ThreadPool::current();
+
+        // Unique layout: the first writer of a slot owns it, a second one marks a duplicate
+        valid_ = std::make_unique<std::atomic<uint64_t>[]>((range_ + 63) / 64);  // Value-initialized: 0
+        slots_.resize(range_);                                                   // Not zeroed, guarded by valid_
+        std::atomic<bool> duplicate{false};
+        pool.for_each_morsel(num_chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end && !duplicate.load(std::memory_order_relaxed); ++c) {
+                for_each_chunk(c, [&](Key key, uint32_t row_id) {
+                    const uint64_t d = static_cast<uint64_t>(static_cast<int64_t>(key) - min_);
+                    const uint64_t bit = 1ull << (d % 64);
+                    if (valid_[d / 64].fetch_or(bit, std::memory_order_relaxed) & bit) {
+                        duplicate.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                    slots_[d] = HashEntry<Key>{key, row_id};
+                });
+            }
+        });
+        if (!duplicate.load()) return;
+
+        // Grouped layout: counting sort by key
+        unique_ = false;
+        valid_.reset();
+        slots_ = {};
+        offsets_.assign(range_ + 1, 0);
+        for (std::size_t c = 0; c < num_chunks; ++c)
+            for_each_chunk(c, [&](Key key, uint32_t) { ++offsets_[static_cast<int64_t>(key) - min_ + 1]; });
+        for (uint64_t d = 0; d < range_; ++d) offsets_[d + 1] += offsets_[d];
+
+        entries_.resize(num_rows);
+        std::vector<uint32_t> cursor(offsets_.begin(), offsets_.end() - 1);
+        for (std::size_t c = 0; c < num_chunks; ++c)
+            for_each_chunk(c, [&](Key key, uint32_t row_id) {
+                entries_[cursor[static_cast<int64_t>(key) - min_]++] = HashEntry<Key>{key, row_id};
+            });
+        entries_.resize(offsets_[range_]);
+    }
+
+    Key min_;
+    uint64_t range_;                                       // max - min + 1
+    bool unique_ = true;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> valid_;       // Unique layout: used slots
+    std::vector<HashEntry<Key>, DefaultInitAllocator<HashEntry<Key>>> slots_;
+
+    std::vector<uint32_t> offsets_;                        // Grouped layout: range_ + 1 group bounds
+    std::vector<HashEntry<Key>, DefaultInitAllocator<HashEntry<Key>>> entries_;
+};
+
+} // namespace Contest
@@ -3,6 +3,10 @@
 
 #include <cstddef>
 #include <cstdint> // For fixed-width types like int32_t
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace Contest {
 
@@ -15,6 +19,12 @@ struct HashEntry {
     // Note: row_id fits in uint32_t for all contest datasets -> reduced memory/traffic in buckets.
 };
 
+// One match of a batched probe: index of the key within the batch + build row id
+struct ProbeMatch {
+    uint32_t probe_idx;
+    uint32_t build_row;
+};
+
 // This holds the information stored in the hash table array slots.
 template<typename Key>
 struct KeyIndexInfo {
@@ -24,4 +34,26 @@ struct KeyIndexInfo {
     bool is_valid = false; // Whether this slot is occupied
 };
 
-} // namespace Contest
\ No newline at end of file
+// DefaultInitAllocator: allocator (std::allocator unless Base says otherwise) that
+// default-initializes on resize().
+// For trivial entry types resize() leaves memory untouched instead of zeroing it
+// on one thread; parallel scatters are then the first (and only) writers.
+template<typename T, typename Base = std::allocator<T>>
+struct DefaultInitAllocator : Base {
+    template<typename U> struct rebind {
+        using other = DefaultInitAllocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+    };
+
+    using Base::Base;
+    DefaultInitAllocator() = default;
+    DefaultInitAllocator(const Base& base) noexcept : Base(base) {}
+    template<typename U, typename B> DefaultInitAllocator(const DefaultInitAllocator<U, B>& other) noexcept
+        : Base(other) {}
+
+    template<typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) { ::new (static_cast<void*>(p)) U; }
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) { ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+};
+
+} // namespace Contest
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 
 namespace Hash {
 
@@ -29,6 +30,33 @@ struct Fibonacci32 {
     }
 };
 
+//
+// Byte strings (VARCHAR join keys)
+//
+// 8 bytes per step, each word mixed with a 64-bit finalizer (splitmix64). seed chains the
+// chunks of a string stored over several pages: bytes64(b, bytes64(a)) hashes a then b.
+//
+inline uint64_t mix64(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline uint64_t bytes64(const char* data, size_t len, uint64_t seed = 0) noexcept {
+    uint64_t h = seed ^ (len * 11400714819323198485ULL);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ mix64(word)) * 11400714819323198485ULL;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, len - i);
+    return mix64(h ^ mix64(tail + (len - i)));
+}
+
 //
 // CRC32 (optional hash), e.g. for benchmarking
 //
@@ -0,0 +1,42 @@
+// hashtable_backend.h - runtime choice of the hash table implementation used by joins
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "hashtable_interface.h"
+#include "unchained_hashtable_wrapper.h"
+#include "robinhood_wrapper.h"
+#include "cuckoo_wrapper.h"
+#include "hopscotch_wrapper.h"
+
+namespace Contest {
+
+/*
+ * All four implementations are compiled in; create_hashtable() picks one per call.
+ * The process default is read from HASH_TABLE=unchained|robinhood|cuckoo|hopscotch
+ * (unchained when unset or unknown); set_hashtable_backend() overrides it, e.g. to
+ * compare the backends on the same plans within one run.
+ */
+enum class HashTableBackend { Unchained, RobinHood, Cuckoo, Hopscotch };
+
+// Backend named name ("unchained", "robinhood", "cuckoo", "hopscotch"), nullopt if unknown
+std::optional<HashTableBackend> parse_hashtable_backend(std::string_view name);
+const char* hashtable_backend_name(HashTableBackend backend);
+
+HashTableBackend hashtable_backend();
+void set_hashtable_backend(HashTableBackend backend);
+
+template <typename Key>
+std::unique_ptr<IHashTable<Key>> create_hashtable(HashTableBackend backend = hashtable_backend()) {
+    switch (backend) {
+    case HashTableBackend::RobinHood: return std::make_unique<RobinHoodHashTableWrapper<Key>>();
+    case HashTableBackend::Cuckoo: return std::make_unique<CuckooHashTableWrapper<Key>>();
+    case HashTableBackend::Hopscotch: return std::make_unique<HopscotchHashTableWrapper<Key>>();
+    case HashTableBackend::Unchained: break;
+    }
+    return std::make_unique<UnchainedHashTableWrapper<Key>>();
+}
+
+} // namespace Contest
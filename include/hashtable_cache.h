@@ -0,0 +1,74 @@
+// hashtable_cache.h - join hash tables kept across the queries of one context
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include <hardware.h>
+#include "hashtable_interface.h"
+
+namespace Contest {
+
+/*
+ * Cross-query hash table cache.
+ *
+ * A batch runs many queries over the same (filtered) base tables, and their joins build
+ * the same tables over the same dimension columns again and again (kind_type.id,
+ * info_type.id, ...). A table built over a whole base column only depends on the column
+ * contents, so it is kept here keyed by the table's source (the cache file, whose name
+ * encodes the table filter) and the column index. Row ids in the table are base rows, so
+ * they stay valid for every later load of the same file.
+ *
+ * Entries are evicted least recently used first once the budget is exceeded; a table
+ * still used by a running join stays alive through its shared_ptr. find() and insert()
+ * may be called from concurrently executing subtrees.
+ */
+
+constexpr std::size_t kHashTableCacheDefaultMB = SPC__NUMA_NODE_DRAM_MB / 32;
+
+class HashTableCache {
+public:
+    struct Entry {
+        std::shared_ptr<const IHashTable<int32_t>> table;
+        std::size_t build_rows = 0;                      // Rows inserted into the table
+        std::size_t bytes = 0;                           // Charged against the budget
+    };
+
+    explicit HashTableCache(std::size_t budget_bytes = default_budget()) : budget_(budget_bytes) {}
+
+    // Entry of key (and mark it recently used), nullptr on a miss; stays valid after eviction
+    std::shared_ptr<const Entry> find(const std::string& key);
+
+    // Add a table; tables larger than the whole budget are not kept
+    void insert(const std::string& key, std::shared_ptr<const IHashTable<int32_t>> table,
+                std::size_t build_rows);
+
+    std::size_t size() const { std::lock_guard<std::mutex> lock(mutex_); return entries_.size(); }
+    std::size_t memory_usage() const { std::lock_guard<std::mutex> lock(mutex_); return used_; }
+    std::size_t budget() const { return budget_; }   // Fixed at construction
+    uint64_t hits() const { std::lock_guard<std::mutex> lock(mutex_); return hits_; }
+    uint64_t misses() const { std::lock_guard<std::mutex> lock(mutex_); return misses_; }
+
+    // HT_CACHE_MB overrides kHashTableCacheDefaultMB (0 disables the cache)
+    static std::size_t default_budget();
+
+private:
+    using Lru = std::list<std::pair<std::string, std::shared_ptr<const Entry>>>;  // Most recently used first
+
+    void evict_to(std::size_t bytes);
+
+    mutable std::mutex mutex_;                           // Guards everything but budget_
+    std::size_t budget_;
+    std::size_t used_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    Lru lru_;
+    std::unordered_map<std::string, Lru::iterator> entries_;
+};
+
+} // namespace Contest
@@ -41,10 +41,35 @@ public:
     // len is set to the number of entries found for the key.
     // Returns a pointer to the start of the bucket/chain, or nullptr if not found.
     virtual const HashEntry<Key>* probe(const Key& key, size_t& len) const = 0;
+
+    // Bytes held by the table (0 = unknown)
+    virtual size_t memory_usage() const { return 0; }
+
+    // Batched probe: appends a ProbeMatch for every build entry equal to keys[i], i in [0, n).
+    // Implementations can overlap the cache misses of the whole batch; the default
+    // simply probes one key at a time.
+    virtual void probe_batch(const Key* keys, size_t n, std::vector<ProbeMatch>& out) const {
+        for (size_t i = 0; i < n; ++i) {
+            size_t len = 0;
+            const HashEntry<Key>* bucket = probe(keys[i], len);
+            for (size_t k = 0; k < len; ++k)
+                if (bucket[k].key == keys[i]) out.push_back(ProbeMatch{static_cast<uint32_t>(i), bucket[k].row_id});
+        }
+    }
+
+    // Number of matches probe_batch() would append for keys[0, n), without producing them
+    // (sizes the output of a two-pass join).
+    virtual size_t count_batch(const Key* keys, size_t n) const {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            size_t len = 0;
+            const HashEntry<Key>* bucket = probe(keys[i], len);
+            for (size_t k = 0; k < len; ++k) count += bucket[k].key == keys[i];
+        }
+        return count;
+    }
 };
 
-template <typename Key>
-// Declaration only:
-std::unique_ptr<IHashTable<Key>> create_hashtable();
+// create_hashtable() is in hashtable_backend.h (runtime choice of the implementation)
 
 } // namespace Contest
\ No newline at end of file
@@ -1,16 +1,16 @@
 #pragma once
 
 #include <vector>
-#include <map>
 #include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <cmath>
 #include <stdexcept>
+#include <string>
 #include <typeinfo>
-#include <iostream>
 
 #include "hash_common.h"
+#include "key_groups.h"
 
 namespace Contest {
 
@@ -30,176 +30,186 @@ private:
     using Entry = HashEntry<Key>;
     using Slot  = HopscotchSlot<Key>;
 
-    std::vector<Entry> _storage;
-    std::vector<Slot>  _table;
-    std::vector<uint32_t> _hop_map;
-
-    size_t _capacity = 0;
-    size_t _initial_capacity = 0;
-
-   
     // Composite key generator
-    
-    inline uint64_t make_ckey(const Key& k) const {
+
+    static inline uint64_t make_ckey(const Key& k) {
         // ID for type namespace (ensures different tables don't mix)
         static uint64_t tid = (std::hash<std::string>()(typeid(Key).name()) & 0xFFFFULL);
 
         return (tid << 48) | (uint64_t)k;
     }
 
-    inline size_t hash_ckey(uint64_t ck) const {
-        return ck % _capacity;
-    }
-
-    size_t distance(size_t i, size_t j) const {
-        if (j >= i) return j - i;
-        return j + (_capacity - i);
-    }
+    // Hopscotch table over the keys of one partition (see key_groups.h)
+    class Table {
+    public:
+        // Build
 
-    
-    // Move empty slot closer
-    
-    size_t move_slot_closer(size_t home_slot, size_t empty_slot) {
-        for (size_t offset = 1; offset < NEIGHBORHOOD_SIZE; ++offset) {
+        void build(const KeyIndexInfo<Key>* infos, size_t n) {
+            if (n == 0) return;
 
-            size_t candidate_slot = (empty_slot + _capacity - offset) % _capacity;
-            const Slot& cand = _table[candidate_slot];
-            if (!cand.is_valid) continue;
+            double load_factor = 0.45;
+            size_t initial_capacity = std::ceil(n / load_factor);
+            if (initial_capacity < 16) initial_capacity = 16;
 
-            size_t cand_home = hash_ckey(cand.ckey);
-            size_t hop_off   = distance(cand_home, candidate_slot);
-            if (hop_off >= NEIGHBORHOOD_SIZE) continue;
+            _capacity = initial_capacity;
 
-            uint32_t mask = (1u << hop_off);
-            if (!(_hop_map[cand_home] & mask)) continue;
+            while (true) {
+                _table.assign(_capacity, Slot{});
+                _hop_map.assign(_capacity, 0);
 
-            size_t new_hop_offset = distance(cand_home, empty_slot);
-            if (new_hop_offset < NEIGHBORHOOD_SIZE) {
+                bool ok = true;
+                for (size_t i = 0; i < n; ++i) {
+                    Slot s;
+                    s.ckey = make_ckey(infos[i].key);
+                    s.start_index = infos[i].start_index;
+                    s.count = infos[i].count;
+                    s.is_valid = true;
+                    if (!insert_slot(s)) { ok = false; break; }
+                }
 
-                _hop_map[cand_home] &= ~mask;
-                _table[empty_slot] = _table[candidate_slot];
-                _table[empty_slot].is_valid = true;
-                _hop_map[cand_home] |= (1u << new_hop_offset);
+                if (ok) return;
 
-                _table[candidate_slot] = Slot{};
-                _table[candidate_slot].is_valid = false;
 
-                return candidate_slot;
+                _capacity *= 2;
             }
         }
-        return (size_t)-1;
-    }
 
-    
-    // Insert
-    
-    bool insert_slot(const Slot& info) {
-        size_t home = hash_ckey(info.ckey);
+        // Probe
 
-        size_t empty_slot = home;
-        size_t count = 0;
+        const Slot* find(const Key& k) const {
+            if (_capacity == 0) return nullptr;
 
-        while (_table[empty_slot].is_valid && count < _capacity) {
-            empty_slot = (empty_slot + 1) % _capacity;
-            count++;
-        }
-        if (count == _capacity) return false;
+            uint64_t ck = make_ckey(k);
+            size_t home = hash_ckey(ck);
 
-        while (distance(home, empty_slot) >= NEIGHBORHOOD_SIZE) {
-            size_t new_empty = move_slot_closer(home, empty_slot);
-            if (new_empty == (size_t)-1) return false;
-            empty_slot = new_empty;
-        }
+            uint32_t bitmap = _hop_map[home];
 
-        _table[empty_slot] = info;
-        _table[empty_slot].is_valid = true;
+            for (size_t off = 0; off < NEIGHBORHOOD_SIZE; ++off) {
+                if (bitmap & (1u << off)) {
+                    size_t slot = (home + off) % _capacity;
+                    const Slot& s = _table[slot];
 
-        size_t off = distance(home, empty_slot);
-        _hop_map[home] |= (1u << off);
+                    if (s.is_valid && s.ckey == ck)
+                        return &s;
+                }
+            }
+            return nullptr;
+        }
 
-        return true;
-    }
+        size_t memory_usage() const { return _table.size() * sizeof(Slot) + _hop_map.size() * sizeof(uint32_t); }
 
-public:
-    HopscotchBackend() = default;
+    private:
+        inline size_t hash_ckey(uint64_t ck) const {
+            return ck % _capacity;
+        }
 
-    
-    // Build
-    
-    void build_from_entries(const std::vector<std::pair<Key, size_t>>& entries) {
-        if (entries.empty()) {
-            _capacity = 0; _table.clear(); _hop_map.clear(); _storage.clear();
-            return;
+        size_t distance(size_t i, size_t j) const {
+            if (j >= i) return j - i;
+            return j + (_capacity - i);
         }
 
-        std::map<Key,std::vector<size_t>> groups;
-        for (auto& p : entries) groups[p.first].push_back(p.second);
 
-        _storage.clear(); _storage.reserve(entries.size());
+        // Move empty slot closer
 
-        std::vector<Slot> slots; slots.reserve(groups.size());
-        size_t idx = 0;
+        size_t move_slot_closer(size_t home_slot, size_t empty_slot) {
+            for (size_t offset = 1; offset < NEIGHBORHOOD_SIZE; ++offset) {
 
-        for (auto& g : groups) {
-            Slot s;
-            s.ckey = make_ckey(g.first);
-            s.start_index = idx;
-            s.count = g.second.size();
-            s.is_valid = true;
+                size_t candidate_slot = (empty_slot + _capacity - offset) % _capacity;
+                const Slot& cand = _table[candidate_slot];
+                if (!cand.is_valid) continue;
 
-            slots.push_back(s);
+                size_t cand_home = hash_ckey(cand.ckey);
+                size_t hop_off   = distance(cand_home, candidate_slot);
+                if (hop_off >= NEIGHBORHOOD_SIZE) continue;
 
-            for (auto rid : g.second)
-                _storage.push_back({g.first, static_cast<uint32_t>(rid)});
+                uint32_t mask = (1u << hop_off);
+                if (!(_hop_map[cand_home] & mask)) continue;
 
-            idx += g.second.size();
+                size_t new_hop_offset = distance(cand_home, empty_slot);
+                if (new_hop_offset < NEIGHBORHOOD_SIZE) {
+
+                    _hop_map[cand_home] &= ~mask;
+                    _table[empty_slot] = _table[candidate_slot];
+                    _table[empty_slot].is_valid = true;
+                    _hop_map[cand_home] |= (1u << new_hop_offset);
+
+                    _table[candidate_slot] = Slot{};
+                    _table[candidate_slot].is_valid = false;
+
+                    return candidate_slot;
+                }
+            }
+            return (size_t)-1;
         }
 
-        double load_factor = 0.45;
-        _initial_capacity = std::ceil(slots.size() / load_factor);
-        if (_initial_capacity < 16) _initial_capacity = 16;
 
-        _capacity = _initial_capacity;
+        // Insert
 
-        const size_t HARD_CAP = slots.size() * 128 + 100000;
+        bool insert_slot(const Slot& info) {
+            size_t home = hash_ckey(info.ckey);
 
-        while (true) {
-            _table.assign(_capacity, Slot{});
-            _hop_map.assign(_capacity, 0);
+            size_t empty_slot = home;
+            size_t count = 0;
 
-            bool ok = true;
-            for (auto& s : slots)
-                if (!insert_slot(s)) { ok = false; break; }
+            while (_table[empty_slot].is_valid && count < _capacity) {
+                empty_slot = (empty_slot + 1) % _capacity;
+                count++;
+            }
+            if (count == _capacity) return false;
 
-            if (ok) return;
+            while (distance(home, empty_slot) >= NEIGHBORHOOD_SIZE) {
+                size_t new_empty = move_slot_closer(home, empty_slot);
+                if (new_empty == (size_t)-1) return false;
+                empty_slot = new_empty;
+            }
+
+            _table[empty_slot] = info;
+            _table[empty_slot].is_valid = true;
+
+            size_t off = distance(home, empty_slot);
+            _hop_map[home] |= (1u << off);
 
-            
-            _capacity *= 2;
+            return true;
         }
-    }
 
-   
-    // Probe
-  
-    std::pair<const Entry*, size_t> probe(const Key& k) const {
-        if (_capacity == 0) return {nullptr, 0};
+        std::vector<Slot>  _table;
+        std::vector<uint32_t> _hop_map;
+        size_t _capacity = 0;
+    };
 
-        uint64_t ck = make_ckey(k);
-        size_t home = hash_ckey(ck);
+    KeyGroups<Key> _groups;                 // Entries of every key, contiguous
+    std::vector<Table> _tables;             // One per partition of _groups
 
-        uint32_t bitmap = _hop_map[home];
+public:
+    HopscotchBackend() = default;
 
-        for (size_t off = 0; off < NEIGHBORHOOD_SIZE; ++off) {
-            if (bitmap & (1u << off)) {
-                size_t slot = (home + off) % _capacity;
-                const Slot& s = _table[slot];
 
-                if (s.is_valid && s.ckey == ck)
-                    return { &_storage[s.start_index], s.count };
-            }
-        }
-        return {nullptr, 0};
+    // Build (one partition table per task)
+
+    void build(KeyGroups<Key> groups) {
+        _groups = std::move(groups);
+        _tables.assign(_groups.num_partitions(), Table{});
+        for_each_key_partition(_tables.size(), [&](size_t p) {
+            _tables[p].build(_groups.partition_infos(p), _groups.partition_keys(p));
+        });
+        std::vector<KeyIndexInfo<Key>>().swap(_groups.infos);   // Copied into the tables
+    }
+
+
+    // Probe
+
+    std::pair<const Entry*, size_t> probe(const Key& k) const {
+        if (_groups.num_entries() == 0) return {nullptr, 0};
+        const Slot* s = _tables[_groups.partition_of(k)].find(k);
+        if (!s) return {nullptr, 0};
+        return {_groups.entry(s->start_index), s->count};
+    }
+
+    size_t memory_usage() const {
+        size_t bytes = _groups.num_entries() * sizeof(Entry);
+        for (const Table& t : _tables) bytes += t.memory_usage();
+        return bytes;
     }
 };
 
-} // namespace Contest
\ No newline at end of file
+} // namespace Contest
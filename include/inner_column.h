@@ -8,44 +8,23 @@
 
 #include "attribute.h"
 #include "statement.h"
+#include "thread_pool.h"
 
+// Range-parallel helper for filters; tasks run on the persistent pool in morsels
 struct FilterThreadPool {
-    size_t num_threads;
+    size_t min_morsel;  // Smallest range handed to one task
 
-    explicit FilterThreadPool(unsigned num_threads)
-    : num_threads(num_threads ? num_threads : 1) {}
+    explicit FilterThreadPool(size_t min_morsel)
+    : min_morsel(min_morsel ? min_morsel : 1) {}
 
-    size_t begin_idx(size_t thread_id, size_t tasks) const {
-        const size_t base = tasks / num_threads;
-        const size_t rem  = tasks % num_threads;
-        return thread_id * base + std::min(thread_id, rem);
-    }
+    size_t num_threads() const { return Contest::ThreadPool::current().num_threads(); }
 
     void run(std::function<void(size_t, size_t)> function, size_t tasks) {
-        if (tasks == 0) return;
-
-        const size_t nt = num_threads ? num_threads : 1;
-        std::vector<std::thread> threads;
-        threads.reserve(nt ? nt - 1 : 0);
-
-        for (size_t t = 0; t + 1 < nt; ++t) {
-            threads.emplace_back([&, t]() {
-                const size_t begin = begin_idx(t, tasks);
-                const size_t end   = begin_idx(t + 1, tasks);
-                if (begin < end) function(begin, end);
-            });
-        }
-
-        // Execute last shard on calling thread to avoid extra join/creation overhead.
-        const size_t begin_last = begin_idx(nt - 1, tasks);
-        const size_t end_last   = begin_idx(nt, tasks);
-        if (begin_last < end_last) function(begin_last, end_last);
-
-        for (auto& th : threads) th.join();
+        Contest::ThreadPool::current().for_each_morsel(tasks, min_morsel, function);
     }
 };
 
-inline FilterThreadPool filter_tp(12);
+inline FilterThreadPool filter_tp(1);
 
 struct InnerColumnBase {
     DataType type;
@@ -0,0 +1,103 @@
+// join_table_choice.h - per-join choice of the table over an INT32 build side
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#include "hash_functions.h"
+#include "thread_pool.h"
+
+namespace Contest {
+
+/*
+ * Adaptive join tables.
+ *
+ * Which structure joins fastest depends on the build side: dense primary keys index an
+ * array, sparse unique keys fit a linear-probing table, duplicates need the unchained
+ * table's grouped buckets, and large builds with many probes pay for radix partitioning.
+ * One parallel pass over the build keys collects BuildKeyStats (rows, key range and a
+ * distinct-count sketch), and choose_join_table() picks per join, in this order:
+ *
+ * - Partitioned:   the table outgrows L2 and enough probes follow (choose_radix_plan)
+ * - DenseArray:    the key range is dense (dense_array_fits)
+ * - LinearProbing: nearly every key is distinct, from kLinearProbeMinRows rows on (below
+ *                  that the unchained table's bloom tags reject misses faster)
+ * - Unchained:     everything else, or the HASH_TABLE backend if one is selected
+ *
+ * JOIN_TABLE_CHOICE=0 disables LinearProbing (for experiments); ARRAY_JOIN=0 and
+ * RADIX_JOIN=0 disable the other two.
+ */
+enum class JoinTable : uint8_t { DenseArray, Unchained, LinearProbing, Partitioned };
+constexpr std::size_t kNumJoinTables = 4;
+
+constexpr std::size_t kLinearProbeMinRows = 4096;
+constexpr double kLinearProbeMinDistinct = 0.9;    // Distinct keys per row
+
+const char* join_table_name(JoinTable table);
+bool join_table_choice_enabled();
+
+// HyperLogLog sketch over 2^kBits one-byte registers (about 2% standard error)
+class DistinctSketch {
+public:
+    void add(int32_t key) {
+        const uint64_t h = Hash::mix64(static_cast<uint32_t>(key));
+        const uint8_t rank = static_cast<uint8_t>(__builtin_clzll(h << kBits | uint64_t{1} << (kBits - 1)) + 1);
+        uint8_t& reg = registers_[h >> (64 - kBits)];
+        if (rank > reg) reg = rank;
+    }
+
+    void merge(const DistinctSketch& other) {
+        for (std::size_t r = 0; r < registers_.size(); ++r)
+            if (other.registers_[r] > registers_[r]) registers_[r] = other.registers_[r];
+    }
+
+    double estimate() const;
+
+private:
+    static constexpr unsigned kBits = 11;
+    std::array<uint8_t, std::size_t{1} << kBits> registers_{};
+};
+
+struct BuildKeyStats {
+    std::size_t rows = 0;                               // Non-NULL keys
+    int32_t min_key = std::numeric_limits<int32_t>::max();
+    int32_t max_key = std::numeric_limits<int32_t>::min();
+    std::size_t distinct = 0;                           // Estimated distinct keys (<= rows)
+};
+
+// Statistics of the keys emitted by for_each_chunk(chunk, emit(key, row)) for chunks
+// [0, num_chunks), in one pass over morsels of chunks
+template <typename ForEachChunk>
+BuildKeyStats collect_build_key_stats(std::size_t num_chunks, ForEachChunk&& for_each_chunk) {
+    BuildKeyStats stats;
+    DistinctSketch sketch;
+    std::mutex mutex;
+    ThreadPool::current().for_each_morsel(num_chunks, 16, [&](std::size_t begin, std::size_t end) {
+        BuildKeyStats local;
+        DistinctSketch local_sketch;
+        for (std::size_t c = begin; c < end; ++c)
+            for_each_chunk(c, [&](int32_t key, uint32_t) {
+                ++local.rows;
+                local.min_key = std::min(local.min_key, key);
+                local.max_key = std::max(local.max_key, key);
+                local_sketch.add(key);
+            });
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.rows += local.rows;
+        stats.min_key = std::min(stats.min_key, local.min_key);
+        stats.max_key = std::max(stats.max_key, local.max_key);
+        sketch.merge(local_sketch);
+    });
+    stats.distinct = std::min(stats.rows, static_cast<std::size_t>(sketch.estimate() + 0.5));
+    return stats;
+}
+
+// Table for a build side with stats, probed by probe_rows rows (0 = not known yet, which
+// rules out Partitioned)
+JoinTable choose_join_table(const BuildKeyStats& stats, std::size_t probe_rows);
+
+} // namespace Contest
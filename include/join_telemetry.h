@@ -6,6 +6,8 @@
 
 namespace Contest {
 
+enum class JoinTable : uint8_t;    // join_table_choice.h
+
 // Aggregate metrics for a query
 struct QueryTelemetry {
     uint64_t joins = 0;            // Number of joins
@@ -15,6 +17,13 @@ struct QueryTelemetry {
     uint64_t out_cells = 0;        // Output cells (rows * cols)
     uint64_t bytes_baseline_min = 0; // Minimum bytes (keys + writes)
     uint64_t bytes_likely = 0;     // Estimated bytes (including reads)
+    uint64_t filter_scans = 0;     // Scans with runtime join filters
+    uint64_t filter_in_rows = 0;   // Rows those scans read
+    uint64_t filter_kept_rows = 0; // Rows that passed the filters
+    uint64_t skew_joins = 0;       // Joins with heavy-hitter build keys
+    uint64_t skew_keys = 0;        // Heavy-hitter keys found
+    uint64_t skew_out_rows = 0;    // Output rows written by heavy-hitter tasks
+    uint64_t tables[4] = {};       // Join tables built, per JoinTable
 };
 
 // Check if telemetry is enabled (env JOIN_TELEMETRY, default disabled)
@@ -29,6 +38,15 @@ void qt_add_join(uint64_t build_rows,
                  uint64_t out_rows,
                  uint64_t out_cols);
 
+// Record a scan that evaluated runtime join filters
+void qt_add_scan_filter(uint64_t in_rows, uint64_t kept_rows);
+
+// Record a join that split the output of heavy_keys heavy-hitter keys (heavy_out_rows rows)
+void qt_add_skew(uint64_t heavy_keys, uint64_t heavy_out_rows);
+
+// Record the kind of table a join was built with
+void qt_add_join_table(JoinTable table);
+
 // Print telemetry summary for the query
 void qt_end_query();
 
@@ -0,0 +1,119 @@
+// key_groups.h - build input of the open-addressing backends: entries grouped by key
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "plan.h"
+#include "hash_common.h"
+#include "hash_functions.h"
+#include "radix_partition.h"
+#include "thread_pool.h"
+
+namespace Contest {
+
+/*
+ * The Robin Hood, cuckoo and hopscotch backends keep one slot per distinct key, pointing at
+ * the run of that key's entries in a shared array. KeyGroups builds that layout in parallel:
+ *
+ * 1. radix_partition() splits the input by hash bits, reading every chunk in place (the
+ *    pages of a zero-copy column are never copied into an entry vector first);
+ * 2. every partition is sorted by (key, row) on its own, which makes the runs;
+ * 3. the runs of partition p become the slots of sub-table p.
+ *
+ * Sub-tables are independent: the backends build them in parallel, and a probe only looks
+ * at the sub-table of its key's partition (KeyGroups::partition_of).
+ */
+
+constexpr std::size_t kKeyGroupMinRows = 4096;     // Per partition, below that one table is enough
+constexpr std::size_t kKeyGroupChunkRows = 4096;   // Entries per chunk of an entry vector
+
+template <typename Key>
+struct KeyGroups {
+    PartitionedRelation<Key> entries;              // Sorted by (key, row) within a partition
+    std::vector<KeyIndexInfo<Key>> infos;          // One per distinct key, partition by partition
+    std::vector<std::size_t> info_offsets{0, 0};   // Partition p: infos[info_offsets[p], info_offsets[p + 1])
+    unsigned bits = 0;
+
+    std::size_t num_partitions() const { return info_offsets.size() - 1; }
+    std::size_t num_entries() const { return entries.tuples.size(); }
+    std::size_t partition_of(Key key) const { return bits ? radix_of(Hash::Hasher32{}(key), 0, bits) : 0; }
+
+    const KeyIndexInfo<Key>* partition_infos(std::size_t p) const { return infos.data() + info_offsets[p]; }
+    std::size_t partition_keys(std::size_t p) const { return info_offsets[p + 1] - info_offsets[p]; }
+    const HashEntry<Key>* entry(std::size_t i) const { return entries.tuples.data() + i; }
+};
+
+// Run fn(p) for every partition p on the pool (ThreadPool::run rethrows the first exception)
+template <typename Fn>
+void for_each_key_partition(std::size_t num_partitions, Fn&& fn) {
+    std::atomic<std::size_t> next{0};
+    const std::size_t nt = std::min(ThreadPool::current().num_threads(), num_partitions);
+    ThreadPool::current().run(nt, [&](std::size_t) {
+        for (std::size_t p = next.fetch_add(1); p < num_partitions; p = next.fetch_add(1)) fn(p);
+    });
+}
+
+// Group the entries emitted by for_each_chunk(chunk, emit(key, row)) for chunks
+// [0, num_chunks); num_rows (an upper bound) sizes the partitioning
+template <typename Key, typename ForEachChunk>
+KeyGroups<Key> group_keys(std::size_t num_chunks, ForEachChunk&& for_each_chunk, std::size_t num_rows) {
+    KeyGroups<Key> groups;
+    const std::size_t nt = ThreadPool::current().num_threads();
+    while (groups.bits < kRadixMaxBitsPerPass && (std::size_t{1} << groups.bits) < 4 * nt &&
+           (num_rows >> (groups.bits + 1)) >= kKeyGroupMinRows)
+        ++groups.bits;
+
+    groups.entries = radix_partition<Key>(num_chunks, for_each_chunk, RadixPlan{groups.bits, 0}, nt);
+    const std::size_t np = groups.entries.num_partitions();
+
+    std::vector<std::vector<KeyIndexInfo<Key>>> runs(np);
+    for_each_key_partition(np, [&](std::size_t p) {
+        HashEntry<Key>* begin = groups.entries.tuples.data() + groups.entries.offsets[p];
+        HashEntry<Key>* end = groups.entries.tuples.data() + groups.entries.offsets[p + 1];
+        std::sort(begin, end, [](const HashEntry<Key>& a, const HashEntry<Key>& b) {
+            return a.key < b.key || (a.key == b.key && a.row_id < b.row_id);
+        });
+        for (HashEntry<Key>* run = begin; run != end;) {
+            HashEntry<Key>* run_end = run + 1;
+            while (run_end != end && run_end->key == run->key) ++run_end;
+            runs[p].push_back(KeyIndexInfo<Key>{run->key, static_cast<std::size_t>(run - groups.entries.tuples.data()),
+                                                static_cast<std::size_t>(run_end - run), true});
+            run = run_end;
+        }
+    });
+
+    groups.info_offsets.assign(np + 1, 0);
+    for (std::size_t p = 0; p < np; ++p) groups.info_offsets[p + 1] = groups.info_offsets[p] + runs[p].size();
+    groups.infos.reserve(groups.info_offsets[np]);
+    for (auto& r : runs) groups.infos.insert(groups.infos.end(), r.begin(), r.end());
+    return groups;
+}
+
+// Group a vector of entries (read in chunks of kKeyGroupChunkRows)
+template <typename Key>
+KeyGroups<Key> group_keys(const std::vector<HashEntry<Key>>& entries) {
+    const std::size_t chunks = (entries.size() + kKeyGroupChunkRows - 1) / kKeyGroupChunkRows;
+    return group_keys<Key>(chunks, [&](std::size_t c, auto&& emit) {
+        const std::size_t end = std::min(entries.size(), (c + 1) * kKeyGroupChunkRows);
+        for (std::size_t i = c * kKeyGroupChunkRows; i < end; ++i) emit(entries[i].key, entries[i].row_id);
+    }, entries.size());
+}
+
+// Group an INT32 column without NULLs straight from its pages (zero-copy layout: the values
+// of page p are rows [page_offsets[p], page_offsets[p + 1]) at offset 4)
+template <typename Key>
+KeyGroups<Key> group_keys(const Column* src_column, const std::vector<std::size_t>& page_offsets,
+                          std::size_t num_rows) {
+    return group_keys<Key>(page_offsets.size() - 1, [&](std::size_t page, auto&& emit) {
+        const auto* data = reinterpret_cast<const int32_t*>(src_column->pages[page]->data + 4);
+        const std::size_t base = page_offsets[page];
+        for (std::size_t i = 0; i < page_offsets[page + 1] - base; ++i)
+            emit(static_cast<Key>(data[i]), static_cast<uint32_t>(base + i));
+    }, num_rows);
+}
+
+} // namespace Contest
@@ -92,6 +92,12 @@ struct StringRefResolver {
     const Plan* plan;
     StringRefResolver(const Plan* p) : plan(p) {}
     std::pair<const char*, size_t> resolve(uint64_t raw_ref, std::string& buffer);
+
+    // Allocation-free variants (read the pages in place, also for long strings):
+    // hash of the string bytes, equal for equal strings whatever their refs
+    uint64_t hash(uint64_t raw_ref) const;
+    // Byte equality of the strings behind two refs
+    bool equal(uint64_t a, uint64_t b) const;
 };
 
 } // namespace Contest
\ No newline at end of file
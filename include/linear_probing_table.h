@@ -0,0 +1,154 @@
+// linear_probing_table.h - open-addressing table for unique INT32 build keys
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "plan.h"
+#include "hash_common.h"
+#include "hash_functions.h"
+#include "hashtable_interface.h"
+#include "thread_pool.h"
+
+namespace Contest {
+
+/*
+ * Linear probing.
+ *
+ * Primary keys whose range is too sparse for the array join still hold one row per key.
+ * For them the unchained table's directory, bloom tags and bucket ranges are overhead:
+ * slots_ holds the (key, row_id) entries themselves, at most half full, and a probe hashes
+ * the key (top bits of Hasher32), then scans from the home slot to the first empty slot,
+ * which is usually the same cache line.
+ *
+ * Slots past the home range form a tail of kLinearProbeTail slots, so a cluster never wraps
+ * around. The build is parallel (one CAS per entry) and fails on the first key that is
+ * already present, or on a cluster that runs past the tail: the caller then builds another
+ * table (see join_table_choice.h).
+ */
+
+constexpr std::size_t kLinearProbeTail = 1024;            // Slots after the home range
+constexpr std::size_t kLinearProbeSlotsPerRow = 2;        // Load factor at most 1/2
+
+class LinearProbingTable : public IHashTable<int32_t> {
+public:
+    using Key = int32_t;
+
+    explicit LinearProbingTable(std::size_t num_rows) {
+        while ((std::size_t{1} << bits_) < kLinearProbeSlotsPerRow * std::max<std::size_t>(num_rows, 1)) ++bits_;
+    }
+
+    void reserve(size_t /*capacity*/) override {}        // Sized by the constructor
+
+    // Builds the table; false if a key repeats or a cluster outgrows the tail (the table is
+    // empty then)
+    bool try_build_from_entries(const std::vector<HashEntry<Key>>& entries) {
+        const std::size_t n = entries.size();
+        constexpr std::size_t kChunk = 1u << 16;
+        return build((n + kChunk - 1) / kChunk, [&](std::size_t chunk, auto&& emit) {
+            const std::size_t end = std::min(n, (chunk + 1) * kChunk);
+            for (std::size_t i = chunk * kChunk; i < end; ++i) emit(entries[i].key, entries[i].row_id);
+        });
+    }
+
+    void build_from_entries(const std::vector<HashEntry<Key>>& entries) override {
+        if (!try_build_from_entries(entries)) throw std::invalid_argument("LinearProbingTable: repeated build key");
+    }
+
+    bool build_from_zero_copy_int32(const Column* src_column, const std::vector<std::size_t>& page_offsets,
+                                    std::size_t /*num_rows*/) override {
+        return build(page_offsets.size() - 1, [&](std::size_t page, auto&& emit) {
+            const std::size_t base = page_offsets[page];
+            const std::size_t n = page_offsets[page + 1] - base;
+            auto* data = reinterpret_cast<const int32_t*>(src_column->pages[page]->data + 4);
+            for (std::size_t i = 0; i < n; ++i) emit(data[i], static_cast<uint32_t>(base + i));
+        });
+    }
+
+    // The cluster from the key's home slot to the first empty slot (other keys included)
+    const HashEntry<Key>* probe(const Key& key, size_t& len) const override {
+        len = 0;
+        if (!slots_) return nullptr;
+        const std::size_t home = home_of(key);
+        while (load(home + len) != kEmpty) ++len;
+        return len ? reinterpret_cast<const HashEntry<Key>*>(&slots_[home]) : nullptr;
+    }
+
+    void probe_batch(const Key* keys, size_t n, std::vector<ProbeMatch>& out) const override {
+        for (size_t i = 0; i < n; ++i)
+            if (const uint64_t* slot = find(keys[i]))
+                out.push_back(ProbeMatch{static_cast<uint32_t>(i), static_cast<uint32_t>(*slot >> 32)});
+    }
+
+    size_t count_batch(const Key* keys, size_t n) const override {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) count += find(keys[i]) != nullptr;
+        return count;
+    }
+
+    size_t memory_usage() const override { return slots_ ? num_slots() * sizeof(uint64_t) : 0; }
+
+private:
+    // Empty slot: row id 0xFFFFFFFF, never a real row
+    static constexpr uint64_t kEmpty = ~uint64_t{0};
+    static_assert(sizeof(HashEntry<Key>) == sizeof(uint64_t) && sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+                  "a slot is read as a HashEntry");
+
+    static uint64_t pack(Key key, uint32_t row_id) {
+        return static_cast<uint64_t>(row_id) << 32 | static_cast<uint32_t>(key);
+    }
+
+    std::size_t num_slots() const { return (std::size_t{1} << bits_) + kLinearProbeTail; }
+    std::size_t home_of(Key key) const { return Hash::Hasher32{}(key) >> (64 - bits_); }
+    uint64_t load(std::size_t slot) const { return slots_[slot].load(std::memory_order_relaxed); }
+
+    // Slot holding key, nullptr if there is none
+    const uint64_t* find(Key key) const {
+        if (!slots_) return nullptr;
+        for (std::size_t slot = home_of(key);; ++slot) {
+            const uint64_t v = load(slot);
+            if (v == kEmpty) return nullptr;
+            if (static_cast<Key>(static_cast<uint32_t>(v)) == key) return reinterpret_cast<const uint64_t*>(&slots_[slot]);
+        }
+    }
+
+    // for_each_chunk(chunk, emit) must call emit(key, row_id) for every entry of the chunk
+    template <typename ForEachChunk>
+    bool build(std::size_t num_chunks, ForEachChunk&& for_each_chunk) {
+        ThreadPool& pool = ThreadPool::current();
+        const std::size_t total = num_slots();
+        slots_ = std::make_unique<std::atomic<uint64_t>[]>(total);
+        pool.for_each_morsel(total, 1u << 16, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t s = begin; s < end; ++s) slots_[s].store(kEmpty, std::memory_order_relaxed);
+        });
+
+        std::atomic<bool> failed{false};
+        pool.for_each_morsel(num_chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end && !failed.load(std::memory_order_relaxed); ++c) {
+                for_each_chunk(c, [&](Key key, uint32_t row_id) {
+                    const uint64_t entry = pack(key, row_id);
+                    for (std::size_t slot = home_of(key); slot + 1 < total; ++slot) {   // Last slot stays empty
+                        uint64_t v = load(slot);
+                        if (v == kEmpty &&
+                            slots_[slot].compare_exchange_strong(v, entry, std::memory_order_relaxed))
+                            return;
+                        if (static_cast<Key>(static_cast<uint32_t>(v)) == key) break;   // Repeated key
+                    }
+                    failed.store(true, std::memory_order_relaxed);
+                });
+            }
+        });
+        if (failed.load()) slots_.reset();
+        return slots_ != nullptr;
+    }
+
+    unsigned bits_ = 4;                                    // Home range: 2^bits_ slots
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;       // Packed (row_id << 32 | key), kEmpty if unused
+};
+
+} // namespace Contest
@@ -0,0 +1,68 @@
+// numa.h - NUMA topology, worker pinning and page placement
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Contest {
+
+/*
+ * NUMA awareness without libnuma.
+ *
+ * The topology is read from sysfs (nodeN/cpulist) and restricted to the CPUs this process
+ * may run on, so a run under `numactl --cpunodebind` sees a single node and every function
+ * below becomes a no-op. With several nodes:
+ *
+ * - ThreadPool pins its workers to the CPUs of one node each (spread evenly), and
+ *   current_numa_node() tells a task where it runs
+ * - morsels are handed out per node range (NodeAwareCoordinator), so consecutive operators
+ *   over the same rows read on the node that wrote them
+ * - memory every node reads at random (hash table tuples, row-id intermediates) is
+ *   interleaved over the nodes; output pages are first touched by the thread writing them
+ *
+ * NUMA=0 disables all of it (for experiments).
+ */
+struct NumaTopology {
+    std::vector<int> node_ids;                  // sysfs ids of the nodes with usable CPUs
+    std::vector<std::vector<int>> node_cpus;    // Usable CPUs of every node
+    std::vector<int> cpu_node;                  // cpu -> index into node_ids (-1 = unknown)
+
+    std::size_t num_nodes() const { return node_ids.empty() ? 1 : node_ids.size(); }
+
+    // Node index of thread t of nthreads: threads are spread over the nodes in blocks
+    std::size_t node_of_thread(std::size_t t, std::size_t nthreads) const {
+        return nthreads == 0 ? 0 : t * num_nodes() / nthreads;
+    }
+
+    // Nodes and CPUs below sysfs_root (nodeN/cpulist); empty when it cannot be read
+    static NumaTopology parse(const std::string& sysfs_root);
+    // Topology of this machine, restricted to the CPU affinity of the process
+    static const NumaTopology& system();
+};
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+std::vector<int> parse_cpulist(const std::string& list);
+
+// Number of nodes the engine places data on (1 if NUMA=0 or single node)
+std::size_t numa_num_nodes();
+
+// Node index of the calling thread (fixed for pinned workers)
+std::size_t current_numa_node();
+
+// Restrict the calling thread to the CPUs of node index `node` and remember it
+void pin_thread_to_node(std::size_t node);
+
+// Pages fully inside [addr, addr + bytes) are allocated round-robin over the nodes when
+// first touched. Memory that is already touched keeps its placement.
+void numa_interleave(void* addr, std::size_t bytes);
+
+// Resize v (empty or untouched capacity) to n elements with its pages interleaved
+template <typename Vec>
+void interleaved_resize(Vec& v, std::size_t n) {
+    v.reserve(n);
+    numa_interleave(v.data(), n * sizeof(typename Vec::value_type));
+    v.resize(n);
+}
+
+} // namespace Contest
@@ -8,12 +8,23 @@
 #include <type_traits>
 #include <stdexcept>
 #include <algorithm>
+#include <memory>
+#include <utility>
+
+#include <hardware.h>
+#if defined(SPC__SUPPORTS_AVX2) && defined(__AVX2__)
+#include <immintrin.h>
+#define SPC__UNCHAINED_AVX2_MATCH 1
+#endif
 
 // Local headers for plan definitions, hashing, bloom helpers, allocators and settings
 #include "plan.h"
 #include "hash_common.h"
 #include "hash_functions.h"
 #include "bloom_filter.h"
+#include "thread_pool.h"
+#include "numa.h"
+#include "arena.h"
 
 namespace Contest {
 // TupleEntry: a tuple containing the key and its row id
@@ -23,12 +34,37 @@ struct TupleEntry {
     uint32_t row_id;  // The row id index in the input
 };
 
+// Tuple layout chosen after the build from the key distribution (see finalize_layout())
+enum class BucketLayout {
+    kRows,      // One (key, row_id) tuple per build row
+    kUnique,    // Same, but every key occurs once: long buckets are ordered by hash, one lookup per probe
+    kGrouped,   // One (key, run start) tuple per distinct key + contiguous row-id runs
+};
+constexpr std::size_t kGroupMinRowsPerKey = 3;  // Grouping pays off from here (8 B/row vs 8 B/key + 4 B/row)
+constexpr std::size_t kSortedBucketMinRows = 32; // Buckets from here are sorted at the build (shorter: scanned)
+
+// Parallel build settings
+constexpr std::size_t kParallelBuildMinRows = 1ull << 17; // Below this a single thread is faster
+
+// Number of threads for building a table of num_rows tuples.
+// Each thread keeps its own count array of directory size, so we only add a thread
+// when it gets at least one directory worth of rows (otherwise counts dominate).
+inline std::size_t parallel_build_threads(std::size_t num_rows, std::size_t dir_size) {
+    if (num_rows < kParallelBuildMinRows) return 1;
+    const std::size_t hw = ThreadPool::current().num_threads();
+    const std::size_t by_rows = dir_size ? num_rows / dir_size : hw;
+    return std::max<std::size_t>(1, std::min(hw, by_rows));
+}
+
 // FlatUnchainedHashTable: flat, prefix-sum based unchained hash table implementation
 template<typename Key, typename Hasher = Hash::Hasher32>
 class FlatUnchainedHashTable {
 public:
     using entry_type = TupleEntry<Key>;               // Type of stored tuple
-    using entry_allocator = std::allocator<entry_type>; // Use simple allocator (slab not used here)
+    // Storage comes from the query arena when there is one (huge pages, freed with the query;
+    // tables kept across queries are built under Arena::Scope(nullptr))
+    using entry_allocator = DefaultInitAllocator<entry_type, ArenaAllocator<entry_type>>; // No zero-fill on resize
+    template <typename T> using storage = std::vector<T, ArenaAllocator<T>>;
 
     // Constructor: optionally accepts a hasher and the directory size as a power of two
     explicit FlatUnchainedHashTable(Hasher hasher = Hasher(), std::size_t directory_power = 10)
@@ -105,12 +141,29 @@ public:
      * 5. Update bloom filters
      */
     // Build hash table from a vector of entries (optimized path)
-    void build_from_entries(const std::vector<Contest::HashEntry<Key>>& entries) {
+    // num_threads > 1 switches to the partitioned parallel build (see build_parallel()).
+    void build_from_entries(const std::vector<Contest::HashEntry<Key>>& entries,
+                            std::size_t num_threads = 1) {
+        build_from_entries(entries.data(), entries.size(), num_threads);
+    }
+
+    // Same, over a contiguous range (e.g. one partition of a radix-partitioned input)
+    void build_from_entries(const Contest::HashEntry<Key>* entries, std::size_t num_entries,
+                            std::size_t num_threads = 1) {
         // If there are no entries, clear and return
-        if (entries.empty()) {
-            std::fill(directory_offsets_, directory_offsets_ + dir_size_, 0);
-            std::fill(bloom_filters_.begin(), bloom_filters_.end(), 0);
-            tuples_.clear();
+        if (num_entries == 0) {
+            clear();
+            return;
+        }
+
+        if (num_threads > 1) {
+            // Each thread owns a contiguous slice of the entries
+            const std::size_t n = num_entries;
+            build_parallel(num_threads, [&](std::size_t t, std::size_t nt, auto&& emit) {
+                const std::size_t begin = n * t / nt;
+                const std::size_t end = n * (t + 1) / nt;
+                for (std::size_t i = begin; i < end; ++i) emit(entries[i].key, entries[i].row_id);
+            });
             return;
         }
 
@@ -122,7 +175,7 @@ public:
         if (counts_.size() != dir_size_) counts_.assign(dir_size_, 0);
         else std::fill(counts_.begin(), counts_.end(), 0);
 
-        for (std::size_t i = 0; i < entries.size(); ++i) {
+        for (std::size_t i = 0; i < num_entries; ++i) {
             uint64_t h = compute_hash(entries[i].key);     // Compute hash
             std::size_t slot = (h >> shift_) & dir_mask_;   // Extract prefix for index
             counts_[slot]++;                               // Increment slot counter
@@ -146,7 +199,7 @@ public:
             write_ptrs_[i] = directory_offsets_[i - 1]; // Start of each slot = END of previous
         }
 
-        for (std::size_t i = 0; i < entries.size(); ++i) {
+        for (std::size_t i = 0; i < num_entries; ++i) {
             uint64_t h = compute_hash(entries[i].key);   // Hash for the tuple
             std::size_t slot = (h >> shift_) & dir_mask_; // Determine slot
             uint32_t pos = write_ptrs_[slot]++;          // Find write position
@@ -154,17 +207,18 @@ public:
             tuples_[pos].row_id = entries[i].row_id;     // Copy row id
         }
         // At the end, tuples are contiguous per slot and ordered by prefix
+        finalize_layout(1);
     }
 
     // Fast path: build directly from a zero-copy INT32 column (no intermediate vector)
+    // num_threads > 1 switches to the partitioned parallel build (see build_parallel()).
     void build_from_zero_copy_int32(const Column* src_column,
                                     const std::vector<std::size_t>& page_offsets,
-                                    std::size_t num_rows) {
+                                    std::size_t num_rows,
+                                    std::size_t num_threads = 1) {
         // If no data or bad input, clear and return
         if (num_rows == 0 || src_column == nullptr || page_offsets.size() < 2) {
-            std::fill(directory_offsets_, directory_offsets_ + dir_size_, 0);
-            std::fill(bloom_filters_.begin(), bloom_filters_.end(), 0);
-            tuples_.clear();
+            clear();
             return;
         }
 
@@ -172,6 +226,23 @@ public:
         static_assert(std::is_same_v<Key, int32_t> || std::is_same_v<Key, uint32_t>,
                       "build_from_zero_copy_int32 only supports (u)int32 keys");
 
+        if (num_threads > 1) {
+            // Each thread owns a contiguous range of pages
+            const std::size_t npages = page_offsets.size() - 1;
+            build_parallel(num_threads, [&](std::size_t t, std::size_t nt, auto&& emit) {
+                const std::size_t first = npages * t / nt;
+                const std::size_t last = npages * (t + 1) / nt;
+                for (std::size_t page_idx = first; page_idx < last; ++page_idx) {
+                    const std::size_t base = page_offsets[page_idx];
+                    const std::size_t n = page_offsets[page_idx + 1] - base;
+                    auto* data = reinterpret_cast<const int32_t*>(src_column->pages[page_idx]->data + 4);
+                    for (std::size_t slot_i = 0; slot_i < n; ++slot_i)
+                        emit(static_cast<Key>(data[slot_i]), static_cast<uint32_t>(base + slot_i));
+                }
+            });
+            return;
+        }
+
         tuples_.reserve(num_rows); // Reserve space
 
         // Zero directory and bloom
@@ -228,9 +299,13 @@ public:
                 tuples_[pos].row_id = static_cast<uint32_t>(base + slot_i); // Store row id
             }
         }
+        finalize_layout(1);
     }
 
-    // Probe: returns pointer to a contiguous range and its length
+    // Probe: returns pointer to a contiguous range and its length.
+    // With the grouped layout the range holds exactly the matches of key, expanded into a
+    // per-thread buffer that stays valid until the next probe() of the same thread; the
+    // join paths use for_each_match() / probe_batch() instead.
     const entry_type* probe(const Key& key, std::size_t& len) const {
         uint64_t h = compute_hash(key);                  // Compute hash
         std::size_t slot = (h >> shift_) & dir_mask_;    // Find slot
@@ -248,22 +323,447 @@ public:
         len = end - begin;       // Length of results
         if (len == 0) return nullptr; // Empty bucket
 
+        if (layout_ == BucketLayout::kGrouped) {
+            thread_local std::vector<entry_type> expanded;
+            expanded.clear();
+            emit_matches(begin, end, key, [&](uint32_t row) { expanded.push_back(entry_type{key, row}); });
+            len = expanded.size();
+            return len ? expanded.data() : nullptr;
+        }
+
         // Return pointer to the start of the range
         return &tuples_[begin];
     }
 
-    // Return number of stored tuples
-    std::size_t size() const { return tuples_.size(); }
+    // Call on_row(row_id) for every build row whose key equals key
+    template<typename OnRow>
+    void for_each_match(const Key& key, OnRow&& on_row) const {
+        const uint64_t h = compute_hash(key);
+        const std::size_t slot = (h >> shift_) & dir_mask_;
+        if (!Bloom::maybe_contains(bloom_filters_[slot], Bloom::make_tag_from_hash(h))) return;
+        emit_matches(directory_offsets_[slot - 1], directory_offsets_[slot], key, on_row);
+    }
+
+    /*
+     * match_bucket(): call on_row(row_id) for every tuple of bucket[0, len) whose key equals key.
+     *
+     * With AVX2 and 32-bit keys, 8 tuples (two 32-byte loads of key/row_id pairs) are
+     * de-interleaved into one register of 8 keys, compared against the broadcast probe key,
+     * and the movemask selects the matching row ids. The bucket tail uses masked loads, so
+     * short buckets need no scalar loop either.
+     */
+    template<typename OnRow>
+    static void match_bucket(const entry_type* bucket, std::size_t len, Key key, OnRow&& on_row) {
+        scan_bucket<false>(bucket, len, key, [&](std::size_t i) { on_row(bucket[i].row_id); });
+    }
+
+    /*
+     * probe_batch(): group prefetching (Chen et al., "Improving Hash Join Performance
+     * through Prefetching").
+     *
+     * probe() has three dependent misses per key: bloom tag, directory, tuples. Over a
+     * group of kProbeGroup keys, every stage is issued for all keys before the next stage
+     * runs, so the misses of one group overlap instead of being paid one after another:
+     *
+     * 1. hash all keys, prefetch their bloom tags and directory entries
+     * 2. bloom check + tuple range, prefetch the first tuple line of every range
+     * 3. scan the ranges and append (probe_idx, build_row) for equal keys
+     */
+    static constexpr std::size_t kProbeGroup = 32;
+
+    void probe_batch(const Key* keys, std::size_t n, std::vector<Contest::ProbeMatch>& out) const {
+        for_each_probe_range(keys, n, [&](std::size_t i, uint32_t begin, uint32_t end) {
+            const uint32_t probe_idx = static_cast<uint32_t>(i);
+            emit_matches(begin, end, keys[i], [&](uint32_t row) {
+                out.push_back(Contest::ProbeMatch{probe_idx, row});
+            });
+        });
+    }
+
+    // Number of matches probe_batch() would emit, same prefetching; grouped runs are
+    // counted by their bounds without touching the row ids.
+    std::size_t count_batch(const Key* keys, std::size_t n) const {
+        std::size_t count = 0;
+        for_each_probe_range(keys, n, [&](std::size_t i, uint32_t begin, uint32_t end) {
+            count += count_matches(begin, end, keys[i]);
+        });
+        return count;
+    }
+
+    // Return number of stored build rows
+    std::size_t size() const { return layout_ == BucketLayout::kGrouped ? row_runs_.size() : tuples_.size(); }
+
+    BucketLayout layout() const { return layout_; }
     
     // Debug helpers: directory size and estimated memory usage
     std::size_t directory_size() const { return dir_size_; }
     std::size_t memory_usage() const {
         return tuples_.size() * sizeof(entry_type) +
+               row_runs_.size() * sizeof(uint32_t) +
                dir_size_ * sizeof(uint32_t) +
                bloom_filters_.size() * sizeof(uint16_t);
     }
 
 private:
+    // Call on_index(i) for the tuples bucket[i] with key == key; kFirstOnly stops at the first one
+    template<bool kFirstOnly, typename OnIndex>
+    static void scan_bucket(const entry_type* bucket, std::size_t len, Key key, OnIndex&& on_index) {
+#ifdef SPC__UNCHAINED_AVX2_MATCH
+        if constexpr (sizeof(Key) == 4 && sizeof(entry_type) == 8) {
+            const __m256i needle = _mm256_set1_epi32(static_cast<int32_t>(key));
+            std::size_t k = 0;
+            for (; k + 8 <= len; k += 8) {
+                const auto* p = reinterpret_cast<const __m256i*>(bucket + k);
+                const unsigned mask = match8(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1), needle);
+                if (kFirstOnly && mask) {
+                    on_index(k + __builtin_ctz(mask));
+                    return;
+                }
+                for (unsigned m = mask; m; m &= m - 1) on_index(k + __builtin_ctz(m));
+            }
+            if (k < len) {
+                // Masked lanes are not read (no fault past the end) and load as 0
+                const std::size_t rest = len - k;
+                const auto* p = reinterpret_cast<const int*>(bucket + k);
+                const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                const __m256i lo = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(2 * std::min<std::size_t>(rest, 4))), lanes);
+                const __m256i hi = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(2 * (rest > 4 ? rest - 4 : 0))), lanes);
+                const unsigned mask = match8(_mm256_maskload_epi32(p, lo), _mm256_maskload_epi32(p + 8, hi), needle) &
+                                      ((1u << rest) - 1);
+                if (kFirstOnly && mask) {
+                    on_index(k + __builtin_ctz(mask));
+                    return;
+                }
+                for (unsigned m = mask; m; m &= m - 1) on_index(k + __builtin_ctz(m));
+            }
+            return;
+        }
+#endif
+        for (std::size_t k = 0; k < len; ++k) {
+            if (bucket[k].key != key) continue;
+            on_index(k);
+            if (kFirstOnly) return;
+        }
+    }
+
+    // Group prefetching loop of probe_batch(): stages 1 and 2 run over a group, then stage 3
+    // calls on_range(i, begin, end) with the tuple range that may hold keys[i] (empty when
+    // the bloom tag rules the key out)
+    template<typename OnRange>
+    void for_each_probe_range(const Key* keys, std::size_t n, OnRange&& on_range) const {
+        uint64_t hashes[kProbeGroup];
+        uint32_t begins[kProbeGroup];
+        uint32_t ends[kProbeGroup];
+
+        for (std::size_t g = 0; g < n; g += kProbeGroup) {
+            const std::size_t m = std::min(kProbeGroup, n - g);
+
+            // Stage 1: hash + prefetch bloom and directory ([slot-1] and [slot] share a line mostly)
+            for (std::size_t i = 0; i < m; ++i) {
+                const uint64_t h = compute_hash(keys[g + i]);
+                const std::size_t slot = (h >> shift_) & dir_mask_;
+                hashes[i] = h;
+                __builtin_prefetch(&bloom_filters_[slot]);
+                __builtin_prefetch(&directory_offsets_[slot]);
+            }
+
+            // Stage 2: bloom check + tuple range, prefetch the tuples (where find_unique() starts)
+            for (std::size_t i = 0; i < m; ++i) {
+                const uint64_t h = hashes[i];
+                const std::size_t slot = (h >> shift_) & dir_mask_;
+                begins[i] = ends[i] = 0;
+                if (!Bloom::maybe_contains(bloom_filters_[slot], Bloom::make_tag_from_hash(h))) continue;
+                begins[i] = directory_offsets_[slot - 1];   // [-1] is 0 for slot 0
+                ends[i] = directory_offsets_[slot];
+                const uint32_t len = ends[i] - begins[i];
+                if (len == 0) continue;
+                const bool interpolated = layout_ == BucketLayout::kUnique && len >= kSortedBucketMinRows;
+                __builtin_prefetch(&tuples_[begins[i] + (interpolated ? (uint64_t{rank_in_slot(h)} * len) >> 32 : 0)]);
+            }
+
+            // Stage 3: compare keys
+            for (std::size_t i = 0; i < m; ++i) on_range(g + i, begins[i], ends[i]);
+        }
+    }
+
+    // Position of a hash inside its slot: the 32 hash bits below the directory prefix
+    uint32_t rank_in_slot(uint64_t h) const { return static_cast<uint32_t>((h << (64 - shift_)) >> 32); }
+
+    /*
+     * find_unique(): kUnique lookup, index of the tuple of bucket[0, len) with key == key or -1.
+     *
+     * Buckets of kSortedBucketMinRows or more are sorted by rank_in_slot() (finalize_layout()).
+     * Ranks are uniform, so a key sits close to len * rank / 2^32: the lookup starts there and
+     * steps over the few tuples between the guess and the key's rank, instead of scanning the
+     * bucket from its start. Shorter buckets fit in a few cache lines and are scanned.
+     */
+    std::ptrdiff_t find_unique(const entry_type* bucket, std::size_t len, Key key) const {
+        if (len < kSortedBucketMinRows) {
+            std::ptrdiff_t found = -1;
+            scan_bucket<true>(bucket, len, key, [&](std::size_t i) { found = static_cast<std::ptrdiff_t>(i); });
+            return found;
+        }
+        auto rank = [&](std::size_t i) { return rank_in_slot(compute_hash(bucket[i].key)); };
+        const uint32_t r = rank_in_slot(compute_hash(key));
+        std::size_t i = static_cast<std::size_t>((uint64_t{r} * len) >> 32);   // Expected position
+        while (i > 0 && rank(i - 1) >= r) --i;
+        while (i < len && rank(i) < r) ++i;
+        for (; i < len && rank(i) == r; ++i)                                      // Equal ranks are rare
+            if (bucket[i].key == key) return static_cast<std::ptrdiff_t>(i);
+        return -1;
+    }
+
+    // Number of rows emit_matches() would produce
+    std::size_t count_matches(uint32_t begin, uint32_t end, Key key) const {
+        const entry_type* bucket = tuples_.data() + begin;
+        std::size_t count = 0;
+        switch (layout_) {
+        case BucketLayout::kRows:
+            scan_bucket<false>(bucket, end - begin, key, [&](std::size_t) { ++count; });
+            break;
+        case BucketLayout::kUnique:
+            count = find_unique(bucket, end - begin, key) >= 0;
+            break;
+        case BucketLayout::kGrouped:
+            scan_bucket<true>(bucket, end - begin, key, [&](std::size_t i) {
+                const std::size_t g = begin + i;
+                const std::size_t run_end = g + 1 < tuples_.size() ? tuples_[g + 1].row_id : row_runs_.size();
+                count = run_end - tuples_[g].row_id;
+            });
+            break;
+        }
+        return count;
+    }
+
+    // Call on_row(row_id) for the matches of key among tuples_[begin, end), per layout
+    template<typename OnRow>
+    void emit_matches(uint32_t begin, uint32_t end, Key key, OnRow&& on_row) const {
+        const entry_type* bucket = tuples_.data() + begin;
+        switch (layout_) {
+        case BucketLayout::kRows:
+            match_bucket(bucket, end - begin, key, on_row);
+            break;
+        case BucketLayout::kUnique:
+            if (const std::ptrdiff_t i = find_unique(bucket, end - begin, key); i >= 0) on_row(bucket[i].row_id);
+            break;
+        case BucketLayout::kGrouped:
+            scan_bucket<true>(bucket, end - begin, key, [&](std::size_t i) {
+                const std::size_t g = begin + i;
+                const std::size_t run_end = g + 1 < tuples_.size() ? tuples_[g + 1].row_id : row_runs_.size();
+                for (std::size_t r = tuples_[g].row_id; r < run_end; ++r) on_row(row_runs_[r]);
+            });
+            break;
+        }
+    }
+
+    // Empty table
+    void clear() {
+        std::fill(directory_offsets_, directory_offsets_ + dir_size_, 0);
+        std::fill(bloom_filters_.begin(), bloom_filters_.end(), 0);
+        tuples_.clear();
+        row_runs_.clear();
+        layout_ = BucketLayout::kRows;
+    }
+
+    /*
+     * finalize_layout(): specialize the table to its key distribution.
+     *
+     * Equal keys always share a bucket, so the distinct keys per bucket decide the layout:
+     * - all keys distinct            -> kUnique: a probe returns at most one match
+     * - >= kGroupMinRowsPerKey rows  -> kGrouped: tuples_ becomes one (key, run start) entry
+     *   per key                         per distinct key, row ids move to row_runs_ in the
+     *                                   same order, so the run of group g ends where the
+     *                                   run of g + 1 starts; buckets shrink to distinct keys
+     * - otherwise                    -> kRows (unchanged)
+     *
+     * Buckets shorter than kSortedBucketMinRows are checked by pairwise compares up to their
+     * first repeated key; only buckets that have one are sorted (by key). Longer ones are sorted by (rank_in_slot(),
+     * key) and counted by neighbours: equal keys are adjacent for kGrouped, and the hash order
+     * is what find_unique() interpolates in for kUnique.
+     */
+    void finalize_layout(std::size_t nt) {
+        layout_ = BucketLayout::kRows;
+        row_runs_.clear();
+        const std::size_t n = tuples_.size();
+        if (n == 0) return;
+        const std::size_t ds = dir_size_;
+        if (counts_.size() != ds) counts_.assign(ds, 0);
+        if (write_ptrs_.size() != ds) write_ptrs_.assign(ds, 0);
+
+        // Distinct keys per slot into counts_
+        std::vector<std::size_t> block_keys(nt, 0);
+        run_threads(nt, [&](std::size_t b) {
+            std::size_t keys = 0;
+            std::vector<std::pair<uint64_t, uint32_t>> ranked;   // sort_by_rank() buffer
+            for (std::size_t slot = ds * b / nt; slot < ds * (b + 1) / nt; ++slot) {
+                entry_type* first = tuples_.data() + directory_offsets_[slot - 1];
+                entry_type* last = tuples_.data() + directory_offsets_[slot];
+                const std::size_t len = static_cast<std::size_t>(last - first);
+                uint32_t distinct = 0;
+                entry_type* t = first;                  // Up to the first repeated key
+                if (len < kSortedBucketMinRows)
+                    while (t != last && std::none_of(first, t, [&](const entry_type& u) { return u.key == t->key; })) ++t;
+                if (t == last) {
+                    distinct = static_cast<uint32_t>(len);
+                } else {
+                    if (len < kSortedBucketMinRows)
+                        std::sort(first, last, [](const entry_type& x, const entry_type& y) { return x.key < y.key; });
+                    else
+                        sort_by_rank(first, last, ranked);
+                    for (t = first; t != last; ++t) distinct += t == first || t->key != t[-1].key;
+                }
+                counts_[slot] = distinct;
+                keys += distinct;
+            }
+            block_keys[b] = keys;
+        });
+        std::size_t distinct = 0;
+        for (std::size_t k : block_keys) distinct += k;
+
+        if (distinct == n) {
+            layout_ = BucketLayout::kUnique;
+            return;
+        }
+        if (distinct * kGroupMinRowsPerKey > n) return;
+
+        // Group START offsets per slot
+        uint32_t cumulative = 0;
+        for (std::size_t slot = 0; slot < ds; ++slot) {
+            write_ptrs_[slot] = cumulative;
+            cumulative += counts_[slot];
+        }
+
+        std::vector<entry_type, entry_allocator> groups(distinct, tuples_.get_allocator());
+        row_runs_.resize(n);
+        run_threads(nt, [&](std::size_t b) {
+            for (std::size_t slot = ds * b / nt; slot < ds * (b + 1) / nt; ++slot) {
+                uint32_t g = write_ptrs_[slot];
+                const uint32_t first = directory_offsets_[slot - 1];
+                for (uint32_t i = first; i < directory_offsets_[slot]; ++i) {
+                    row_runs_[i] = tuples_[i].row_id;
+                    if (i == first || tuples_[i].key != tuples_[i - 1].key) groups[g++] = entry_type{tuples_[i].key, i};
+                }
+            }
+        });
+        for (std::size_t slot = 0; slot < ds; ++slot) directory_offsets_[slot] = write_ptrs_[slot] + counts_[slot];
+
+        tuples_.swap(groups);
+        layout_ = BucketLayout::kGrouped;
+    }
+
+    // Sort [first, last) by (rank_in_slot(), key). 32-bit keys are sorted as one 64-bit
+    // (rank, key) word each, so every hash is computed once; ranked is a reusable buffer.
+    void sort_by_rank(entry_type* first, entry_type* last, std::vector<std::pair<uint64_t, uint32_t>>& ranked) const {
+        if constexpr (sizeof(Key) == 4 && std::is_integral_v<Key>) {
+            ranked.clear();
+            for (entry_type* t = first; t != last; ++t)
+                ranked.emplace_back(uint64_t{rank_in_slot(compute_hash(t->key))} << 32 | static_cast<uint32_t>(t->key),
+                                    t->row_id);
+            std::sort(ranked.begin(), ranked.end(), [](const auto& x, const auto& y) { return x.first < y.first; });
+            for (const auto& [order, row_id] : ranked) *first++ = entry_type{static_cast<Key>(static_cast<uint32_t>(order)), row_id};
+        } else {
+            (void)ranked;
+            std::sort(first, last, [this](const entry_type& x, const entry_type& y) {
+                const uint32_t rx = rank_in_slot(compute_hash(x.key)), ry = rank_in_slot(compute_hash(y.key));
+                return rx != ry ? rx < ry : x.key < y.key;
+            });
+        }
+    }
+
+#ifdef SPC__UNCHAINED_AVX2_MATCH
+    // Bit i set <=> key of tuple i equals the needle; a = tuples 0-3, b = tuples 4-7 as (key, row_id) pairs
+    static unsigned match8(__m256i a, __m256i b, __m256i needle) {
+        // Even 32-bit lanes of a and b: (k0 k1 k4 k5 | k2 k3 k6 k7), then restore tuple order
+        const __m256 packed = _mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256i keys = _mm256_permute4x64_epi64(_mm256_castps_si256(packed), _MM_SHUFFLE(3, 1, 2, 0));
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(keys, needle))));
+    }
+#endif
+
+    // Run fn(t) for t in [0, nt) on the persistent pool
+    template<typename Fn>
+    static void run_threads(std::size_t nt, Fn&& fn) {
+        ThreadPool::current().run(nt, fn);
+    }
+
+    /*
+     * build_parallel():
+     *
+     * Partitioned version of the build (same result layout as the serial one):
+     *
+     * 1. Every thread counts its own slice into a private count array (no atomics)
+     * 2. Parallel prefix sum over directory_offsets_: threads own disjoint slot ranges,
+     *    and per-thread counts are turned into per-thread write cursors in place
+     * 3. Every thread scatters its slice using its own cursors (no contention,
+     *    each (thread, slot) pair owns a disjoint range of tuples_)
+     * 4. Bloom tags are computed per slot range from the scattered tuples
+     *
+     * for_each_part(t, nt, emit) must call emit(key, row_id) for every tuple of
+     * slice t, in the same order on both passes.
+     */
+    template<typename ForEachPart>
+    void build_parallel(std::size_t nt, ForEachPart&& for_each_part) {
+        const std::size_t ds = dir_size_;
+        std::vector<uint32_t> thread_counts(nt * ds, 0);   // [thread][slot] counts, later cursors
+
+        // Phase 1: per-thread counts
+        run_threads(nt, [&](std::size_t t) {
+            uint32_t* local = thread_counts.data() + t * ds;
+            for_each_part(t, nt, [&](Key key, uint32_t) {
+                local[(compute_hash(key) >> shift_) & dir_mask_]++;
+            });
+        });
+
+        // Phase 2a: per slot-block totals
+        std::vector<uint32_t> block_sums(nt + 1, 0);
+        run_threads(nt, [&](std::size_t b) {
+            uint32_t sum = 0;
+            for (std::size_t slot = ds * b / nt; slot < ds * (b + 1) / nt; ++slot)
+                for (std::size_t t = 0; t < nt; ++t) sum += thread_counts[t * ds + slot];
+            block_sums[b + 1] = sum;
+        });
+        for (std::size_t b = 0; b < nt; ++b) block_sums[b + 1] += block_sums[b]; // Exclusive scan
+
+        // Phase 2b: END pointers per slot + per-thread write cursors
+        run_threads(nt, [&](std::size_t b) {
+            uint32_t running = block_sums[b];
+            for (std::size_t slot = ds * b / nt; slot < ds * (b + 1) / nt; ++slot) {
+                for (std::size_t t = 0; t < nt; ++t) {
+                    const uint32_t c = thread_counts[t * ds + slot];
+                    thread_counts[t * ds + slot] = running; // Cursor of thread t in this slot
+                    running += c;
+                }
+                directory_offsets_[slot] = running;         // The END pointer of the slot
+            }
+        });
+
+        // Phase 3: allocate memory for tuples (not zeroed, see DefaultInitAllocator), spread
+        // over the NUMA nodes since every node probes it at random
+        interleaved_resize(tuples_, block_sums[nt]);
+
+        // Phase 4: scatter, each thread into its own cursors
+        run_threads(nt, [&](std::size_t t) {
+            uint32_t* cursor = thread_counts.data() + t * ds;
+            for_each_part(t, nt, [&](Key key, uint32_t row_id) {
+                const uint32_t pos = cursor[(compute_hash(key) >> shift_) & dir_mask_]++;
+                tuples_[pos].key = key;
+                tuples_[pos].row_id = row_id;
+            });
+        });
+
+        // Phase 5: bloom tags per slot range (slots are owned by one thread)
+        run_threads(nt, [&](std::size_t b) {
+            for (std::size_t slot = ds * b / nt; slot < ds * (b + 1) / nt; ++slot) {
+                uint16_t bloom = 0;
+                for (uint32_t i = directory_offsets_[slot - 1]; i < directory_offsets_[slot]; ++i)
+                    bloom |= Bloom::make_tag_from_hash(compute_hash(tuples_[i].key));
+                bloom_filters_[slot] = bloom;
+            }
+        });
+
+        finalize_layout(nt);
+    }
+
     // Compute hash for Key: specialized path for int32/uint32, otherwise std::hash
     uint64_t compute_hash(const Key& k) const {
         if constexpr (std::is_same_v<Key, int32_t> || std::is_same_v<Key, uint32_t>) {
@@ -278,15 +778,18 @@ private:
     // Main tuple storage (contiguous memory, prefix-ordered)
     std::vector<entry_type, entry_allocator> tuples_;
 
+    BucketLayout layout_ = BucketLayout::kRows;
+    std::vector<uint32_t, DefaultInitAllocator<uint32_t, ArenaAllocator<uint32_t>>> row_runs_; // kGrouped: row ids, grouped by key
+
     // Directory with support for a [-1] pointer
-    std::vector<uint32_t> directory_buffer_; // Actual buffer
+    storage<uint32_t> directory_buffer_;     // Actual buffer
     uint32_t* directory_offsets_;            // Offset pointer (offset +1)
 
-    std::vector<uint16_t> bloom_filters_;    // Bloom tags per slot
+    storage<uint16_t> bloom_filters_;        // Bloom tags per slot
 
     // Reusable buffers for counts/writes
-    std::vector<uint32_t> counts_;
-    std::vector<uint32_t> write_ptrs_;
+    storage<uint32_t> counts_;
+    storage<uint32_t> write_ptrs_;
 
     // Directory parameters
     std::size_t dir_size_;
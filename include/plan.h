@@ -163,6 +163,7 @@ struct Column {
 struct ColumnarTable {
     size_t              num_rows{0};
     std::vector<Column> columns;
+    std::string         source;     // Cache file the table was loaded from ("" = unknown)
 };
 
 std::tuple<std::vector<std::vector<Data>>, std::vector<DataType>> from_columnar(
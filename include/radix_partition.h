@@ -0,0 +1,230 @@
+// radix_partition.h - radix partitioning for cache-resident hash joins
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <algorithm>
+
+#include <hardware.h>
+#include "hash_common.h"
+#include "hash_functions.h"
+#include "thread_pool.h"
+
+namespace Contest {
+
+/*
+ * Radix partitioned join (see "Main-Memory Hash Joins on Multi-Core CPUs").
+ *
+ * When the build side does not fit in L2, every probe into one big table is a cache miss.
+ * Instead both sides are split by a few hash bits into partitions whose tables fit in L2,
+ * and every partition pair is joined on its own (one thread per partition at a time).
+ *
+ * Partitioning uses software write-combine buffers: each thread keeps one cache line per
+ * partition and only writes full lines to the output, so the fan-out does not thrash the TLB.
+ * The fan-out of one pass is bounded by how many of those lines fit in L1; larger fan-outs
+ * use a second pass over each first-pass partition.
+ */
+
+// Sizing parameters (derived from hardware.h)
+constexpr std::size_t kRadixCacheLine = SPC__LEVEL1_DCACHE_LINESIZE;
+constexpr std::size_t kRadixTableBudget = SPC__LEVEL2_CACHE_SIZE / 2;       // Leave half of L2 for the probe stream
+constexpr unsigned kRadixMaxBitsPerPass = 8;  // 256 lines * 64B = 16 KB of WC buffers, half of L1D
+constexpr unsigned kRadixMaxBits = 16;        // Two passes at most
+constexpr std::size_t kRadixMinRows = 1ull << 20; // Partitioning is two extra passes; skip it for small joins
+constexpr std::size_t kRadixTableBytesPerTuple = 10; // TupleEntry + directory/bloom share per tuple
+constexpr unsigned kRadixHashShift = 24;      // Radix bits [24, 40) of the hash; tables use the top bits
+
+static_assert(SPC__LEVEL1_DCACHE_SIZE >= (kRadixCacheLine << kRadixMaxBitsPerPass) * 2,
+              "write-combine buffers of one pass must fit in half of L1D");
+
+// Number of radix bits per pass (0 bits = no partitioning)
+struct RadixPlan {
+    unsigned bits1 = 0; // First pass
+    unsigned bits2 = 0; // Second pass (0 = single pass)
+
+    bool enabled() const { return bits1 > 0; }
+    unsigned total_bits() const { return bits1 + bits2; }
+    std::size_t num_partitions() const { return std::size_t{1} << total_bits(); }
+};
+
+// Choose the partitioning from the cardinalities and the cache sizes.
+// RADIX_JOIN=0 disables the mode, RADIX_JOIN=1 forces it (for experiments).
+inline RadixPlan choose_radix_plan(std::size_t build_rows, std::size_t probe_rows) {
+    static const int forced = [] {
+        const char* v = std::getenv("RADIX_JOIN");
+        if (!v || !*v) return -1;
+        return *v == '0' ? 0 : 1;
+    }();
+
+    RadixPlan plan;
+    if (forced == 0 || build_rows == 0) return plan;
+
+    const std::size_t table_bytes = build_rows * kRadixTableBytesPerTuple;
+    if (forced != 1) {
+        if (table_bytes <= SPC__LEVEL2_CACHE_SIZE) return plan;      // Already cache resident
+        if (build_rows + probe_rows < kRadixMinRows) return plan;    // Too small to pay off
+        if (probe_rows < build_rows / 2) return plan;                // Few probes: misses are cheaper than two passes
+    }
+
+    unsigned bits = 0;
+    while (bits < kRadixMaxBits && (table_bytes >> bits) > kRadixTableBudget) ++bits;
+    if (bits == 0) bits = 1;                                         // Forced mode on a small input
+
+    plan.bits1 = std::min(bits, kRadixMaxBitsPerPass);
+    plan.bits2 = bits - plan.bits1;
+    return plan;
+}
+
+// Radix of a key for a pass that uses `bits` bits starting `skip` bits above kRadixHashShift
+inline std::size_t radix_of(uint64_t h, unsigned skip, unsigned bits) {
+    return (h >> (kRadixHashShift + skip)) & ((std::size_t{1} << bits) - 1);
+}
+
+// Partitioned relation: partition p is tuples[offsets[p], offsets[p + 1])
+template<typename Key>
+struct PartitionedRelation {
+    std::vector<HashEntry<Key>, DefaultInitAllocator<HashEntry<Key>>> tuples; // Not zeroed: the scatter writes all of it
+    std::vector<std::size_t> offsets;
+
+    std::size_t num_partitions() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    std::size_t partition_size(std::size_t p) const { return offsets[p + 1] - offsets[p]; }
+    const HashEntry<Key>* partition(std::size_t p) const { return tuples.data() + offsets[p]; }
+};
+
+namespace radix_detail {
+
+// Software write-combine buffers: one cache line per partition, flushed as a whole
+template<typename Key>
+class WriteCombiner {
+public:
+    static constexpr std::size_t kSlots = kRadixCacheLine / sizeof(HashEntry<Key>);
+
+    WriteCombiner(HashEntry<Key>* out, std::vector<std::size_t> cursors)
+        : out_(out), cursors_(std::move(cursors)), lines_(cursors_.size()), fill_(cursors_.size(), 0) {}
+
+    void push(std::size_t p, const HashEntry<Key>& e) {
+        Line& line = lines_[p];
+        line.slots[fill_[p]++] = e;
+        if (fill_[p] == kSlots) {              // Full line -> one streaming write
+            std::memcpy(out_ + cursors_[p], line.slots, sizeof(line.slots));
+            cursors_[p] += kSlots;
+            fill_[p] = 0;
+        }
+    }
+
+    void flush() {
+        for (std::size_t p = 0; p < lines_.size(); ++p) {
+            if (!fill_[p]) continue;
+            std::memcpy(out_ + cursors_[p], lines_[p].slots, fill_[p] * sizeof(HashEntry<Key>));
+            cursors_[p] += fill_[p];
+            fill_[p] = 0;
+        }
+    }
+
+private:
+    struct alignas(kRadixCacheLine) Line { HashEntry<Key> slots[kSlots]; };
+
+    HashEntry<Key>* out_;
+    std::vector<std::size_t> cursors_;
+    std::vector<Line> lines_;
+    std::vector<uint32_t> fill_;
+};
+
+// Run fn(t) for t in [0, nt) on the persistent pool
+template<typename Fn>
+inline void run_threads(std::size_t nt, Fn&& fn) {
+    ThreadPool::current().run(nt, fn);
+}
+
+} // namespace radix_detail
+
+/*
+ * radix_partition():
+ *
+ * for_each_chunk(chunk, emit) calls emit(key, row_id) for every tuple of an input chunk
+ * (a page), identically on both calls. Threads own contiguous chunk ranges.
+ *
+ * Pass 1: per-thread histograms -> partition-major prefix sum -> scatter through WC buffers.
+ * Pass 2 (optional): every first-pass partition is split again by the next bits, one
+ * partition per task, into a second buffer.
+ */
+template<typename Key, typename ForEachChunk>
+PartitionedRelation<Key> radix_partition(std::size_t num_chunks, ForEachChunk&& for_each_chunk,
+                                         const RadixPlan& plan, std::size_t num_threads) {
+    Hash::Hasher32 hasher;
+    const std::size_t nt = std::max<std::size_t>(1, std::min(num_threads, num_chunks));
+    const std::size_t p1 = std::size_t{1} << plan.bits1;
+
+    // Pass 1, step 1: histograms
+    std::vector<std::size_t> hist(nt * p1, 0);
+    radix_detail::run_threads(nt, [&](std::size_t t) {
+        std::size_t* h = hist.data() + t * p1;
+        for (std::size_t c = num_chunks * t / nt; c < num_chunks * (t + 1) / nt; ++c)
+            for_each_chunk(c, [&](Key key, uint32_t) { h[radix_of(hasher(key), 0, plan.bits1)]++; });
+    });
+
+    // Step 2: partition-major prefix sum (partition p of thread t follows thread t-1)
+    PartitionedRelation<Key> pass1;
+    pass1.offsets.assign(p1 + 1, 0);
+    std::vector<std::vector<std::size_t>> cursors(nt, std::vector<std::size_t>(p1));
+    std::size_t total = 0;
+    for (std::size_t p = 0; p < p1; ++p) {
+        pass1.offsets[p] = total;
+        for (std::size_t t = 0; t < nt; ++t) {
+            cursors[t][p] = total;
+            total += hist[t * p1 + p];
+        }
+    }
+    pass1.offsets[p1] = total;
+    pass1.tuples.resize(total);
+
+    // Step 3: scatter
+    radix_detail::run_threads(nt, [&](std::size_t t) {
+        radix_detail::WriteCombiner<Key> wc(pass1.tuples.data(), std::move(cursors[t]));
+        for (std::size_t c = num_chunks * t / nt; c < num_chunks * (t + 1) / nt; ++c)
+            for_each_chunk(c, [&](Key key, uint32_t row_id) {
+                wc.push(radix_of(hasher(key), 0, plan.bits1), HashEntry<Key>{key, row_id});
+            });
+        wc.flush();
+    });
+
+    if (plan.bits2 == 0) return pass1;
+
+    // Pass 2: refine every first-pass partition by the next bits
+    const std::size_t p2 = std::size_t{1} << plan.bits2;
+    PartitionedRelation<Key> pass2;
+    pass2.tuples.resize(total);
+    pass2.offsets.assign(p1 * p2 + 1, 0);
+    pass2.offsets[p1 * p2] = total;
+
+    std::atomic<std::size_t> next{0};
+    radix_detail::run_threads(std::min(num_threads, p1), [&](std::size_t) {
+        std::vector<std::size_t> sub(p2);
+        for (std::size_t p = next.fetch_add(1); p < p1; p = next.fetch_add(1)) {
+            const HashEntry<Key>* in = pass1.partition(p);
+            const std::size_t n = pass1.partition_size(p);
+
+            std::fill(sub.begin(), sub.end(), 0);
+            for (std::size_t i = 0; i < n; ++i) sub[radix_of(hasher(in[i].key), plan.bits1, plan.bits2)]++;
+
+            std::size_t running = pass1.offsets[p];
+            for (std::size_t q = 0; q < p2; ++q) {
+                pass2.offsets[p * p2 + q] = running;       // Disjoint per first-pass partition
+                const std::size_t c = sub[q];
+                sub[q] = running;
+                running += c;
+            }
+
+            radix_detail::WriteCombiner<Key> wc(pass2.tuples.data(), sub);
+            for (std::size_t i = 0; i < n; ++i) wc.push(radix_of(hasher(in[i].key), plan.bits1, plan.bits2), in[i]);
+            wc.flush();
+        }
+    });
+    return pass2;
+}
+
+} // namespace Contest
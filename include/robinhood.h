@@ -1,16 +1,15 @@
 #pragma once
 
 #include <vector>
-#include <map>
 #include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <cmath>
-#include <utility> 
-#include <stdexcept> 
+#include <utility>
+#include <stdexcept>
 #include "hashtable_interface.h"
 #include "hash_common.h"
-#include <unordered_map>
+#include "key_groups.h"
 
 namespace Contest {
 
@@ -20,192 +19,167 @@ private:
     using Entry = HashEntry<Key>;
     using IndexInfo = KeyIndexInfo<Key>;
 
-    std::vector<Entry> _storage;
-    std::vector<IndexInfo> _table;
-    size_t _capacity = 0;
-    size_t _initial_capacity = 0;
-    static constexpr size_t MAX_REHASH_ATTEMPTS = 5;
-
-    // Hash function
-    size_t hash_fn(const Key& k) const {
-        // Use an improved hash mixing (e.g. FNV-1a style) for better
-        // dispersion and reduced clustering. Optimized for integer keys.
-        uint32_t hash = 2166136261U;
-        // FNV_PRIME_32
-        hash ^= static_cast<uint32_t>(k);
-        hash *= 16777619U;
-        // FNV_PRIME_32
-
-        // Ensure the result is within capacity
-        return static_cast<size_t>(hash) % _capacity;
-    }
+    // Robin Hood table over the keys of one partition (see key_groups.h)
+    class Table {
+    public:
+        // Insert the n keys of infos, growing the table until every one has a slot
+        void build(const IndexInfo* infos, size_t n) {
+            if (n == 0) return;
+
+            // Initial capacity settings
+            double load_factor = 0.75;
+            size_t initial_capacity = static_cast<size_t>(std::ceil(n / load_factor));
+            if (initial_capacity == 0) initial_capacity = 1;
+
+            _capacity = initial_capacity;
+
+            // Insertion loop with rehash handling
+            for (size_t attempt = 0; attempt < MAX_REHASH_ATTEMPTS; ++attempt) {
+                // Re-calculate capacity: exponential growth
+                if (attempt > 0) _capacity = _capacity * 2 + 1;
+
+                _table.assign(_capacity, IndexInfo{});   // Clear and resize table
+
+                bool insertion_successful = true;
+                for (size_t i = 0; i < n; ++i) {
+                    if (!insert_index_info(infos[i])) {
+                        insertion_successful = false;
+                        break;
+                    }
+                }
+                if (insertion_successful) return;      // SUCCESS!
+            }
 
-    // Compute the Probe Sequence Length (PSL)
-    
-    size_t psl(size_t current_slot_idx, size_t home_slot_idx) const {
-        // Compute the distance (in the circular table)
-        if (current_slot_idx >= home_slot_idx) {
-            return current_slot_idx - home_slot_idx;
-        } else {
-            // Circular distance
-            return current_slot_idx + (_capacity - home_slot_idx);
+            throw std::runtime_error("Robin Hood Hashing failed to find a valid placement after multiple rehash attempts.");
         }
-    }
 
-    // Helper function to find the home slot
-    size_t find_home(const Key& k) const {
-        if (_capacity == 0) return 0;
-        return hash_fn(k);
-    }
+        // Slot of key k, nullptr if it is not in the table
+        const IndexInfo* find(const Key& k) const {
+            if (_capacity == 0) return nullptr;
 
-    // Insert an element into the hash table using Robin Hood displacement
-    // RETURNS: true on success, false if insertion fails (table full/cycle)
-    bool insert_index_info(const IndexInfo& info) {
-        size_t home = find_home(info.key);
-        size_t current_slot = home;
-        IndexInfo current_info = info;
-        size_t attempts = 0;
-        while (_table[current_slot].is_valid) {
-            if (attempts >= _capacity) {
-                return false;
-                // Insertion failed, need to rehash
-            }
+            size_t home = find_home(k);
+            size_t current_slot = home;
 
-            size_t insert_psl = psl(current_slot, find_home(current_info.key));
-            size_t displaced_psl = psl(current_slot, find_home(_table[current_slot].key));
+            do {
+                if (!_table[current_slot].is_valid) return nullptr;
 
-            if (insert_psl > displaced_psl) { // Robin Hood: swap
-                std::swap(current_info, _table[current_slot]);
-            }
+                size_t k_psl = psl(current_slot, home);
+                size_t displaced_psl = psl(current_slot, find_home(_table[current_slot].key));
+                if (k_psl > displaced_psl) return nullptr;
+
+                if (_table[current_slot].key == k) return &_table[current_slot];
+
+                current_slot = (current_slot + 1) % _capacity;
+            } while (current_slot != home);
 
-            current_slot = (current_slot + 1) % _capacity;
-            attempts++;
+            return nullptr;
         }
 
-        _table[current_slot] = current_info;
-        _table[current_slot].is_valid = true;
-        return true; // Insertion successful
-    }
+        size_t memory_usage() const { return _table.size() * sizeof(IndexInfo); }
 
-public:
-    
-    // 3. Executor interface
-    
+    private:
+        static constexpr size_t MAX_REHASH_ATTEMPTS = 5;
 
-    RobinHoodBackend() = default;
-  
-    // Build the Robin Hood Hash Table from the build-side entries.
-     
-    void build_from_entries(const std::vector<std::pair<Key, size_t>>& entries) {
-        if (entries.empty()) {
-             _capacity = 0;
-             _table.clear(); _storage.clear();
-             return;
-        }
+        // Hash function
+        size_t hash_fn(const Key& k) const {
+            // Use an improved hash mixing (e.g. FNV-1a style) for better
+            // dispersion and reduced clustering. Optimized for integer keys.
+            uint32_t hash = 2166136261U;
+            // FNV_PRIME_32
+            hash ^= static_cast<uint32_t>(k);
+            hash *= 16777619U;
+            // FNV_PRIME_32
 
-        // 1. Preprocessing: Group entries
-        std::map<Key, std::vector<size_t>> grouped_entries;
-        for (const auto& p : entries) {
-            grouped_entries[p.first].push_back(p.second);
+            // Ensure the result is within capacity
+            return static_cast<size_t>(hash) % _capacity;
         }
 
-        // 2. Create _storage and the IndexInfo vector
-        _storage.reserve(entries.size());
-        size_t current_storage_index = 0;
-
-        std::vector<IndexInfo> index_infos_to_insert;
-        index_infos_to_insert.reserve(grouped_entries.size());
-
-        for (const auto& pair : grouped_entries) {
-            std::map<Key, std::vector<size_t>> grouped_entries; // Updated to accept HashEntry vectors
-            const std::vector<size_t>& row_ids = pair.second;
-
-            IndexInfo info;
-            info.key = pair.first;
-            info.start_index = current_storage_index;
-            info.count = row_ids.size();
-            info.is_valid = true;
-            index_infos_to_insert.push_back(info);
-            for (size_t row_id : row_ids) {
-                _storage.emplace_back(Entry{pair.first, static_cast<uint32_t>(row_id)});
+        // Compute the Probe Sequence Length (PSL)
+        size_t psl(size_t current_slot_idx, size_t home_slot_idx) const {
+            // Compute the distance (in the circular table)
+            if (current_slot_idx >= home_slot_idx) {
+                return current_slot_idx - home_slot_idx;
+            } else {
+                // Circular distance
+                return current_slot_idx + (_capacity - home_slot_idx);
             }
-            current_storage_index += row_ids.size();
         }
 
-        // 3. Initial capacity settings
-        double load_factor = 0.75;
-        _initial_capacity = static_cast<size_t>(std::ceil(index_infos_to_insert.size() / load_factor));
-        if (_initial_capacity == 0) _initial_capacity = 1;
-
-        _capacity = _initial_capacity;
-
-        size_t current_rehash_attempt = 0;
-        // 4. Insertion loop with rehash handling
-        while (current_rehash_attempt < MAX_REHASH_ATTEMPTS) {
+        // Helper function to find the home slot
+        size_t find_home(const Key& k) const {
+            if (_capacity == 0) return 0;
+            return hash_fn(k);
+        }
 
-            // Re-calculate capacity: exponential growth
-            if (current_rehash_attempt > 0) {
-                 _capacity = _capacity * 2 + 1;
-            }
+        // Insert an element into the hash table using Robin Hood displacement
+        // RETURNS: true on success, false if insertion fails (table full/cycle)
+        bool insert_index_info(const IndexInfo& info) {
+            size_t home = find_home(info.key);
+            size_t current_slot = home;
+            IndexInfo current_info = info;
+            size_t attempts = 0;
+            while (_table[current_slot].is_valid) {
+                if (attempts >= _capacity) {
+                    return false;
+                    // Insertion failed, need to rehash
+                }
 
-            _table.assign(_capacity, IndexInfo{});
-            // Clear and resize table
+                size_t insert_psl = psl(current_slot, find_home(current_info.key));
+                size_t displaced_psl = psl(current_slot, find_home(_table[current_slot].key));
 
-            bool insertion_successful = true;
-            for (const auto& info : index_infos_to_insert) {
-                if (!insert_index_info(info)) {
-                    insertion_successful = false;
-                    break;
+                if (insert_psl > displaced_psl) { // Robin Hood: swap
+                    std::swap(current_info, _table[current_slot]);
                 }
-            }
 
-            if (insertion_successful) {
-                return;
-                // SUCCESS!
+                current_slot = (current_slot + 1) % _capacity;
+                attempts++;
             }
 
-            current_rehash_attempt++;
+            _table[current_slot] = current_info;
+            _table[current_slot].is_valid = true;
+            return true; // Insertion successful
         }
 
-        throw std::runtime_error("Robin Hood Hashing failed to find a valid placement after multiple rehash attempts.");
-    }
+        std::vector<IndexInfo> _table;
+        size_t _capacity = 0;
+    };
 
-    
-     // Perform a probe for a key.
-    
-    std::pair<const Entry*, size_t> probe(const Key& k) const {
-        if (_capacity == 0 || _table.empty()) {
-            return {nullptr, 0};
-        }
+    KeyGroups<Key> _groups;                 // Entries of every key, contiguous
+    std::vector<Table> _tables;             // One per partition of _groups
 
-        size_t home = find_home(k);
-        size_t current_slot = home;
+public:
 
-        size_t k_psl;
-        do {
-            if (!_table[current_slot].is_valid) {
-                return {nullptr, 0};
-            }
+    // 3. Executor interface
 
-            k_psl = psl(current_slot, home);
-            size_t displaced_psl = psl(current_slot, find_home(_table[current_slot].key));
 
-            if (k_psl > displaced_psl) {
-                return {nullptr, 0};
-            }
+    RobinHoodBackend() = default;
+
+    // Build the Robin Hood Hash Table from the grouped build-side entries,
+    // one partition table per task
+    void build(KeyGroups<Key> groups) {
+        _groups = std::move(groups);
+        _tables.assign(_groups.num_partitions(), Table{});
+        for_each_key_partition(_tables.size(), [&](size_t p) {
+            _tables[p].build(_groups.partition_infos(p), _groups.partition_keys(p));
+        });
+        std::vector<IndexInfo>().swap(_groups.infos);   // Copied into the tables
+    }
 
-            if (_table[current_slot].key == k) {
-                return {
-                    &_storage[_table[current_slot].start_index],
-                    _table[current_slot].count
-                };
-            }
 
-            current_slot = (current_slot + 1) % _capacity;
-        } while (current_slot != home);
+     // Perform a probe for a key.
+
+    std::pair<const Entry*, size_t> probe(const Key& k) const {
+        if (_groups.num_entries() == 0) return {nullptr, 0};
+        const IndexInfo* info = _tables[_groups.partition_of(k)].find(k);
+        if (!info) return {nullptr, 0};
+        return {_groups.entry(info->start_index), info->count};
+    }
 
-        return {nullptr, 0};
+    size_t memory_usage() const {
+        size_t bytes = _groups.num_entries() * sizeof(Entry);
+        for (const Table& t : _tables) bytes += t.memory_usage();
+        return bytes;
     }
 };
 
-} // namespace Contest
\ No newline at end of file
+} // namespace Contest
@@ -0,0 +1,90 @@
+// runtime_filter.h - join filters built from build keys and pushed into probe-side scans
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include <hardware.h>
+#include "hash_functions.h"
+
+namespace Contest {
+
+/*
+ * Sideways information passing.
+ *
+ * Once the build side of a join is known, a probe row whose key is not among the build
+ * keys can never produce output. A RuntimeFilter summarizes the build keys as a min/max
+ * range plus a register-blocked Bloom filter (every key sets 4 bits inside one 64-bit word,
+ * so a lookup is one load and one AND), and the scan that produces the probe key drops
+ * non-matching rows before they are materialized.
+ */
+
+constexpr std::size_t kRuntimeFilterBitsPerKey = 16;      // ~0.5% false positives with 4 bits per key
+constexpr std::size_t kRuntimeFilterMaxBytes = SPC__LEVEL2_CACHE_SIZE; // Larger filters miss the cache on every row
+constexpr std::size_t kRuntimeFilterMaxKeys = kRuntimeFilterMaxBytes * 8 / kRuntimeFilterBitsPerKey;
+constexpr std::size_t kRuntimeFilterMinDropPercent = 25; // Scans keep zero-copy columns unless this many rows go
+
+class RuntimeFilter {
+public:
+    explicit RuntimeFilter(std::size_t expected_keys) {
+        std::size_t words = 1;
+        unsigned log_words = 0;
+        while (words * 64 < expected_keys * kRuntimeFilterBitsPerKey) {
+            words <<= 1;
+            ++log_words;
+        }
+        words_.assign(words, 0);
+        shift_ = 64 - log_words;
+    }
+
+    void insert(int32_t key) {
+        const uint64_t h = hasher_(key);
+        words_[word_of(h)] |= mask_of(h);
+        min_ = std::min(min_, key);
+        max_ = std::max(max_, key);
+        ++num_keys_;
+    }
+
+    // false = the key is certainly not a build key
+    bool may_contain(int32_t key) const {
+        if (key < min_ || key > max_) return false;
+        const uint64_t h = hasher_(key);
+        const uint64_t mask = mask_of(h);
+        return (words_[word_of(h)] & mask) == mask;
+    }
+
+    std::size_t num_keys() const { return num_keys_; }
+    std::size_t memory_bytes() const { return words_.size() * sizeof(uint64_t); }
+    int32_t min_key() const { return min_; }
+    int32_t max_key() const { return max_; }
+
+private:
+    // Word from the top hash bits (shift_ == 64 -> single word)
+    std::size_t word_of(uint64_t h) const { return shift_ >= 64 ? 0 : static_cast<std::size_t>(h >> shift_); }
+
+    // 4 bit positions from the low half, folded with the high half
+    static uint64_t mask_of(uint64_t h) {
+        const uint64_t m = h ^ (h >> 32);
+        return (1ull << (m & 63)) | (1ull << ((m >> 6) & 63)) |
+               (1ull << ((m >> 12) & 63)) | (1ull << ((m >> 18) & 63));
+    }
+
+    Hash::Hasher32 hasher_;
+    std::vector<uint64_t> words_;
+    unsigned shift_ = 64;
+    int32_t min_ = std::numeric_limits<int32_t>::max();
+    int32_t max_ = std::numeric_limits<int32_t>::min();
+    std::size_t num_keys_ = 0;
+};
+
+// A filter pushed into a scan: rows whose base column value fails it are skipped
+struct ScanFilter {
+    std::size_t column;                            // Base table column index
+    std::shared_ptr<const RuntimeFilter> filter;
+};
+
+} // namespace Contest
@@ -0,0 +1,36 @@
+// semijoin.h - Yannakakis-style semi-join reduction of the base scans of a plan
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+#include "plan.h"
+
+namespace Contest {
+
+/*
+ * Semi-join reduction (Yannakakis).
+ *
+ * Every join of the plan compares one column of a scan in its left subtree with one column
+ * of a scan in its right subtree, so the joins form a tree over the base scans. Two passes
+ * of semi-joins over that tree (leaves -> root, then root -> leaves) remove every base row
+ * that does not take part in the final result. Running the normal join tree on the reduced
+ * scans then bounds every intermediate by the input plus output size, even for
+ * many-to-many joins whose unreduced intermediates explode.
+ */
+
+// The scan node and base column that produce output column `col` of node_idx
+// (inner joins keep key values, so a join key is always some scan's base column)
+std::pair<std::size_t, std::size_t> trace_to_scan(const Plan& plan, std::size_t node_idx, std::size_t col);
+
+// Whether the reduction is requested (env SEMIJOIN_REDUCTION, default disabled)
+bool semijoin_reduction_enabled();
+
+// Row selections per plan node: for scan nodes keep[row] = 1 if the base row survives the
+// reduction. Nodes that are not scans (or plans that cannot be reduced, e.g. non-INT32
+// join keys) get an empty vector, which means "all rows".
+std::vector<std::vector<uint8_t>> semijoin_reduce(const Plan& plan);
+
+} // namespace Contest
@@ -0,0 +1,75 @@
+// skew.h - heavy-hitter build keys whose matches are written by several threads
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hashtable_interface.h"
+#include "hash_functions.h"
+
+namespace Contest {
+
+/*
+ * Skew handling of the two-pass hash join.
+ *
+ * Morsels split the probe side, but every match of one probe row is written by the thread
+ * that probed it: a build key with thousands of duplicates (a hot movie_id) turns each of
+ * its probe rows into one long serial write at the tail of the join.
+ *
+ * HeavyHitters samples the build keys, confirms the frequent ones against the table and
+ * keeps their match lists. The join then counts and writes only the light keys per morsel;
+ * probe rows of heavy keys are set aside, and their output is split into chunks of
+ * kSkewChunkRows that any thread can write. A pipelined chain (JoinPipeline) detects them per
+ * stage; its chunks carry the set-aside tuples through the remaining stages.
+ *
+ * SKEW_JOIN=0 disables the detection (for experiments).
+ */
+
+constexpr std::size_t kSkewSampleRows = 4096;   // Build rows sampled per join
+constexpr std::size_t kSkewMinMatches = 4096;   // Matches that make a key heavy
+constexpr std::size_t kSkewMaxKeys = 64;
+constexpr std::size_t kSkewChunkRows = 16384;   // Output rows per heavy-hitter task
+
+bool skew_handling_enabled();
+
+class HeavyHitters {
+public:
+    HeavyHitters() { slots_.fill(-1); }
+
+    // Heavy keys among sample, the keys of build rows taken every build_rows / sample.size()
+    // rows, confirmed against table (at most kSkewMaxKeys, the most frequent first)
+    static HeavyHitters detect(const IHashTable<int32_t>& table, std::vector<int32_t> sample,
+                               std::size_t build_rows);
+
+    bool empty() const { return keys_.empty(); }
+    std::size_t size() const { return keys_.size(); }
+
+    // Index of key, -1 if it is not heavy
+    int find(int32_t key) const {
+        for (std::size_t s = slot_of(key);; s = (s + 1) & (kSlots - 1)) {
+            const int h = slots_[s];
+            if (h < 0 || keys_[h] == key) return h;
+        }
+    }
+
+    int32_t key(std::size_t h) const { return keys_[h]; }
+    // Build rows of heavy key h
+    const std::vector<uint32_t>& rows(std::size_t h) const { return rows_[h]; }
+
+private:
+    static constexpr std::size_t kSlots = 256;  // Power of two > 2 * kSkewMaxKeys
+
+    static std::size_t slot_of(int32_t key) {
+        return static_cast<std::size_t>(Hash::mix64(static_cast<uint32_t>(key)) >> 56) & (kSlots - 1);
+    }
+
+    void add(int32_t key, std::vector<uint32_t> rows);
+
+    std::array<int8_t, kSlots> slots_;          // Index into keys_/rows_, -1 = empty
+    std::vector<int32_t> keys_;
+    std::vector<std::vector<uint32_t>> rows_;
+};
+
+} // namespace Contest
@@ -0,0 +1,86 @@
+// spill.h - grace hash join partitions in temporary files under a memory budget
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "plan.h"
+#include "hash_functions.h"
+
+namespace Contest {
+
+/*
+ * Grace hash join support.
+ *
+ * A join whose build side does not fit in the executor's memory budget is run as a grace
+ * hash join: both inputs are split by hash into partitions that go to a temporary file as
+ * (key, row id) pairs, then partition pairs are joined one at a time, so only one
+ * partition's table is in memory at any time. The matches go to a third file and are read
+ * back at the end: the join's row-id output (8 bytes per output row) is the part that still
+ * has to fit in memory, and is not charged against the budget. A pipelined join chain stops
+ * at a join whose scanned build side is beyond the budget, so that join spills too.
+ *
+ * A spilled page pair is two pages in the regular INT32 Page format (row count, value
+ * count, values, validity bitmap; never NULL): the keys and the row ids of up to
+ * kSpillRowsPerPage rows.
+ *
+ * JOIN_MEMORY_MB sets the budget (0 = unlimited), SPILL_DIR the directory of the
+ * temporary files (default: the system temp directory). GRACE_JOIN=0 disables the mode,
+ * GRACE_JOIN=1 forces it for every join that is not cached (for experiments).
+ */
+
+constexpr std::size_t kSpillRowsPerPage = 1984;         // INT32 rows of one Page without NULLs
+constexpr std::size_t kGraceBytesPerBuildRow = 20;      // Entry copy + tuple + directory/bloom share
+constexpr std::size_t kGraceMaxPartitions = 256;
+
+// Default budget: half of the node's DRAM or of this machine's, whichever is smaller
+std::size_t join_memory_budget_default();
+
+// Number of grace partitions for a build side of build_rows under budget (0 = in memory)
+std::size_t choose_grace_partitions(std::size_t build_rows, std::size_t budget);
+
+// Partition of a key (bits independent of the table's directory bits)
+inline std::size_t grace_partition_of(int32_t key, std::size_t num_partitions) {
+    return (Hash::mix64(static_cast<uint32_t>(key)) >> 40) & (num_partitions - 1);
+}
+
+// Unlinked temporary file holding the page pairs of num_partitions partitions.
+// append() and read_page() may be called from several threads.
+class SpillFile {
+public:
+    explicit SpillFile(std::size_t num_partitions);
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // Append the n <= kSpillRowsPerPage pairs (keys[i], rows[i]) to partition p
+    void append(std::size_t partition, const int32_t* keys, const uint32_t* rows, std::size_t n);
+
+    std::size_t num_partitions() const { return pages_.size(); }
+    std::size_t num_pages(std::size_t partition) const { return pages_[partition].size(); }
+    std::size_t num_rows(std::size_t partition) const { return rows_[partition]; }
+    std::size_t page_rows(std::size_t partition, std::size_t page) const { return page_rows_[partition][page]; }
+    std::size_t bytes_written() const { return end_.load(std::memory_order_relaxed); }
+
+    // Read page pair `page` of partition p into keys/rows (kSpillRowsPerPage each), returns
+    // its number of rows. Call after the last append().
+    std::size_t read_page(std::size_t partition, std::size_t page, int32_t* keys, uint32_t* rows) const;
+
+private:
+    int fd_ = -1;
+    std::atomic<uint64_t> end_{0};                      // Next free offset
+    std::mutex mutex_;                                  // Guards pages_/page_rows_/rows_
+    std::vector<std::vector<uint64_t>> pages_;          // File offset of every page pair
+    std::vector<std::vector<uint32_t>> page_rows_;      // Rows of every page pair
+    std::vector<std::size_t> rows_;
+};
+
+// Encode n values as an INT32 page without NULLs / decode one (returns the row count)
+void write_int32_page(Page& page, const int32_t* values, std::size_t n);
+std::size_t read_int32_page(const Page& page, int32_t* values);
+
+} // namespace Contest
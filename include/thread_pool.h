@@ -0,0 +1,79 @@
+// thread_pool.h - persistent worker pool shared by scans, filters and joins
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Contest {
+
+/*
+ * ThreadPool: workers are created once (per context) instead of once per join/predicate.
+ *
+ * A job is a number of tasks handed out through an atomic counter, so idle workers claim
+ * tasks as they come (same dispatch as WorkStealingCoordinator). The calling thread always
+ * takes part in its own job, which makes nested jobs safe: a job never waits for a task that
+ * nobody is running, even if every worker is busy.
+ * A task that throws does not unwind through the pool: the first exception is kept, the
+ * job's remaining tasks are skipped, and run() rethrows it to the caller once no thread
+ * uses the job any more.
+ * On multi-node machines every worker is pinned to the CPUs of one NUMA node (see numa.h).
+ */
+class ThreadPool {
+public:
+    // num_threads counts the calling thread (0 = one per hardware thread)
+    explicit ThreadPool(std::size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that can work on one job (workers + caller)
+    std::size_t num_threads() const { return workers_.size() + 1; }
+
+    // Run fn(task) for every task in [0, tasks) and wait for all of them.
+    // Each task id runs at most once (exactly once unless a task throws), so per-task
+    // outputs can be indexed by it. The first exception of a task is rethrown here.
+    void run(std::size_t tasks, const std::function<void(std::size_t)>& fn);
+
+    // Morsel dispatch: fn(begin, end) over blocks of [0, total) sized like WorkStealingConfig,
+    // threads take the blocks of their NUMA node's range first (NodeAwareCoordinator)
+    void for_each_morsel(std::size_t total, std::size_t min_block,
+                         const std::function<void(std::size_t, std::size_t)>& fn);
+
+    // Pool of the current context (falls back to a process-wide pool)
+    static ThreadPool& current();
+    // Make pool the current one (nullptr restores the fallback)
+    static void install(ThreadPool* pool);
+
+private:
+    struct Job {
+        const std::function<void(std::size_t)>* fn;
+        std::size_t tasks;
+        std::atomic<std::size_t> next{0};   // Next task to claim
+        std::atomic<std::size_t> done{0};   // Finished (or skipped) tasks
+        std::atomic<bool> failed{false};    // A task threw: skip the rest
+        std::exception_ptr error;           // First exception, guarded by mutex
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    // Claim and run tasks of job until none are left
+    static void work_on(Job& job);
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<Job>> queue_;  // Jobs with unclaimed tasks
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+} // namespace Contest
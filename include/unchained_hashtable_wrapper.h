@@ -20,7 +20,8 @@ public:
                                     const std::vector<std::size_t>& page_offsets,
                                     std::size_t num_rows) override {
         table_.reserve(num_rows);
-        table_.build_from_zero_copy_int32(src_column, page_offsets, num_rows);
+        table_.build_from_zero_copy_int32(src_column, page_offsets, num_rows,
+                                          parallel_build_threads(num_rows, table_.directory_size()));
         return true;
     }
 
@@ -30,7 +31,7 @@ public:
     }
 
     void build_from_entries(const std::vector<HashEntry<Key>>& entries) override {
-        table_.build_from_entries(entries);
+        table_.build_from_entries(entries, parallel_build_threads(entries.size(), table_.directory_size()));
     }
 
     const HashEntry<Key>* probe(const Key& key, size_t& len) const override {
@@ -40,12 +41,16 @@ public:
         
         return reinterpret_cast<const HashEntry<Key>*>(internal_bucket);
     }
-};
 
+    void probe_batch(const Key* keys, size_t n, std::vector<ProbeMatch>& out) const override {
+        table_.probe_batch(keys, n, out);
+    }
 
-template <typename Key>
-std::unique_ptr<IHashTable<Key>> create_hashtable() {
-    return std::make_unique<UnchainedHashTableWrapper<Key>>();
-}
+    size_t count_batch(const Key* keys, size_t n) const override {
+        return table_.count_batch(keys, n);
+    }
+
+    size_t memory_usage() const override { return table_.memory_usage(); }
+};
 
 } // namespace Contest
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <vector>
 #include <functional>
+#include <memory>
 
 namespace Contest {
 
@@ -33,6 +34,26 @@ private:
     std::atomic<size_t> work_counter_;  // Atomic progress counter
 };
 
+// Work stealing over one contiguous range per NUMA node: a thread claims blocks of its own
+// node's range first and steals from the other ranges once it is drained. Operators that
+// split the same rows the same way thus read on the node that wrote them.
+class NodeAwareCoordinator {
+public:
+    NodeAwareCoordinator(size_t total_work, size_t block_size, size_t num_nodes);
+
+    // Claim a block, preferring the range of node; false when all work is claimed
+    bool steal_block(size_t node, size_t& begin, size_t& end);
+
+private:
+    struct Range {
+        size_t begin, end;
+        std::atomic<size_t> next;       // Next unclaimed item
+    };
+    size_t block_size_;
+    size_t num_ranges_;
+    std::unique_ptr<Range[]> ranges_;
+};
+
 } // namespace Contest
 
 #endif // WORK_STEALING_H
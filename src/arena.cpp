@@ -0,0 +1,121 @@
+// arena.cpp - huge-page chunks and bulk release
+#include "arena.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace Contest {
+
+static std::atomic<Arena*> g_current_arena{nullptr};
+static thread_local Arena* t_scope_arena = nullptr;
+static thread_local bool t_scope_set = false;
+
+static std::size_t round_up(std::size_t bytes, std::size_t to) { return (bytes + to - 1) / to * to; }
+
+void* Arena::map(std::size_t bytes) {
+    static const bool try_hugetlb = [] {
+        const char* v = std::getenv("ARENA_HUGETLB");
+        return v && *v == '1';
+    }();
+#ifdef MAP_HUGETLB
+    if (try_hugetlb) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) return p;                     // Reserved huge pages available
+    }
+#else
+    (void)try_hugetlb;
+#endif
+    // Over-map by one huge page and trim, so the block starts on a 2 MB boundary
+    const std::size_t span = bytes + kHugePage;
+    void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = round_up(begin, kHugePage);
+    if (aligned > begin) munmap(raw, aligned - begin);
+    const uintptr_t tail = aligned + bytes;
+    if (begin + span > tail) munmap(reinterpret_cast<void*>(tail), begin + span - tail);
+#ifdef MADV_HUGEPAGE
+    madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+}
+
+void* Arena::allocate(std::size_t bytes) {
+    bytes = round_up(std::max<std::size_t>(bytes, 1), kAlign);
+    if (bytes > kLargeBytes) {
+        const std::size_t size = round_up(bytes, kHugePage);
+        void* p = map(size);
+        mapped_.fetch_add(size, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        large_.emplace_back(p, size);
+        return p;
+    }
+
+    for (;;) {
+        Chunk* chunk = current_.load(std::memory_order_acquire);
+        if (chunk) {
+            const std::size_t offset = chunk->used.fetch_add(bytes, std::memory_order_relaxed);
+            if (offset + bytes <= chunk->size) return chunk->base + offset;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_.load(std::memory_order_relaxed) != chunk) continue;   // Another thread added one
+        auto next = std::make_unique<Chunk>();
+        next->base = static_cast<char*>(map(kChunkBytes));
+        next->size = kChunkBytes;
+        mapped_.fetch_add(kChunkBytes, std::memory_order_relaxed);
+        current_.store(next.get(), std::memory_order_release);
+        chunks_.push_back(std::move(next));
+    }
+}
+
+void Arena::deallocate(void* p, std::size_t bytes) {
+    bytes = round_up(std::max<std::size_t>(bytes, 1), kAlign);
+    if (bytes <= kLargeBytes || p == nullptr) return;     // Small blocks go with the chunk
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(large_.begin(), large_.end(), [p](const auto& block) { return block.first == p; });
+    if (it == large_.end()) return;
+    munmap(it->first, it->second);
+    mapped_.fetch_sub(it->second, std::memory_order_relaxed);
+    large_.erase(it);
+}
+
+void Arena::release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_.store(nullptr, std::memory_order_release);
+    for (auto& chunk : chunks_) munmap(chunk->base, chunk->size);
+    for (auto& [p, size] : large_) munmap(p, size);
+    chunks_.clear();
+    large_.clear();
+    mapped_.store(0, std::memory_order_relaxed);
+}
+
+Arena* Arena::current() {
+    if (t_scope_set) return t_scope_arena;
+    return g_current_arena.load(std::memory_order_acquire);
+}
+
+void Arena::install(Arena* arena) {
+    g_current_arena.store(arena, std::memory_order_release);
+}
+
+bool Arena::enabled() {
+    static const bool disabled = [] {
+        const char* v = std::getenv("ARENA");
+        return v && *v == '0';
+    }();
+    return !disabled;
+}
+
+Arena::Scope::Scope(Arena* arena) : prev_(t_scope_arena), prev_set_(t_scope_set) {
+    t_scope_arena = arena;
+    t_scope_set = true;
+}
+
+Arena::Scope::~Scope() {
+    t_scope_arena = prev_;
+    t_scope_set = prev_set_;
+}
+
+} // namespace Contest
@@ -199,7 +199,7 @@ ColumnarTable Table::from_cache(const std::filesystem::path& path) {
             data += PAGE_SIZE;
         }
     }
-    return ColumnarTable{meta->num_rows, std::move(columns)};
+    return ColumnarTable{meta->num_rows, std::move(columns), path.string()};
 }
 
 #endif
@@ -61,16 +61,10 @@ ColumnBuffer join_columnbuffer_hash(const Plan& plan,
 
             T probe_key = v.as_i32();
 
-            std::size_t len = 0;
-            const auto* base = ht.probe(probe_key, len); // Find bucket
-            if (!base) continue;
-
-            for (std::size_t k = 0; k < len; ++k) {
-                if (base[k].key == probe_key) { // Confirm same key
-                    if (build_left_side) emit_pair(static_cast<size_t>(base[k].row_id), j);
-                    else emit_pair(j, static_cast<size_t>(base[k].row_id));
-                }
-            }
+            ht.for_each_match(probe_key, [&](uint32_t row) { // Rows with the same key
+                if (build_left_side) emit_pair(static_cast<size_t>(row), j);
+                else emit_pair(j, static_cast<size_t>(row));
+            });
         }
     };
 
@@ -99,16 +93,10 @@ ColumnBuffer join_columnbuffer_hash(const Plan& plan,
             if (v.is_null()) continue;
 
             uint64_t key = v.as_ref();           // Packed ref
-            std::size_t len = 0;
-            const auto* base = ht.probe(key, len);
-            if (!base) continue;
-
-            for (std::size_t k = 0; k < len; ++k) {
-                if (base[k].key == key) {
-                    if (build_left_side) emit_pair(static_cast<size_t>(base[k].row_id), j);
-                    else emit_pair(j, static_cast<size_t>(base[k].row_id));
-                }
-            }
+            ht.for_each_match(key, [&](uint32_t row) {
+                if (build_left_side) emit_pair(static_cast<size_t>(row), j);
+                else emit_pair(j, static_cast<size_t>(row));
+            });
         }
     };
 
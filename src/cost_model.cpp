@@ -0,0 +1,210 @@
+// cost_model.cpp - calibration and persistence of the cost model
+#include "cost_model.h"
+#include "thread_pool.h"
+#include "parallel_unchained_hashtable.h"
+#include "late_materialization.h"
+#include <hardware.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Contest {
+
+static std::atomic<const CostModel*> g_current_model{nullptr};
+
+// Cache size of this machine (hardware.h describes the benchmark VM only)
+static std::size_t cache_bytes(int sysconf_name, std::size_t fallback) {
+    const long v = sysconf(sysconf_name);
+    return v > 0 ? static_cast<std::size_t>(v) : fallback;
+}
+static std::size_t l2_bytes() { return cache_bytes(_SC_LEVEL2_CACHE_SIZE, SPC__LEVEL2_CACHE_SIZE); }
+static std::size_t llc_bytes() { return cache_bytes(_SC_LEVEL3_CACHE_SIZE, SPC__LEVEL3_CACHE_SIZE); }
+
+std::size_t CostModel::threads_for(std::size_t items, double item_ns, std::size_t max_threads) const {
+    if (max_threads <= 1) return 1;
+    const double per_thread = kMinWakeupsPerThread * wakeup_ns;      // Least work worth a thread
+    const double threads = static_cast<double>(items) * item_ns / per_thread;
+    if (threads < 2) return 1;
+    return std::min(max_threads, static_cast<std::size_t>(threads));
+}
+
+std::size_t CostModel::morsel_rows(double item_ns) const {
+    const double rows = kMorselNs / std::max(item_ns, 0.01);
+    if (rows <= kMinMorselRows) return kMinMorselRows;
+    if (rows >= kMaxMorselRows) return kMaxMorselRows;
+    return static_cast<std::size_t>(rows);
+}
+
+double CostModel::probe_ns(std::size_t table_bytes) const {
+    const double l2 = static_cast<double>(l2_bytes());
+    const double llc = std::max(static_cast<double>(llc_bytes()), 2 * l2);
+    const double bytes = static_cast<double>(table_bytes);
+    if (bytes <= l2) return probe_cache_ns;
+    if (bytes >= llc) return probe_dram_ns;
+    const double f = std::log(bytes / l2) / std::log(llc / l2);
+    return probe_cache_ns * std::pow(probe_dram_ns / probe_cache_ns, f);
+}
+
+// ----------------------------------------------------------------------------
+// CALIBRATION
+// ----------------------------------------------------------------------------
+
+template <typename Fn>
+static double elapsed_ns(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Median of `runs` timings of fn
+template <typename Fn>
+static double median_ns(int runs, Fn&& fn) {
+    std::vector<double> samples;
+    for (int i = 0; i < runs; ++i) samples.push_back(elapsed_ns(fn));
+    std::nth_element(samples.begin(), samples.begin() + runs / 2, samples.end());
+    return samples[runs / 2];
+}
+
+// Nanoseconds per batched probe of a table with table_rows distinct keys (every probe hits)
+static double measure_probe_ns(std::size_t table_rows) {
+    constexpr std::size_t kProbes = 1u << 18;
+    constexpr std::size_t kBatch = 1024;
+    auto key_of = [](std::size_t row) { return static_cast<int32_t>(row * 2654435761u); };
+
+    FlatUnchainedHashTable<int32_t> table;
+    {
+        std::vector<HashEntry<int32_t>> entries(table_rows);   // Freed before probing
+        for (std::size_t i = 0; i < table_rows; ++i) entries[i] = HashEntry<int32_t>{key_of(i), static_cast<uint32_t>(i)};
+        table.reserve(table_rows);
+        table.build_from_entries(entries, parallel_build_threads(table_rows, table.directory_size()));
+    }
+
+    std::vector<int32_t> keys(kProbes);
+    uint64_t state = 0x9e3779b97f4a7c15ull;             // Random rows (xorshift)
+    for (auto& k : keys) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        k = key_of(state % table_rows);
+    }
+
+    std::size_t matches = 0;
+    auto probe_all = [&] {
+        for (std::size_t i = 0; i < kProbes; i += kBatch) matches += table.count_batch(keys.data() + i, kBatch);
+    };
+    probe_all();                                        // Warm up (page faults, caches)
+    const double ns = median_ns(3, probe_all);
+    return matches > 0 ? ns / kProbes : 0;
+}
+
+// Nanoseconds per output cell gathered through a row id (finalize / value_t output pages)
+static double measure_cell_ns() {
+    constexpr std::size_t kRows = 1u << 20;
+    std::vector<value_t> base(kRows);
+    std::vector<uint32_t> row_ids(kRows);
+    for (std::size_t i = 0; i < kRows; ++i) {
+        base[i] = value_t::make_i32(static_cast<int32_t>(i));
+        row_ids[i] = static_cast<uint32_t>((i * 2654435761u) % kRows);
+    }
+    std::vector<value_t> out(kRows);
+    auto gather = [&] {
+        for (std::size_t i = 0; i < kRows; ++i) out[i] = base[row_ids[i]];
+    };
+    gather();
+    return median_ns(3, gather) / kRows;
+}
+
+CostModel CostModel::calibrate(ThreadPool& pool) {
+    CostModel model;
+    const std::size_t nt = pool.num_threads();
+    if (nt > 1) {
+        auto wake = [&] { pool.run(nt, [](std::size_t) {}); };
+        wake();
+        model.wakeup_ns = std::max(1.0, median_ns(31, wake));
+    }
+
+    // Cache resident: tuples + directory well within L2. DRAM: twice the LLC, at most
+    // kMaxDramProbeBytes (an LLC of hundreds of MB would make calibration slow and huge).
+    model.probe_cache_ns = measure_probe_ns(std::max<std::size_t>(1024, l2_bytes() / 4 / sizeof(HashEntry<int32_t>)));
+    const std::size_t dram_bytes = std::min(2 * llc_bytes(), kMaxDramProbeBytes);
+    model.probe_dram_ns = std::max(model.probe_cache_ns, measure_probe_ns(dram_bytes / sizeof(HashEntry<int32_t>)));
+    model.cell_ns = measure_cell_ns();
+    return model;
+}
+
+// ----------------------------------------------------------------------------
+// PROFILE
+// ----------------------------------------------------------------------------
+
+bool CostModel::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    CostModel loaded;
+    int found = 0;
+    std::string name;
+    double value;
+    while (in >> name >> value) {
+        if (!(value > 0)) continue;
+        if (name == "wakeup_ns") loaded.wakeup_ns = value;
+        else if (name == "probe_cache_ns") loaded.probe_cache_ns = value;
+        else if (name == "probe_dram_ns") loaded.probe_dram_ns = value;
+        else if (name == "cell_ns") loaded.cell_ns = value;
+        else continue;
+        ++found;
+    }
+    if (found < 4) return false;                        // Incomplete profile: keep this model
+    *this = loaded;
+    return true;
+}
+
+bool CostModel::save(const std::string& path) const {
+    std::ofstream out(path);
+    out << "wakeup_ns " << wakeup_ns << '\n'
+        << "probe_cache_ns " << probe_cache_ns << '\n'
+        << "probe_dram_ns " << probe_dram_ns << '\n'
+        << "cell_ns " << cell_ns << '\n';
+    return static_cast<bool>(out);
+}
+
+std::string CostModel::profile_path(std::size_t num_threads) {
+    if (const char* v = std::getenv("COST_PROFILE"); v && *v) return v;
+    std::error_code ec;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+    if (ec) return {};
+    return (dir / ("join_cost_profile_" + std::to_string(num_threads) + "t")).string();
+}
+
+const CostModel& CostModel::process_default() {
+    static const CostModel model = [] {
+        const char* calibration = std::getenv("COST_CALIBRATION");
+        if (calibration && *calibration == '0') return defaults();
+
+        CostModel m;
+        ThreadPool& pool = ThreadPool::current();
+        const std::string profile = profile_path(pool.num_threads());
+        if (!profile.empty() && m.load(profile)) return m;
+        m = calibrate(pool);
+        if (!profile.empty()) m.save(profile);      // Best effort: a read-only directory only costs a recalibration
+        return m;
+    }();
+    return model;
+}
+
+const CostModel& CostModel::current() {
+    if (const CostModel* model = g_current_model.load(std::memory_order_acquire)) return *model;
+    static const CostModel fallback = defaults();       // Used before/without a context
+    return fallback;
+}
+
+void CostModel::install(const CostModel* model) {
+    g_current_model.store(model, std::memory_order_release);
+}
+
+} // namespace Contest
@@ -5,23 +5,257 @@
 #include <atomic>                  
 #include <cstdlib>                 
 #include <cstdio>                  
-#include <thread>                  
+#include <cstring>                 
+#include <algorithm>               
+#include <exception>               
+#include <functional>              
+#include <memory>                  
+#include <mutex>                   
+#include <limits>                  
 #include "columnar.h"             
 #include "hashtable_interface.h"  
 #include "join_telemetry.h"       
 #include "work_stealing.h"        
+#include "radix_partition.h"      
+#include "thread_pool.h"          
+#include "cost_model.h"           
+#include "numa.h"                 
+#include "spill.h"                
+#include "skew.h"                 
+#include "semijoin.h"             
+#include "dense_array_table.h"    
+#include "linear_probing_table.h" 
+#include "join_table_choice.h"    
+#include "hashtable_cache.h"      
 
-#include "unchained_hashtable_wrapper.h"   // Parallel unchained (default)
-// Hash Table implementations (keep the fastest)
-//#include "robinhood_wrapper.h"
-//#include "cuckoo_wrapper.h"
-//#include "hopscotch_wrapper.h"
+#include "hashtable_backend.h"     // Unchained by default, HASH_TABLE selects another
 namespace Contest {
 
 using ExecuteResult = ColumnBuffer;                       // Intermediate results buffer
-ExecuteResult execute_impl(const Plan& plan, size_t node_idx); // Forward declaration
 
-// JoinAlgorithm (INT32-only)
+// Per-query execution state shared by all operators of one plan
+struct QueryState {
+    const Plan& plan;
+    std::vector<std::vector<ScanFilter>> scan_filters;    // Runtime join filters per scan node
+    std::vector<std::vector<uint8_t>> scan_selection;     // Semi-join reduced rows per scan node (empty = all)
+    HashTableCache* table_cache = nullptr;                 // Hash tables kept across queries (optional)
+    size_t join_memory_budget = 0;                         // Grace join beyond this many bytes (0 = unlimited)
+
+    explicit QueryState(const Plan& p) : plan(p), scan_filters(p.nodes.size()), scan_selection(p.nodes.size()) {}
+};
+
+// Cache key of a hash table over column col of node_idx's result, "" when it cannot be reused:
+// only scans that returned every row of a base table loaded from a cache file qualify.
+static std::string table_cache_key(const QueryState& query, size_t node_idx, const ColumnBuffer& result, size_t col) {
+    const auto* scan = std::get_if<ScanNode>(&query.plan.nodes[node_idx].data);
+    if (!query.table_cache || !scan) return {};
+    const ColumnarTable& input = query.plan.inputs[scan->base_table_id];
+    if (input.source.empty() || result.num_rows != input.num_rows) return {};
+    return input.source + '#' + std::to_string(std::get<0>(query.plan.nodes[node_idx].output_attrs[col]));
+}
+
+ExecuteResult execute_impl(QueryState& query, size_t node_idx); // Forward declaration
+
+// FORCE_THREADS=<n> overrides the thread counts of the cost model (for experiments); 0 = unset
+static size_t forced_threads() {
+    const char* force_threads_env = std::getenv("FORCE_THREADS");
+    if (force_threads_env && *force_threads_env) {
+        const int forced = std::atoi(force_threads_env);
+        if (forced > 0) return static_cast<size_t>(forced);
+    }
+    return 0;
+}
+
+// Number of threads for a join that probes probe_n rows at probe_ns each.
+// Parallelize only when it pays off: the cost model weighs the probe time against the
+// wake-up cost of the pool measured on this machine.
+static size_t join_threads(size_t probe_n, double probe_ns) {
+    if (const size_t forced = forced_threads()) return forced;
+    return CostModel::current().threads_for(probe_n, probe_ns, ThreadPool::current().num_threads());
+}
+
+// Independent subtrees (the build sides of a pipeline, a probe subtree and the table built
+// beside it) run as tasks of the shared pool. Telemetry counts per thread, so it keeps them
+// on the calling thread. CONCURRENT_SUBTREES=0 runs them one after another (for experiments).
+static bool concurrent_subtrees_enabled() {
+    static const bool disabled = [] {
+        const char *v = std::getenv("CONCURRENT_SUBTREES");
+        return v && *v == '0';
+    }();
+    return !disabled && !join_telemetry_enabled();
+}
+
+// Run fn(task) for every task in [0, tasks) as concurrent subtrees (ThreadPool::run
+// rethrows the first exception once no task runs any more)
+static void run_subtrees(size_t tasks, const std::function<void(size_t)> &fn) {
+    if (tasks < 2 || !concurrent_subtrees_enabled()) {
+        for (size_t t = 0; t < tasks; ++t) fn(t);
+        return;
+    }
+    ThreadPool::current().run(tasks, fn);
+}
+
+// Prepare total_out rows in every output column.
+// Output materialization is often a bottleneck: reserve exactly the memory needed
+// and write with direct indexing instead of append() on value_t. The pages themselves
+// are sized by allocate_page_range() in the thread that fills them (NUMA first touch).
+static void allocate_output_pages(ColumnBuffer &results, size_t total_out) {
+    for (auto &dst : results.columns) {
+        dst.pages.clear();
+        dst.page_offsets.clear();
+        dst.src_column = nullptr;
+        dst.is_zero_copy = false;
+        dst.cached_page_idx = 0;
+        dst.num_values = total_out;
+
+        const size_t page_sz = dst.values_per_page; // Page size (fixed)
+        dst.pages.resize((total_out + page_sz - 1) / page_sz);
+    }
+}
+
+// Size the pages of dst that hold output rows [out_begin, out_end) (page aligned)
+static void allocate_page_range(column_t &dst, size_t out_begin, size_t out_end) {
+    const size_t page_sz = dst.values_per_page;
+    for (size_t p = out_begin / page_sz; p * page_sz < out_end; ++p)
+        dst.pages[p].resize(std::min(page_sz, dst.num_values - p * page_sz));
+}
+
+// Call fn(out_begin, out_end) over output rows [0, total_out), in parallel when there is
+// enough to write (same reasoning as the probe, at the measured cost per output cell).
+// Each thread writes a disjoint range of output pages, so no two threads ever touch the
+// same ValuePage.
+template <typename Fn>
+static void for_each_output_range(size_t total_out, size_t num_output_cols, size_t out_page_sz, Fn &&fn) {
+    const size_t out_pages = (total_out + out_page_sz - 1) / out_page_sz;
+    const size_t forced = forced_threads();
+    const size_t mat_threads = forced ? std::min(forced, out_pages)
+        : CostModel::current().threads_for(total_out * num_output_cols, CostModel::current().cell_ns,
+                                           std::min(ThreadPool::current().num_threads(), out_pages));
+
+    if (mat_threads <= 1) {
+        fn(0, total_out);                             // Serial materialization
+        return;
+    }
+    ThreadPool::current().run(mat_threads, [&](size_t w) {
+        const size_t page_begin = out_pages * w / mat_threads;
+        const size_t page_end = out_pages * (w + 1) / mat_threads;
+        fn(page_begin * out_page_sz, std::min(total_out, page_end * out_page_sz));
+    });
+}
+
+// ROWID_INTERMEDIATES=0 writes value_t pages for every join output (for experiments)
+static bool rowid_intermediates_enabled() {
+    static const bool disabled = [] {
+        const char *v = std::getenv("ROWID_INTERMEDIATES");
+        return v && *v == '0';
+    }();
+    return !disabled;
+}
+
+// Input column of one output column, and the join input (side / pipeline source) it belongs to
+struct OutputSource {
+    column_t *col;
+    uint32_t input;
+};
+
+// Write the total_out rows of a join output into results.
+// fill_rows(input, out_begin, out_end, dst) stores, for every output row of [out_begin, out_end),
+// the row of `input` it was produced from at dst[0, out_end - out_begin).
+// When the rows of every input are already laid out per output row (input_rows[input], e.g.
+// written by the two-pass probe), row-id groups that need no composition adopt those vectors.
+//
+// Output columns are row-id views: every input column becomes (or already has) a shared base
+// column and every distinct (input, input row ids) pair gets one composed row-id vector. A join
+// thus writes 4 bytes per output row and base table instead of a value_t per output row and
+// column; values are read through the row ids only for join keys and at finalize.
+// Input columns are consumed (moved into the bases).
+template <typename FillRows>
+static void write_join_output(ColumnBuffer &results, const std::vector<OutputSource> &sources,
+                              size_t total_out, FillRows &&fill_rows,
+                              const std::shared_ptr<std::vector<uint32_t>> *input_rows = nullptr) {
+    results.num_rows = total_out;
+    const size_t out_page_sz = results.columns.empty() ? 1024 : results.columns[0].values_per_page;
+
+    if (!rowid_intermediates_enabled()) {
+        allocate_output_pages(results, total_out);    // Pages are filled by direct indexing
+        for_each_output_range(total_out, sources.size(), out_page_sz, [&](size_t out_begin, size_t out_end) {
+            std::vector<uint32_t> rows(out_end - out_begin);
+            for (size_t col = 0; col < sources.size(); ++col) {
+                fill_rows(sources[col].input, out_begin, out_end, rows.data());
+                const column_t &src = *sources[col].col;
+                allocate_page_range(results.columns[col], out_begin, out_end);
+                auto &dst_pages = results.columns[col].pages;
+                size_t page_cache = 0;                // get_cached(): no shared mutable state
+                for (size_t out_idx = out_begin; out_idx < out_end; ++out_idx)
+                    dst_pages[out_idx / out_page_sz][out_idx % out_page_sz] =
+                        src.get_cached(rows[out_idx - out_begin], page_cache);
+            }
+        });
+        return;
+    }
+
+    // One row-id vector per (input, row ids of the input column)
+    struct RowIdGroup {
+        uint32_t input;
+        const std::vector<uint32_t> *via;             // Input is a view: compose through its row ids
+        std::shared_ptr<std::vector<uint32_t>> ids;
+        bool filled;                                  // ids adopted from input_rows
+    };
+    std::vector<RowIdGroup> groups;
+    std::vector<size_t> group_of(sources.size());
+    size_t groups_to_fill = 0;
+    for (size_t col = 0; col < sources.size(); ++col) {
+        const uint32_t input = sources[col].input;
+        const auto *via = sources[col].col->row_ids.get();
+        size_t g = 0;
+        while (g < groups.size() && !(groups[g].input == input && groups[g].via == via)) ++g;
+        if (g == groups.size()) {
+            if (input_rows && !via) {
+                groups.push_back(RowIdGroup{input, via, input_rows[input], true});
+            } else {
+                auto ids = std::make_shared<std::vector<uint32_t>>();
+                interleaved_resize(*ids, total_out);  // Read by every node downstream
+                groups.push_back(RowIdGroup{input, via, std::move(ids), false});
+                ++groups_to_fill;
+            }
+        }
+        group_of[col] = g;
+    }
+
+    if (groups_to_fill > 0) {
+        for_each_output_range(total_out, groups_to_fill, out_page_sz, [&](size_t out_begin, size_t out_end) {
+            for (const auto &g : groups) {
+                if (g.filled) continue;
+                uint32_t *dst = g.ids->data() + out_begin;
+                fill_rows(g.input, out_begin, out_end, dst);
+                if (g.via)
+                    for (size_t i = 0; i < out_end - out_begin; ++i) dst[i] = (*g.via)[dst[i]];
+            }
+        });
+    }
+
+    // Base columns: views keep theirs, materialized/zero-copy inputs are shared once
+    std::vector<std::pair<const column_t *, std::shared_ptr<const column_t>>> shared;
+    for (size_t col = 0; col < sources.size(); ++col) {
+        column_t *src = sources[col].col;
+        std::shared_ptr<const column_t> base = src->ref_source;
+        if (!base) {
+            for (const auto &[moved, b] : shared)
+                if (moved == src) base = b;
+            if (!base) {
+                base = std::make_shared<const column_t>(std::move(*src));
+                shared.emplace_back(src, base);
+            }
+        }
+        column_t &dst = results.columns[col];
+        dst.pages.clear();
+        dst.num_values = total_out;
+        dst.ref_source = std::move(base);
+        dst.row_ids = groups[group_of[col]].ids;
+    }
+}
+
+// JoinAlgorithm (INT32 and VARCHAR keys)
 // Handles build, probe, and result materialization phases
 struct JoinAlgorithm {
     bool build_left;                                      // Which side builds the hash table
@@ -30,183 +264,724 @@ struct JoinAlgorithm {
     ExecuteResult& results;                               // Output buffer
     size_t left_col, right_col;                           // Join columns
     const std::vector<std::tuple<size_t, DataType>>& output_attrs;  // Output schema
+    HashTableCache* table_cache = nullptr;                // Cross-query hash tables (optional)
+    std::string left_cache_key, right_cache_key;          // table_cache_key() of the join columns
+    const Plan* plan = nullptr;                           // Resolves the string refs of VARCHAR keys
+    size_t memory_budget = 0;                             // Bytes a join may hold (0 = unlimited)
+    std::shared_ptr<const IHashTable<int32_t>> prebuilt_table; // Built while the probe side ran (optional)
+    bool prebuilt_left = false;                           // Side prebuilt_table was built over
+    size_t prebuilt_rows = 0;
 
-    // Execute join with INT32 keys
-    void run_int32() {
-        using Key = int32_t;
-        const ColumnBuffer* build_buf = build_left ? &left : &right;   // Select build side
-        const ColumnBuffer* probe_buf = build_left ? &right : &left;   // Select probe side
-        size_t build_key_col = build_left ? left_col : right_col;      // Build key column
-        size_t probe_key_col = build_left ? right_col : left_col;      // Probe key column
+    struct OutPair {
+        uint32_t lidx;
+        uint32_t ridx;
+    };
+
+    // Exact-size output of the two-pass probe: row of the left / right input per output row
+    struct JoinRows {
+        std::shared_ptr<std::vector<uint32_t>> left, right;
+    };
+
+    // Probe row whose key is a heavy hitter (index into HeavyHitters)
+    struct HeavyProbe {
+        uint32_t probe_row;
+        uint32_t key;
+    };
+
+    static constexpr size_t kProbeBatch = 1024;          // Keys per batched probe call
+
+    // Number of pages (chunks) of a key column
+    static size_t num_key_chunks(const column_t &col) {
+        if (col.is_zero_copy && col.src_column != nullptr && col.page_offsets.size() >= 2)
+            return col.page_offsets.size() - 1;
+        if (col.is_indirect()) return (col.num_values + col.values_per_page - 1) / col.values_per_page;
+        return col.pages.size();
+    }
+
+    // Call emit(key, row) for every non-NULL key of one page of a key column
+    template <typename Emit>
+    static void for_each_key_in_chunk(const column_t &col, size_t chunk, Emit &&emit) {
+        if (col.is_zero_copy && col.src_column != nullptr && col.page_offsets.size() >= 2) {
+            const size_t base = col.page_offsets[chunk];
+            const size_t n = col.page_offsets[chunk + 1] - base;
+            auto *data = reinterpret_cast<const int32_t *>(col.src_column->pages[chunk]->data + 4);
+            for (size_t i = 0; i < n; ++i) emit(data[i], static_cast<uint32_t>(base + i));
+            return;
+        }
+        if (col.is_indirect()) {
+            // Row-id view: gather the keys of rows [chunk * values_per_page, ...) from the base
+            const size_t base = chunk * col.values_per_page;
+            const size_t end = std::min(col.num_values, base + col.values_per_page);
+            size_t page_cache = 0;
+            for (size_t row = base; row < end; ++row) {
+                const value_t v = col.get_cached(row, page_cache);
+                if (!v.is_null()) emit(v.as_i32(), static_cast<uint32_t>(row));
+            }
+            return;
+        }
+        const auto &page = col.pages[chunk];
+        const size_t base = chunk * col.values_per_page;
+        for (size_t i = 0; i < page.size(); ++i)
+            if (!page[i].is_null()) emit(page[i].as_i32(), static_cast<uint32_t>(base + i));
+    }
 
-        auto table = create_hashtable<Key>();                          // Create hash table
+    // Statistics of the non-NULL keys of an INT32 key column (one parallel pass)
+    static BuildKeyStats build_key_stats(const column_t &col) {
+        return collect_build_key_stats(num_key_chunks(col), [&](size_t chunk, auto &&emit) {
+            for_each_key_in_chunk(col, chunk, emit);
+        });
+    }
 
-        const auto &build_col = build_buf->columns[build_key_col];     // Build column
+    // Build a table over one INT32 key column (NULL keys are skipped), of the kind that
+    // choose_join_table() picks from the column's statistics (join_table_choice.h);
+    // stats are collected here unless the caller already did.
+    // build_rows is set to the number of rows inserted; returns nullptr when it is 0.
+    static std::unique_ptr<IHashTable<int32_t>> build_int32_table(const ColumnBuffer &build_buf,
+                                                                  size_t build_key_col,
+                                                                  size_t &build_rows,
+                                                                  const BuildKeyStats *known_stats = nullptr) {
+        using Key = int32_t;
+        const auto &build_col = build_buf.columns[build_key_col];      // Build column
+        build_rows = 0;
+
+        const BuildKeyStats stats = known_stats ? *known_stats : build_key_stats(build_col);
+        if (stats.rows == 0) return nullptr;              // Nothing to build
+        JoinTable kind = choose_join_table(stats, 0);
 
         // BUILD: prefer zero-copy INT32 without NULLs
         const bool can_build_from_pages = build_col.is_zero_copy && build_col.src_column != nullptr &&
                                           build_col.page_offsets.size() >= 2;
+        std::vector<HashEntry<Key>> entries;              // Copy-based build (NULLs / non-zero-copy)
+        auto gather_entries = [&] {
+            entries.reserve(stats.rows);
+            for (size_t c = 0; c < num_key_chunks(build_col); ++c)
+                for_each_key_in_chunk(build_col, c, [&](Key key, uint32_t row) {
+                    entries.push_back(HashEntry<Key>{key, row});
+                });
+        };
+        if (!can_build_from_pages) gather_entries();
 
-        std::vector<HashEntry<Key>> entries;                           // Fallback entries list
-        size_t build_rows_effective = 0;                               // Effective number of build rows
-
-        if (can_build_from_pages) {
-            // Build directly from pages (no copy)
-            const bool built = table->build_from_zero_copy_int32(build_col.src_column,
-                                                                build_col.page_offsets,
-                                                                build_buf->num_rows);
-            if (!built) {
-                // If the implementation doesn't support it, fallback to copying
-                entries.reserve(build_buf->num_rows);
-                for (size_t i = 0; i < build_buf->num_rows; ++i) {
-                    const value_t &v = build_col.pages[i / build_col.values_per_page][i % build_col.values_per_page];
-                    if (!v.is_null()) entries.push_back(HashEntry<Key>{v.as_i32(), static_cast<uint32_t>(i)});
-                }
-                if (entries.empty()) return;              // Nothing to build
+        std::unique_ptr<IHashTable<Key>> table;
+        if (kind == JoinTable::LinearProbing) {
+            auto linear = std::make_unique<LinearProbingTable>(stats.rows);
+            const bool built = can_build_from_pages
+                ? linear->build_from_zero_copy_int32(build_col.src_column, build_col.page_offsets, stats.rows)
+                : linear->try_build_from_entries(entries);
+            if (built) table = std::move(linear);
+            else kind = JoinTable::Unchained;             // A key repeats after all
+        }
+        if (!table) {
+            table = kind == JoinTable::DenseArray
+                ? std::unique_ptr<IHashTable<Key>>(std::make_unique<DenseArrayTable>(stats.min_key, stats.max_key))
+                : create_hashtable<Key>();
+            if (!can_build_from_pages ||
+                !table->build_from_zero_copy_int32(build_col.src_column, build_col.page_offsets, stats.rows)) {
+                if (entries.empty()) gather_entries();    // Table without the fast path
                 table->reserve(entries.size());           // Pre-reserve
                 table->build_from_entries(entries);       // Regular build
-                build_rows_effective = entries.size();    // Number of build rows
-            } else {
-                build_rows_effective = build_buf->num_rows; // All rows were used
             }
-        } else {
-            // Copy-based implementation (supports NULLs / non-zero-copy)
-            entries.reserve(build_buf->num_rows);
-            for (size_t i = 0; i < build_buf->num_rows; ++i) {
-                const value_t &v = build_col.pages[i / build_col.values_per_page][i % build_col.values_per_page];
-                if (!v.is_null()) entries.push_back(HashEntry<Key>{v.as_i32(), static_cast<uint32_t>(i)});
+        }
+        if (Contest::join_telemetry_enabled()) Contest::qt_add_join_table(kind);
+        build_rows = stats.rows;                          // How many were inserted
+        return table;
+    }
+
+    // build_int32_table() through the cross-query cache (cache_key "" = not reusable)
+    static std::shared_ptr<const IHashTable<int32_t>> cached_int32_table(HashTableCache *cache,
+                                                                         const std::string &cache_key,
+                                                                         const ColumnBuffer &build_buf,
+                                                                         size_t build_key_col,
+                                                                         size_t &build_rows,
+                                                                         const BuildKeyStats *stats = nullptr) {
+        if (!cache || cache_key.empty()) return build_int32_table(build_buf, build_key_col, build_rows, stats);
+        if (const auto hit = cache->find(cache_key)) {
+            build_rows = hit->build_rows;
+            return hit->table;
+        }
+        const Arena::Scope heap(nullptr);                 // Outlives the query arena
+        std::shared_ptr<const IHashTable<int32_t>> table = build_int32_table(build_buf, build_key_col, build_rows, stats);
+        if (table) cache->insert(cache_key, table, build_rows);
+        return table;
+    }
+
+    // Keys of a VARCHAR column: the packed string ref of every row (NULL stays NULL) and
+    // the hash of the bytes behind it (Hash::bytes64, equal strings hash equally).
+    struct StringKeys {
+        std::vector<uint64_t> refs;
+        std::vector<uint64_t> hashes;
+    };
+
+    // Resolve and hash every page slot once. A row-id view that repeats base rows hashes its
+    // base column and gathers the hashes through the row ids.
+    static StringKeys hash_string_keys(const Plan &plan, const column_t &col) {
+        const StringRefResolver resolver(&plan);
+        auto hash_rows = [&](const column_t &src, StringKeys &out) {
+            out.refs.resize(src.num_values);
+            out.hashes.resize(src.num_values);
+            ThreadPool::current().for_each_morsel(src.num_values, 4096, [&](size_t begin, size_t end) {
+                size_t page_cache = 0;
+                for (size_t row = begin; row < end; ++row) {
+                    const value_t v = src.get_cached(row, page_cache);
+                    out.refs[row] = v.raw;
+                    out.hashes[row] = v.is_null() ? 0 : resolver.hash(v.as_ref());
+                }
+            });
+        };
+
+        StringKeys keys;
+        if (!col.is_indirect() || col.num_values <= col.ref_source->num_values) {
+            hash_rows(col, keys);
+            return keys;
+        }
+        StringKeys base;
+        hash_rows(*col.ref_source, base);
+        keys.refs.resize(col.num_values);
+        keys.hashes.resize(col.num_values);
+        const auto &ids = *col.row_ids;
+        ThreadPool::current().for_each_morsel(col.num_values, 4096, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; ++row) {
+                keys.refs[row] = base.refs[ids[row]];
+                keys.hashes[row] = base.hashes[ids[row]];
             }
+        });
+        return keys;
+    }
 
-            if (entries.empty()) return;                  // No entries
-            table->reserve(entries.size());               // Pre-reserve
-            table->build_from_entries(entries);           // Build
-            build_rows_effective = entries.size();        // How many were inserted
+    // Non-NULL keys of about n rows spread evenly over col (every col.num_values / n-th row)
+    static std::vector<int32_t> sample_keys(const column_t &col, size_t n) {
+        std::vector<int32_t> sample;
+        if (col.num_values == 0) return sample;
+        n = std::min(n, col.num_values);
+        sample.reserve(n);
+        size_t page_cache = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const value_t v = col.get_cached(i * col.num_values / n, page_cache);
+            if (!v.is_null()) sample.push_back(v.as_i32());
         }
+        return sample;
+    }
+
+    // Call on_batch(keys, n, row_of) for the non-NULL keys of probe rows [begin, end), at most
+    // kProbeBatch at a time; row_of(i) is the probe row of keys[i]. keys/rows are scratch space.
+    template <typename OnBatch>
+    static void for_each_probe_batch(const column_t &probe_col, size_t begin, size_t end,
+                                     std::vector<int32_t> &keys, std::vector<uint32_t> &rows,
+                                     OnBatch &&on_batch) {
+        if (probe_col.is_zero_copy && probe_col.src_column != nullptr && probe_col.page_offsets.size() >= 2) {
+            // Probe range is contiguous -> keep a page cursor
+            // to avoid binary searching page_offsets for each row.
+            const auto &offs = probe_col.page_offsets;
+            size_t page_idx = 0;
+            if (begin >= offs[1]) {
+                size_t left = 0, right = offs.size() - 1;
+                while (left < right - 1) {
+                    size_t mid = (left + right) / 2;
+                    if (begin < offs[mid]) right = mid;
+                    else left = mid;
+                }
+                page_idx = left;
+            }
+
+            // Keys of a page are contiguous: probe them straight from the page
+            for (size_t j = begin; j < end;) {
+                while (j >= offs[page_idx + 1]) ++page_idx;
+                const size_t base = offs[page_idx];
+                const size_t n = std::min({end, offs[page_idx + 1], j + kProbeBatch}) - j;
+                auto *data = reinterpret_cast<const int32_t *>(probe_col.src_column->pages[page_idx]->data + 4);
+                on_batch(data + (j - base), n, [j](uint32_t i) { return static_cast<uint32_t>(j + i); });
+                j += n;
+            }
+            return;
+        }
+
+        // Materialized / row-id probe path: gather non-NULL keys into batches
+        keys.clear();
+        rows.clear();
+        size_t page_cache = 0;
+        for (size_t j = begin; j < end; ++j) {
+            const value_t v = probe_col.get_cached(j, page_cache);
+            if (v.is_null()) continue;                       // Ignore NULL
+            keys.push_back(v.as_i32());
+            rows.push_back(static_cast<uint32_t>(j));
+            if (keys.size() == kProbeBatch) {
+                on_batch(keys.data(), keys.size(), [&](uint32_t i) { return rows[i]; });
+                keys.clear();
+                rows.clear();
+            }
+        }
+        if (!keys.empty()) on_batch(keys.data(), keys.size(), [&](uint32_t i) { return rows[i]; });
+    }
+
+    // Build one hash table over the whole build side (or reuse a cached one) and probe it
+    // in two passes over morsels of probe rows:
+    // 1. count the matches of every morsel (count_batch(), nothing is written)
+    // 2. prefix sums give every morsel its output offset; probe again and write the build
+    //    and probe rows of every match straight into out, which is allocated exactly once.
+    // Returns the number of build rows inserted (0 = empty build side).
+    // stats: statistics of the build keys if the caller collected them.
+    size_t hash_join_int32(const ColumnBuffer *build_buf, size_t build_key_col,
+                           const ColumnBuffer *probe_buf, size_t probe_key_col, JoinRows &out,
+                           const BuildKeyStats *stats = nullptr) {
+        size_t build_rows_effective = 0;                  // Effective number of build rows
+        std::shared_ptr<const IHashTable<int32_t>> table;
+        if (prebuilt_table && prebuilt_left == build_left) {
+            table = prebuilt_table;
+            build_rows_effective = prebuilt_rows;
+        } else {
+            table = cached_int32_table(table_cache, build_left ? left_cache_key : right_cache_key,
+                                       *build_buf, build_key_col, build_rows_effective, stats);
+        }
+        if (!table) return 0;                             // Empty build side
+
+        const column_t &probe_col = probe_buf->columns[probe_key_col];
+        const size_t probe_n = probe_buf->num_rows;       // Number of probe rows
+
+        // Threads and morsel size from the cost of one probe into the table actually built
+        const CostModel &model = CostModel::current();
+        const double probe_ns = model.probe_ns(
+            std::max(table->memory_usage(), build_rows_effective * sizeof(HashEntry<int32_t>)));
+        const size_t nthreads = join_threads(probe_n, probe_ns);
+        const size_t morsel = model.morsel_rows(probe_ns);
+        const size_t num_morsels = (probe_n + morsel - 1) / morsel;
+        std::vector<size_t> offsets(num_morsels + 1, 0);  // Morsel m writes [offsets[m], offsets[m+1])
+
+        // Build keys with thousands of duplicates: the matches of their probe rows are written
+        // by chunked tasks after the morsels instead of by the morsel that probes them (skew.h)
+        const HeavyHitters heavy = nthreads > 1 && skew_handling_enabled() && build_rows_effective >= kSkewMinMatches
+            ? HeavyHitters::detect(*table, sample_keys(build_buf->columns[build_key_col], kSkewSampleRows),
+                                   build_buf->num_rows)
+            : HeavyHitters{};
+        std::vector<std::vector<HeavyProbe>> heavy_by_morsel(heavy.empty() ? 0 : num_morsels);
+
+        // Per-thread scratch space of the probe passes
+        struct Scratch {
+            std::vector<int32_t> keys;                     // Gathered keys (materialized path)
+            std::vector<uint32_t> rows;                    // Their probe rows
+            std::vector<int32_t> light;                    // Keys of a batch without the heavy ones
+            std::vector<uint32_t> light_idx;               // Their index in the batch
+            std::vector<ProbeMatch> matches;               // Batched probe output
+        };
+
+        // Morsels are handed out dynamically (load balancing), both passes split them the same
+        // way over the NUMA nodes; pass(m, scratch) handles morsel m
+        auto for_each_morsel = [&](auto &&pass) {
+            NodeAwareCoordinator coordinator(num_morsels, 1, numa_num_nodes());
+            ThreadPool::current().run(nthreads, [&](size_t) {
+                Scratch scratch;
+                scratch.keys.reserve(kProbeBatch);
+                scratch.rows.reserve(kProbeBatch);
+                const size_t node = current_numa_node();
+                size_t m, m_end;
+                while (coordinator.steal_block(node, m, m_end)) pass(m, scratch);
+            });
+        };
+
+        // Keep the light keys of a batch in scratch.light, hand heavy ones to on_heavy(i, h)
+        auto split_batch = [&](const int32_t *batch_keys, size_t n, Scratch &scratch, auto &&on_heavy) {
+            scratch.light.clear();
+            scratch.light_idx.clear();
+            for (size_t i = 0; i < n; ++i) {
+                if (const int h = heavy.find(batch_keys[i]); h >= 0) {
+                    on_heavy(i, static_cast<uint32_t>(h));
+                    continue;
+                }
+                scratch.light.push_back(batch_keys[i]);
+                scratch.light_idx.push_back(static_cast<uint32_t>(i));
+            }
+        };
+
+        // PASS 1: count (heavy probe rows are only set aside)
+        for_each_morsel([&](size_t m, Scratch &scratch) {
+            size_t count = 0;
+            for_each_probe_batch(probe_col, m * morsel, std::min(probe_n, (m + 1) * morsel), scratch.keys, scratch.rows,
+                                 [&](const int32_t *batch_keys, size_t n, auto &&row_of) {
+                                     if (heavy.empty()) {
+                                         count += table->count_batch(batch_keys, n);
+                                         return;
+                                     }
+                                     split_batch(batch_keys, n, scratch, [&](size_t i, uint32_t h) {
+                                         heavy_by_morsel[m].push_back(HeavyProbe{row_of(i), h});
+                                     });
+                                     count += table->count_batch(scratch.light.data(), scratch.light.size());
+                                 });
+            offsets[m + 1] = count;
+        });
+        for (size_t m = 0; m < num_morsels; ++m) offsets[m + 1] += offsets[m];
+
+        // Heavy probe rows in morsel order: heavy_probes[i] writes from heavy_offsets[i] on
+        std::vector<HeavyProbe> heavy_probes;
+        std::vector<size_t> heavy_offsets{0};
+        for (auto &probes : heavy_by_morsel)
+            for (const HeavyProbe &hp : probes) {
+                heavy_probes.push_back(hp);
+                heavy_offsets.push_back(heavy_offsets.back() + heavy.rows(hp.key).size());
+            }
+        const size_t light_out = offsets[num_morsels];
+        const size_t heavy_out = heavy_offsets.back();
+        if (!heavy.empty() && Contest::join_telemetry_enabled())
+            Contest::qt_add_skew(heavy.size(), heavy_out);
+
+        const size_t total_out = light_out + heavy_out;
+        out.left = std::make_shared<std::vector<uint32_t>>();
+        out.right = std::make_shared<std::vector<uint32_t>>();
+        interleaved_resize(*out.left, total_out);         // Read by every node downstream
+        interleaved_resize(*out.right, total_out);
+        if (total_out == 0) return build_rows_effective;
+        uint32_t *build_rows = (build_left ? out.left : out.right)->data();
+        uint32_t *probe_rows = (build_left ? out.right : out.left)->data();
+
+        // PASS 2: write at the exact offsets
+        for_each_morsel([&](size_t m, Scratch &scratch) {
+            size_t pos = offsets[m];
+            for_each_probe_batch(probe_col, m * morsel, std::min(probe_n, (m + 1) * morsel), scratch.keys, scratch.rows,
+                                 [&](const int32_t *batch_keys, size_t n, auto &&row_of) {
+                                     scratch.matches.clear();
+                                     if (heavy.empty()) {
+                                         table->probe_batch(batch_keys, n, scratch.matches);
+                                         for (const ProbeMatch &match : scratch.matches) {
+                                             build_rows[pos] = match.build_row;
+                                             probe_rows[pos] = row_of(match.probe_idx);
+                                             ++pos;
+                                         }
+                                         return;
+                                     }
+                                     split_batch(batch_keys, n, scratch, [](size_t, uint32_t) {});
+                                     table->probe_batch(scratch.light.data(), scratch.light.size(), scratch.matches);
+                                     for (const ProbeMatch &match : scratch.matches) {
+                                         build_rows[pos] = match.build_row;
+                                         probe_rows[pos] = row_of(scratch.light_idx[match.probe_idx]);
+                                         ++pos;
+                                     }
+                                 });
+        });
+
+        // Heavy-hitter output after the morsels' output, in chunks of kSkewChunkRows that do
+        // not care which probe row they belong to
+        ThreadPool::current().for_each_morsel(heavy_out, kSkewChunkRows, [&](size_t begin, size_t end) {
+            size_t i = static_cast<size_t>(
+                std::upper_bound(heavy_offsets.begin(), heavy_offsets.end(), begin) - heavy_offsets.begin()) - 1;
+            for (size_t pos = begin; pos < end; ++i) {
+                const std::vector<uint32_t> &rows = heavy.rows(heavy_probes[i].key);
+                const size_t k_end = std::min(rows.size(), end - heavy_offsets[i]);
+                for (size_t k = pos - heavy_offsets[i]; k < k_end; ++k, ++pos) {
+                    build_rows[light_out + pos] = rows[k];
+                    probe_rows[light_out + pos] = heavy_probes[i].probe_row;
+                }
+            }
+        });
+
+        return build_rows_effective;
+    }
+
+    // Radix-partitioned join: partition both sides so that every partition's table fits
+    // in L2, then join partition pairs in parallel (one partition per thread at a time).
+    // Returns the number of build rows partitioned (0 = empty build side).
+    size_t radix_join_int32(const RadixPlan &radix,
+                            const ColumnBuffer &build_buf, size_t build_key_col,
+                            const ColumnBuffer &probe_buf, size_t probe_key_col,
+                            size_t nthreads, std::vector<std::vector<OutPair>> &out_by_thread) {
+        using Key = int32_t;
+        const column_t &build_col = build_buf.columns[build_key_col];
+        const column_t &probe_col = probe_buf.columns[probe_key_col];
+
+        auto build_parts = radix_partition<Key>(num_key_chunks(build_col),
+            [&](size_t chunk, auto &&emit) { for_each_key_in_chunk(build_col, chunk, emit); },
+            radix, nthreads);
+        if (build_parts.tuples.empty()) return 0;
+
+        auto probe_parts = radix_partition<Key>(num_key_chunks(probe_col),
+            [&](size_t chunk, auto &&emit) { for_each_key_in_chunk(probe_col, chunk, emit); },
+            radix, nthreads);
+
+        std::atomic<size_t> next_partition{0};
+        auto join_partitions = [&](size_t tid) {
+            auto &local = out_by_thread[tid];
+            FlatUnchainedHashTable<Key> table;             // Reused across partitions (L2 resident)
+
+            const size_t nparts = radix.num_partitions();
+            for (size_t p = next_partition.fetch_add(1); p < nparts; p = next_partition.fetch_add(1)) {
+                const size_t nb = build_parts.partition_size(p);
+                const size_t np = probe_parts.partition_size(p);
+                if (nb == 0 || np == 0) continue;
 
-        struct OutPair {
-            uint32_t lidx;
-            uint32_t ridx;
+                table.reserve(nb);
+                table.build_from_entries(build_parts.partition(p), nb);
+
+                const HashEntry<Key> *probe = probe_parts.partition(p);
+                for (size_t j = 0; j < np; ++j) {
+                    table.for_each_match(probe[j].key, [&](uint32_t row) {
+                        if (build_left)
+                            local.push_back(OutPair{row, probe[j].row_id});
+                        else
+                            local.push_back(OutPair{probe[j].row_id, row});
+                    });
+                }
+            }
         };
 
+        ThreadPool::current().run(nthreads, join_partitions);
+        return build_parts.tuples.size();
+    }
+
+    // Write the non-NULL keys of col to their grace partitions in file; returns the rows written.
+    // A failed write (e.g. a full spill disk) reaches the caller through ThreadPool::run.
+    static size_t spill_partitions(const column_t &col, SpillFile &file) {
+        const size_t num_parts = file.num_partitions();
+        std::atomic<size_t> written{0};
+        ThreadPool::current().for_each_morsel(num_key_chunks(col), 16, [&](size_t begin, size_t end) {
+            std::vector<std::vector<int32_t>> keys(num_parts);    // Staging page per partition
+            std::vector<std::vector<uint32_t>> rows(num_parts);
+            size_t n = 0;
+            for (size_t c = begin; c < end; ++c)
+                for_each_key_in_chunk(col, c, [&](int32_t key, uint32_t row) {
+                    const size_t part = grace_partition_of(key, num_parts);
+                    keys[part].push_back(key);
+                    rows[part].push_back(row);
+                    if (keys[part].size() == kSpillRowsPerPage) {
+                        file.append(part, keys[part].data(), rows[part].data(), kSpillRowsPerPage);
+                        keys[part].clear();
+                        rows[part].clear();
+                    }
+                    ++n;
+                });
+            for (size_t part = 0; part < num_parts; ++part)
+                if (!keys[part].empty()) file.append(part, keys[part].data(), rows[part].data(), keys[part].size());
+            written.fetch_add(n);
+        });
+        return written.load();
+    }
+
+    // Grace hash join for build sides beyond memory_budget: both sides go to temporary files
+    // by partition, then partition pairs are joined one after the other, so only one
+    // partition's table (about half of the budget) is in memory at a time. The matches of
+    // every partition are streamed to a third file as (left, right) row pairs and read back
+    // into out, allocated once at its exact size, after the last partition: the row-id output
+    // is the one part of the join that must fit in memory (8 bytes per output row, not
+    // charged against the budget). Returns the number of build rows (0 = empty build side).
+    size_t grace_join_int32(const ColumnBuffer &build_buf, size_t build_key_col,
+                            const ColumnBuffer &probe_buf, size_t probe_key_col,
+                            size_t num_parts, JoinRows &out) {
+        const Arena::Scope heap(nullptr);                 // Partition tables are freed one by one
+        SpillFile build_file(num_parts), probe_file(num_parts);
+        const size_t build_rows = spill_partitions(build_buf.columns[build_key_col], build_file);
+        if (build_rows == 0) return 0;
+        spill_partitions(probe_buf.columns[probe_key_col], probe_file);
+
+        SpillFile out_file(1);                            // Matches of all partitions, any order
+        const CostModel &model = CostModel::current();
+
+        for (size_t part = 0; part < num_parts; ++part) {
+            if (build_file.num_rows(part) == 0 || probe_file.num_rows(part) == 0) continue;
+
+            // BUILD: read the partition's pages back into one table
+            std::vector<HashEntry<int32_t>> entries(build_file.num_rows(part));
+            std::vector<size_t> page_base(build_file.num_pages(part) + 1, 0);
+            {
+                std::vector<int32_t> keys(kSpillRowsPerPage);
+                std::vector<uint32_t> rows(kSpillRowsPerPage);
+                for (size_t pg = 0; pg < build_file.num_pages(part); ++pg) {
+                    const size_t n = build_file.read_page(part, pg, keys.data(), rows.data());
+                    for (size_t i = 0; i < n; ++i) entries[page_base[pg] + i] = HashEntry<int32_t>{keys[i], rows[i]};
+                    page_base[pg + 1] = page_base[pg] + n;
+                }
+            }
+            FlatUnchainedHashTable<int32_t> table;
+            table.reserve(entries.size());
+            table.build_from_entries(entries, parallel_build_threads(entries.size(), table.directory_size()));
+            std::vector<HashEntry<int32_t>>().swap(entries);
+
+            // PROBE: page pairs of the probe partition; every thread stages one page of
+            // matches and appends it to out_file when full
+            const size_t probe_pages = probe_file.num_pages(part);
+            const double probe_ns = model.probe_ns(table.memory_usage());
+            const size_t nthreads = std::min(join_threads(probe_file.num_rows(part), probe_ns), probe_pages);
+            std::atomic<size_t> next_page{0};
+            ThreadPool::current().run(nthreads, [&](size_t) {
+                std::vector<int32_t> keys(kSpillRowsPerPage);
+                std::vector<uint32_t> rows(kSpillRowsPerPage);
+                std::vector<ProbeMatch> matches;
+                std::vector<uint32_t> out_left, out_right;
+                out_left.reserve(kSpillRowsPerPage);
+                out_right.reserve(kSpillRowsPerPage);
+                auto flush = [&] {
+                    out_file.append(0, reinterpret_cast<const int32_t *>(out_left.data()), out_right.data(),
+                                    out_left.size());
+                    out_left.clear();
+                    out_right.clear();
+                };
+                for (size_t pg = next_page.fetch_add(1); pg < probe_pages; pg = next_page.fetch_add(1)) {
+                    const size_t n = probe_file.read_page(part, pg, keys.data(), rows.data());
+                    matches.clear();
+                    table.probe_batch(keys.data(), n, matches);
+                    for (const ProbeMatch &m : matches) {
+                        out_left.push_back(build_left ? m.build_row : rows[m.probe_idx]);
+                        out_right.push_back(build_left ? rows[m.probe_idx] : m.build_row);
+                        if (out_left.size() == kSpillRowsPerPage) flush();
+                    }
+                }
+                if (!out_left.empty()) flush();
+            });
+        }
+
+        // OUTPUT: page pairs of out_file at their exact offsets
+        const size_t out_pages = out_file.num_pages(0);
+        std::vector<size_t> out_base(out_pages + 1, 0);
+        for (size_t pg = 0; pg < out_pages; ++pg) out_base[pg + 1] = out_base[pg] + out_file.page_rows(0, pg);
+        out.left = std::make_shared<std::vector<uint32_t>>(out_base[out_pages]);
+        out.right = std::make_shared<std::vector<uint32_t>>(out_base[out_pages]);
+        std::atomic<size_t> next_page{0};
+        const size_t nthreads = std::min(ThreadPool::current().num_threads(), out_pages);
+        ThreadPool::current().run(nthreads, [&](size_t) {
+            std::vector<int32_t> lefts(kSpillRowsPerPage);
+            std::vector<uint32_t> rights(kSpillRowsPerPage);
+            for (size_t pg = next_page.fetch_add(1); pg < out_pages; pg = next_page.fetch_add(1)) {
+                const size_t n = out_file.read_page(0, pg, lefts.data(), rights.data());
+                std::memcpy(out.left->data() + out_base[pg], lefts.data(), n * sizeof(uint32_t));
+                std::memcpy(out.right->data() + out_base[pg], rights.data(), n * sizeof(uint32_t));
+            }
+        });
+        return build_rows;
+    }
+
+    // Whether run_int32() joins a build side of build_rows through one hash table over it,
+    // however many rows the probe side turns out to have (no grace, no radix partitions)
+    static bool probes_whole_table(size_t build_rows, bool reusable, size_t memory_budget) {
+        if (reusable) return true;
+        if (choose_grace_partitions(build_rows, memory_budget)) return false;
+        return !choose_radix_plan(build_rows, std::numeric_limits<size_t>::max() / 2).enabled();
+    }
+
+    // Execute join with INT32 keys
+    void run_int32() {
+        const ColumnBuffer* build_buf = build_left ? &left : &right;   // Select build side
+        const ColumnBuffer* probe_buf = build_left ? &right : &left;   // Select probe side
+        size_t build_key_col = build_left ? left_col : right_col;      // Build key column
+        size_t probe_key_col = build_left ? right_col : left_col;      // Probe key column
+
         const size_t probe_n = probe_buf->num_rows;       // Number of probe rows
-        size_t hw = std::thread::hardware_concurrency();  // Available threads
-        if (!hw) hw = 4;                                   // Fallback
-
-        // Allow override for experiments
-        const char* force_threads_env = std::getenv("FORCE_THREADS");
-        size_t forced_threads = 0;
-        if (force_threads_env && *force_threads_env) {
-            forced_threads = static_cast<size_t>(std::atoi(force_threads_env));
+
+        // Large builds that do not fit in L2 are joined partition by partition, unless the
+        // table over the build column can be kept for later queries
+        const bool reusable = table_cache && !(build_left ? left_cache_key : right_cache_key).empty();
+
+        // Build sides beyond the memory budget are joined through temporary files
+        if (const size_t parts = reusable ? 0 : choose_grace_partitions(build_buf->num_rows, memory_budget)) {
+            JoinRows rows;
+            const size_t build_rows_effective =
+                grace_join_int32(*build_buf, build_key_col, *probe_buf, probe_key_col, parts, rows);
+            if (build_rows_effective == 0) return;        // Empty build side -> empty result
+            write_output(rows, build_rows_effective, probe_n);
+            return;
+        }
+
+        // The build keys' statistics pick the table (join_table_choice.h); a reusable table
+        // is looked up first and only built (and measured) on a cache miss
+        const bool measure = !reusable && !(prebuilt_table && prebuilt_left == build_left);
+        BuildKeyStats stats;
+        if (measure) {
+            stats = build_key_stats(build_buf->columns[build_key_col]);
+            if (stats.rows == 0) return;                  // Empty build side -> empty result
         }
+        if (measure && choose_join_table(stats, probe_n) == JoinTable::Partitioned) {
+            // Partitions fit in L2: every probe costs a cache-resident probe
+            const RadixPlan radix = choose_radix_plan(stats.rows, probe_n);
+            if (Contest::join_telemetry_enabled()) Contest::qt_add_join_table(JoinTable::Partitioned);
+            const size_t nthreads = join_threads(probe_n, CostModel::current().probe_cache_ns);
+            std::vector<std::vector<OutPair>> out_by_thread(nthreads); // Per-thread local results
+            const size_t build_rows_effective =
+                radix_join_int32(radix, *build_buf, build_key_col, *probe_buf, probe_key_col, nthreads, out_by_thread);
+            if (build_rows_effective == 0) return;        // Empty build side -> empty result
+            write_output(out_by_thread, build_rows_effective, probe_n);
+            return;
+        }
+
+        JoinRows rows;                                    // Exact-size output of the two-pass probe
+        const size_t build_rows_effective =
+            hash_join_int32(build_buf, build_key_col, probe_buf, probe_key_col, rows, measure ? &stats : nullptr);
+        if (build_rows_effective == 0) return;            // Empty build side -> empty result
+        write_output(rows, build_rows_effective, probe_n);
+    }
 
-        // Parallelize only when it pays off.
-        // For small inputs thread overhead may outweigh benefits.
-        const size_t nthreads = forced_threads > 0 ? forced_threads : 
-                    ((probe_n >= (1u << 18)) ? hw : 1); // Parallelize only when beneficial
+    // Execute join with VARCHAR keys.
+    // The table is keyed by the 64-bit string hashes; every hash match is confirmed by
+    // comparing the strings in place (StringRefResolver::equal, no allocation), using the
+    // refs kept next to the hashes.
+    void run_varchar() {
+        const ColumnBuffer* build_buf = build_left ? &left : &right;   // Select build side
+        const ColumnBuffer* probe_buf = build_left ? &right : &left;   // Select probe side
+        size_t build_key_col = build_left ? left_col : right_col;      // Build key column
+        size_t probe_key_col = build_left ? right_col : left_col;      // Probe key column
+
+        const StringKeys build_keys = hash_string_keys(*plan, build_buf->columns[build_key_col]);
+        std::vector<HashEntry<uint64_t>> entries;
+        entries.reserve(build_buf->num_rows);
+        for (size_t row = 0; row < build_keys.refs.size(); ++row)
+            if (!value_t{build_keys.refs[row]}.is_null())
+                entries.push_back(HashEntry<uint64_t>{build_keys.hashes[row], static_cast<uint32_t>(row)});
+        if (entries.empty()) return;                      // Empty build side -> empty result
+
+        FlatUnchainedHashTable<uint64_t> table;
+        table.reserve(entries.size());
+        table.build_from_entries(entries, parallel_build_threads(entries.size(), table.directory_size()));
+
+        const StringKeys probe_keys = hash_string_keys(*plan, probe_buf->columns[probe_key_col]);
+        const size_t probe_n = probe_buf->num_rows;       // Number of probe rows
+        const CostModel &model = CostModel::current();
+        const double probe_ns = model.probe_ns(table.memory_usage());
+        const size_t nthreads = join_threads(probe_n, probe_ns);
         std::vector<std::vector<OutPair>> out_by_thread(nthreads); // Per-thread local results
 
-        // PROBE PHASE: work stealing with atomic counter for dynamic load balancing
         WorkStealingConfig ws_config{                      // Work stealing settings
             .total_work = probe_n,
             .num_threads = nthreads,
-            .min_block_size = 256,
+            .min_block_size = model.morsel_rows(probe_ns),
             .blocks_per_thread = 16
         };
-        WorkStealingCoordinator ws_coordinator(ws_config); // Work stealing coordinator
+        NodeAwareCoordinator ws_coordinator(probe_n, ws_config.get_block_size(), numa_num_nodes());
+        const StringRefResolver resolver(plan);
 
-        auto probe_range_with_stealing = [&](size_t tid) { // Probe function with dynamic blocks
+        ThreadPool::current().run(nthreads, [&](size_t tid) {
             auto &local = out_by_thread[tid];
-            local.reserve(probe_n / nthreads + 256);       // Pre-reserve local output
+            std::vector<ProbeMatch> matches;               // Batched probe output
+            std::vector<uint64_t> hashes;                  // Hashes of the non-NULL probe keys
+            std::vector<uint32_t> rows;                    // Their probe rows
+            hashes.reserve(kProbeBatch);
+            rows.reserve(kProbeBatch);
 
-            size_t begin_j, end_j;
-            while (ws_coordinator.steal_block(begin_j, end_j)) { // Steal a work block
-
-                const auto &probe_col = probe_buf->columns[probe_key_col];
-
-                if (probe_col.is_zero_copy && probe_col.src_column != nullptr && probe_col.page_offsets.size() >= 2) {
-                    // Probe range is contiguous -> keep a per-thread page cursor
-                    // to avoid binary searching page_offsets for each row.
-                    const auto &offs = probe_col.page_offsets;
-                    size_t page_idx = 0;
-                    if (begin_j >= offs[1]) {
-                        size_t left = 0, right = offs.size() - 1;
-                        while (left < right - 1) {
-                            size_t mid = (left + right) / 2;
-                            if (begin_j < offs[mid]) right = mid;
-                            else left = mid;
-                        }
-                        page_idx = left;
-                    }
+            auto probe_hashes = [&]() {
+                matches.clear();
+                table.probe_batch(hashes.data(), hashes.size(), matches);
+                for (const ProbeMatch &m : matches) {
+                    const uint32_t probe_row = rows[m.probe_idx];
+                    if (!resolver.equal(build_keys.refs[m.build_row], probe_keys.refs[probe_row]))
+                        continue;                          // Hash collision
+                    if (build_left)
+                        local.push_back(OutPair{m.build_row, probe_row});
+                    else
+                        local.push_back(OutPair{probe_row, m.build_row});
+                }
+                hashes.clear();
+                rows.clear();
+            };
 
-                    size_t base = offs[page_idx];
-                    size_t next = offs[page_idx + 1];
-                    auto *page = probe_col.src_column->pages[page_idx]->data;
-                    auto *data = reinterpret_cast<const int32_t *>(page + 4);
-
-                    for (size_t j = begin_j; j < end_j; ++j) { // Scan the block
-                        while (j >= next) {
-                            ++page_idx;
-                            base = offs[page_idx];
-                            next = offs[page_idx + 1];
-                            page = probe_col.src_column->pages[page_idx]->data;
-                            data = reinterpret_cast<const int32_t *>(page + 4);
-                        }
-
-                        const int32_t probe_key = data[j - base];      // Read key
-
-                        size_t len = 0;
-                        const auto *bucket = table->probe(probe_key, len); // Lookup in hash
-                        if (!bucket || len == 0) continue;                // No match
-
-                        for (size_t k = 0; k < len; ++k) {               // Linear scan of bucket
-                            if (bucket[k].key != probe_key) continue;     // Confirm same key
-                            const uint32_t build_row = bucket[k].row_id;  // Build row
-                            if (build_left)
-                                local.push_back(OutPair{build_row, static_cast<uint32_t>(j)});
-                            else
-                                local.push_back(OutPair{static_cast<uint32_t>(j), build_row});
-                        }
-                    }
-                } else {
-                    // Materialized probe path
-                    for (size_t j = begin_j; j < end_j; ++j) {
-                        const value_t &v = probe_col.pages[j / probe_col.values_per_page][j % probe_col.values_per_page];
-                        if (v.is_null()) continue;                       // Ignore NULL
-                        const int32_t probe_key = v.as_i32();
-
-                        size_t len = 0;
-                        const auto *bucket = table->probe(probe_key, len); // Lookup
-                        if (!bucket || len == 0) continue;
-
-                        for (size_t k = 0; k < len; ++k) {
-                            if (bucket[k].key != probe_key) continue;     // Check same key
-                            const uint32_t build_row = bucket[k].row_id;
-                            if (build_left)
-                                local.push_back(OutPair{build_row, static_cast<uint32_t>(j)});
-                            else
-                                local.push_back(OutPair{static_cast<uint32_t>(j), build_row});
-                        }
-                    }
+            const size_t node = current_numa_node();
+            size_t begin_j, end_j;
+            while (ws_coordinator.steal_block(node, begin_j, end_j)) {
+                for (size_t j = begin_j; j < end_j; ++j) {
+                    if (value_t{probe_keys.refs[j]}.is_null()) continue;   // Ignore NULL
+                    hashes.push_back(probe_keys.hashes[j]);
+                    rows.push_back(static_cast<uint32_t>(j));
+                    if (hashes.size() == kProbeBatch) probe_hashes();
                 }
             }
-        };
+            if (!hashes.empty()) probe_hashes();
+        });
 
-        if (nthreads == 1) {
-            probe_range_with_stealing(0);                 // Serial probe
-        } else {
-            std::vector<std::thread> threads;
-            threads.reserve(nthreads);
-            for (size_t t = 0; t < nthreads; ++t) threads.emplace_back(probe_range_with_stealing, t);
-            for (auto &th : threads) th.join();           // Synchronize
-        }
-
-        size_t total_out = 0;                             // Total results
-        for (auto &v : out_by_thread) total_out += v.size();
-        if (total_out == 0) return;                       // No matches -> empty result
+        write_output(out_by_thread, entries.size(), probe_n);
+    }
 
-        // Allocate output columns once, then fill.
-        // Output materialization is often a bottleneck. Pre-reserve exactly the memory needed
-        // (total_out rows) and write with direct indexing instead of append() on value_t.
+    // Input column of every output column (records the join in the telemetry)
+    std::vector<OutputSource> output_sources(size_t build_rows_effective, size_t probe_n, size_t total_out) {
         const size_t num_output_cols = output_attrs.size(); // Number of output columns
 
         if (Contest::join_telemetry_enabled()) {          // Record telemetry if enabled
@@ -216,174 +991,701 @@ struct JoinAlgorithm {
                                  static_cast<uint64_t>(num_output_cols));
         }
 
-        struct OutputMap { bool from_left; uint32_t idx; }; // Source column (left/right) and index
-        std::vector<OutputMap> out_map;
-        out_map.reserve(num_output_cols);
-
-        for (size_t col = 0; col < num_output_cols; ++col) { // Prepare each output column
-            auto &dst = results.columns[col];
-            dst.pages.clear();
-            dst.page_offsets.clear();
-            dst.src_column = nullptr;
-            dst.is_zero_copy = false;
-            dst.cached_page_idx = 0;
-            dst.num_values = total_out;
-
-            const size_t page_sz = dst.values_per_page; // Page size (fixed)
-            size_t written = 0;
-            while (written < total_out) {               // Allocate pages to fit all
-                const size_t take = std::min(page_sz, total_out - written);
-                dst.pages.emplace_back(take);
-                written += take;
-            }
-
+        std::vector<OutputSource> sources;                // Input column of each output column
+        sources.reserve(num_output_cols);
+        for (size_t col = 0; col < num_output_cols; ++col) {
             const size_t left_cols = left.num_cols();   // Number of columns from left input
             const size_t src = std::get<0>(output_attrs[col]); // Source index
             if (src < left_cols)
-                out_map.push_back(OutputMap{true, static_cast<uint32_t>(src)});           // From left
+                sources.push_back(OutputSource{&left.columns[src], 0});              // From left
             else
-                out_map.push_back(OutputMap{false, static_cast<uint32_t>(src - left_cols)}); // From right
+                sources.push_back(OutputSource{&right.columns[src - left_cols], 1}); // From right
         }
+        return sources;
+    }
 
-        // All columns use the same page size (ColumnBuffer constructs them with 1024).
-        const size_t out_page_sz = results.columns.empty() ? 1024 : results.columns[0].values_per_page; // Output page size
-        const bool parallel_materialize = false; // Single-threaded output materialization (work required)
+    // Write the rows of the two-pass probe into results; they already are the row ids of
+    // the output, so row-id columns over materialized inputs take them as they are.
+    void write_output(const JoinRows &rows, size_t build_rows_effective, size_t probe_n) {
+        const size_t total_out = rows.left->size();
+        if (total_out == 0) return;                       // No matches -> empty result
 
-        if (!parallel_materialize) {
-            size_t out_idx = 0;                           // Current output index
-            for (size_t t = 0; t < nthreads; ++t) {
-                for (const auto &op : out_by_thread[t]) {
-                    const size_t lidx = op.lidx;
-                    const size_t ridx = op.ridx;
+        const std::vector<OutputSource> sources = output_sources(build_rows_effective, probe_n, total_out);
+        const std::shared_ptr<std::vector<uint32_t>> input_rows[2] = {rows.left, rows.right};
+        auto fill_rows = [&](uint32_t input, size_t out_begin, size_t out_end, uint32_t *dst) {
+            std::copy(input_rows[input]->begin() + out_begin, input_rows[input]->begin() + out_end, dst);
+        };
+        write_join_output(results, sources, total_out, fill_rows, input_rows);
+    }
 
-                    const size_t page_idx = out_idx / out_page_sz; // Page
-                    const size_t off = out_idx % out_page_sz;      // Offset within page
+    // Write the matched pairs of all threads into results (output schema from output_attrs)
+    void write_output(const std::vector<std::vector<OutPair>> &out_by_thread, size_t build_rows_effective,
+                      size_t probe_n) {
+        size_t total_out = 0;                             // Total results
+        for (auto &v : out_by_thread) total_out += v.size();
+        if (total_out == 0) return;                       // No matches -> empty result
 
-                    for (size_t col = 0; col < num_output_cols; ++col) {
-                        const auto m = out_map[col];
-                        if (m.from_left)
-                            results.columns[col].pages[page_idx][off] = left.columns[m.idx].get(lidx);
-                        else
-                            results.columns[col].pages[page_idx][off] = right.columns[m.idx].get(ridx);
-                    }
-                    ++out_idx; // Next output row
+        const std::vector<OutputSource> sources = output_sources(build_rows_effective, probe_n, total_out);
+
+        // Prefix sums over the per-thread outputs: thread t owns output rows [base[t], base[t+1])
+        std::vector<size_t> base(out_by_thread.size() + 1, 0);
+        for (size_t t = 0; t < out_by_thread.size(); ++t) base[t + 1] = base[t] + out_by_thread[t].size();
+
+        // Rows of input 0 (left) / 1 (right) behind output rows [out_begin, out_end)
+        auto fill_rows = [&](uint32_t input, size_t out_begin, size_t out_end, uint32_t *dst) {
+            size_t t = static_cast<size_t>(
+                std::upper_bound(base.begin(), base.end(), out_begin) - base.begin()) - 1;
+            size_t k = out_begin - base[t];                   // Cursor over out_by_thread
+            for (size_t out_idx = out_begin; out_idx < out_end; ++out_idx, ++k) {
+                while (k >= out_by_thread[t].size()) { ++t; k = 0; } // Skip to next thread's pairs
+                const auto &op = out_by_thread[t][k];
+                dst[out_idx - out_begin] = input == 0 ? op.lidx : op.ridx;
+            }
+        };
+
+        write_join_output(results, sources, total_out, fill_rows);
+    }
+};
+
+
+// Sideways information passing (runtime join filters).
+//
+// Build a runtime filter over the build keys and register it for the scan producing the
+// probe key (probe_node's output column probe_col). Skipped when the filter would not fit
+// in cache or the key is not INT32. RUNTIME_FILTER=0 disables it (for experiments).
+static bool runtime_filters_enabled() {
+    static const bool disabled = [] {
+        const char *v = std::getenv("RUNTIME_FILTER");
+        return v && *v == '0';
+    }();
+    return !disabled;
+}
+
+static void push_runtime_filter(QueryState &query, const ColumnBuffer &build, size_t build_key_col,
+                                size_t probe_node, size_t probe_col) {
+    if (!runtime_filters_enabled() || build.num_rows > kRuntimeFilterMaxKeys) return;
+    if (build.types[build_key_col] != DataType::INT32) return;
+
+    auto filter = std::make_shared<RuntimeFilter>(build.num_rows);
+    const column_t &key_col = build.columns[build_key_col];
+    for (size_t c = 0; c < JoinAlgorithm::num_key_chunks(key_col); ++c)
+        JoinAlgorithm::for_each_key_in_chunk(key_col, c, [&](int32_t key, uint32_t) { filter->insert(key); });
+
+    const auto [scan_idx, base_col] = trace_to_scan(query.plan, probe_node, probe_col);
+    query.scan_filters[scan_idx].push_back(ScanFilter{base_col, std::move(filter)});
+}
+
+// Adaptive build side.
+// Both inputs are materialized before the join, so their exact sizes are known and a badly
+// estimated plan (e.g. building 30M rows against a 10-row probe) can be corrected here.
+// Building a row costs more than probing one; a zero-copy key column builds straight from
+// the pages, without copying entries first.
+constexpr double kBuildCostZeroCopy = 2.0;   // Per build row, in probe-row units
+constexpr double kBuildCostCopy = 3.0;       // Entry copy + build
+constexpr double kFlipMinGain = 1.25;        // Keep the planner's side unless clearly worse
+
+static double join_cost(const column_t &build_key, size_t build_rows, size_t probe_rows) {
+    const bool zero_copy = build_key.is_zero_copy && build_key.src_column != nullptr;
+    return build_rows * (zero_copy ? kBuildCostZeroCopy : kBuildCostCopy) + static_cast<double>(probe_rows);
+}
+
+// ADAPTIVE_BUILD=0 keeps the planner's choice (for experiments)
+static bool adaptive_build_enabled() {
+    static const bool disabled = [] {
+        const char *v = std::getenv("ADAPTIVE_BUILD");
+        return v && *v == '0';
+    }();
+    return !disabled;
+}
+
+static bool choose_build_left(const ColumnBuffer &left, size_t left_col,
+                              const ColumnBuffer &right, size_t right_col, bool planned_left) {
+    if (!adaptive_build_enabled()) return planned_left;
+
+    const double cost_left = join_cost(left.columns[left_col], left.num_rows, right.num_rows);
+    const double cost_right = join_cost(right.columns[right_col], right.num_rows, left.num_rows);
+    if (planned_left) return !(cost_left > cost_right * kFlipMinGain);
+    return cost_left * kFlipMinGain < cost_right;
+}
+
+// JoinPipeline: pipelined execution of a left-deep chain of joins.
+//
+// Starting at a join, follow the probe side down until a scan is reached (the driving scan;
+// a join on VARCHAR keys also ends the chain and drives it in the scan's place).
+// All hash tables along that chain are built first (their build sides are executed normally,
+// as concurrent subtrees), then morsels of the driving scan flow through the chain of probes. A tuple in flight is
+// only a row id per source (driving scan + one build side per stage), so intermediate joins
+// never write output columns; only the chain's top join writes its (row-id) output columns.
+struct JoinPipeline {
+    // Location of a column: source 0 is the driving scan, source s >= 1 the build side of stage s
+    struct ColumnRef {
+        uint32_t source;
+        uint32_t col;
+    };
+
+    // One join of the chain (stage 1 is the join directly above the driving scan)
+    struct Stage {
+        size_t node_idx = 0;                          // Plan node of the join
+        const JoinNode *join = nullptr;
+        ColumnBuffer build;                           // Executed build side
+        std::shared_ptr<const IHashTable<int32_t>> table; // Hash table over the build key
+        size_t build_rows = 0;                        // Rows inserted into the table
+        ColumnRef probe_key{0, 0};                    // Probe key in terms of the sources
+        size_t out_cols = 0;                          // Output width (telemetry)
+    };
+
+    // Row ids of a batch of tuples, one vector per source
+    struct RowIdBatch {
+        std::vector<std::vector<uint32_t>> rows;
+
+        explicit RowIdBatch(size_t num_sources) : rows(num_sources) {}
+        size_t size() const { return rows[0].size(); }
+        void clear() { for (auto &r : rows) r.clear(); }
+    };
+
+    static constexpr size_t kMorselRows = 1024;     // Driving rows per morsel (one value_t page)
+
+    QueryState &query;
+    const Plan &plan;
+    size_t root_idx;
+    std::vector<Stage> stages;                      // Bottom-up
+    size_t driving_idx = 0;                         // Plan node of the driving scan
+    ColumnBuffer driving;
+
+    JoinPipeline(QueryState &q, size_t root) : query(q), plan(q.plan), root_idx(root) {}
+
+    // Probe-side child of a join
+    static size_t probe_child(const JoinNode &join) { return join.build_left ? join.right : join.left; }
+
+    // Rows of the base table scanned by node_idx, 0 if it is not a scan
+    static size_t scan_input_rows(const Plan &plan, size_t node_idx) {
+        const auto *scan = std::get_if<ScanNode>(&plan.nodes[node_idx].data);
+        return scan ? plan.inputs[scan->base_table_id].num_rows : 0;
+    }
+
+    // Rows of node_idx as far as they are known before it runs: a scan's base table, and for
+    // a join those of its probe side (a key / foreign key join keeps them)
+    static size_t estimated_rows(const Plan &plan, size_t node_idx) {
+        if (const auto *join = std::get_if<JoinNode>(&plan.nodes[node_idx].data))
+            return estimated_rows(plan, probe_child(*join));
+        return scan_input_rows(plan, node_idx);
+    }
+
+    // Join at node_idx if it can be a stage (INT32 build key), nullptr otherwise.
+    // A chain ends at the first other node, which then drives the pipeline.
+    // Stage tables are all held in memory at once, so a join whose scanned build side is
+    // beyond the memory budget is no stage: execute_hash_join() runs it as a grace join.
+    // Nor is a join whose scanned build side clearly outnumbers its probe side: the stage
+    // would keep the planner's build side, execute_hash_join() flips it (choose_build_left).
+    // (A build side that is itself a join is only sized once it ran, and stays a stage.)
+    static const JoinNode *stage_join(const QueryState &query, size_t node_idx) {
+        const Plan &plan = query.plan;
+        const auto *join = std::get_if<JoinNode>(&plan.nodes[node_idx].data);
+        if (!join) return nullptr;
+        const size_t build_idx = join->build_left ? join->left : join->right;
+        const size_t build_key = join->build_left ? join->left_attr : join->right_attr;
+        if (std::get<1>(plan.nodes[build_idx].output_attrs[build_key]) != DataType::INT32) return nullptr;
+        const size_t build_rows = scan_input_rows(plan, build_idx);
+        if (build_rows && choose_grace_partitions(build_rows, query.join_memory_budget)) return nullptr;
+        if (build_rows && adaptive_build_enabled() &&
+            static_cast<double>(build_rows) > kFlipMinGain * static_cast<double>(estimated_rows(plan, probe_child(*join))))
+            return nullptr;
+        return join;
+    }
+
+    // Number of joins in the probe chain starting at node_idx
+    static size_t chain_length(const QueryState &query, size_t node_idx) {
+        size_t n = 0;
+        while (const auto *join = stage_join(query, node_idx)) {
+            ++n;
+            node_idx = probe_child(*join);
+        }
+        return n;
+    }
+
+    // Pipelining pays off once at least one intermediate result is skipped.
+    // PIPELINE_JOIN=0 disables it (for experiments).
+    static bool applies(const QueryState &query, size_t node_idx) {
+        static const bool disabled = [] {
+            const char *v = std::getenv("PIPELINE_JOIN");
+            return v && *v == '0';
+        }();
+        return !disabled && chain_length(query, node_idx) >= 2;
+    }
+
+    ExecuteResult run() {
+        const auto &output_attrs = plan.nodes[root_idx].output_attrs;
+        ExecuteResult results(output_attrs.size(), 0); // Prepare output buffer
+        results.types.reserve(output_attrs.size());
+        for (auto &t : output_attrs) results.types.push_back(std::get<1>(t));
+
+        // Collect the chain top-down, then flip it so that stage 1 sits on the driving scan
+        std::vector<size_t> joins;
+        size_t node_idx = root_idx;
+        while (const auto *join = stage_join(query, node_idx)) {
+            joins.push_back(node_idx);
+            node_idx = probe_child(*join);
+        }
+        driving_idx = node_idx;
+        std::reverse(joins.begin(), joins.end());
+
+        // BUILD PHASE: every table of the chain, before any probe. The build sides share no
+        // node, so they run side by side.
+        stages.resize(joins.size());
+        for (size_t s = 0; s < joins.size(); ++s) {
+            stages[s].node_idx = joins[s];
+            stages[s].join = &std::get<JoinNode>(plan.nodes[joins[s]].data);
+        }
+        std::atomic<bool> empty{false};
+        run_subtrees(stages.size(), [&](size_t s) {
+            Stage &st = stages[s];
+            const size_t build_idx = st.join->build_left ? st.join->left : st.join->right;
+            const size_t build_key = st.join->build_left ? st.join->left_attr : st.join->right_attr;
+
+            if (empty.load(std::memory_order_relaxed)) return;  // Result is empty, skip the remaining work
+            st.build = execute_impl(query, build_idx);
+            st.table = JoinAlgorithm::cached_int32_table(query.table_cache,
+                                                         table_cache_key(query, build_idx, st.build, build_key),
+                                                         st.build, build_key, st.build_rows);
+            if (!st.table) empty.store(true, std::memory_order_relaxed);  // Empty build side -> empty result
+        });
+        if (empty.load()) return results;
+
+        // Column mapping: output column i of the current node -> source column
+        std::vector<ColumnRef> cols;
+        for (size_t c = 0; c < plan.nodes[driving_idx].output_attrs.size(); ++c)
+            cols.push_back(ColumnRef{0, static_cast<uint32_t>(c)});
+
+        for (size_t s = 0; s < stages.size(); ++s) {
+            Stage &st = stages[s];
+            const JoinNode &join = *st.join;
+            const uint32_t source = static_cast<uint32_t>(s + 1);
+            st.probe_key = cols[join.build_left ? join.right_attr : join.left_attr];
+
+            const auto &node_attrs = plan.nodes[st.node_idx].output_attrs;
+            const size_t left_cols = plan.nodes[join.left].output_attrs.size();
+            std::vector<ColumnRef> next;
+            next.reserve(node_attrs.size());
+            for (auto &[idx, type] : node_attrs) {
+                const bool from_left = idx < left_cols;
+                const uint32_t side_col = static_cast<uint32_t>(from_left ? idx : idx - left_cols);
+                if (from_left == join.build_left)
+                    next.push_back(ColumnRef{source, side_col});     // Build side
+                else
+                    next.push_back(cols[side_col]);                  // Probe side
+            }
+            st.out_cols = next.size();
+            cols = std::move(next);
+        }
+
+        // Every table is built: stages probing with a driving scan column filter that scan
+        for (const Stage &st : stages) {
+            if (st.probe_key.source != 0) continue;
+            const size_t build_key = st.join->build_left ? st.join->left_attr : st.join->right_attr;
+            push_runtime_filter(query, st.build, build_key, driving_idx, st.probe_key.col);
+        }
+
+        driving = execute_impl(query, driving_idx);
+        // A driving row is probed into every stage (at most; later stages see fewer rows)
+        const CostModel &model = CostModel::current();
+        double row_ns = 0;
+        for (const Stage &st : stages)
+            row_ns += model.probe_ns(std::max(st.table->memory_usage(), st.build_rows * sizeof(HashEntry<int32_t>)));
+        const size_t nthreads = join_threads(driving.num_rows, row_ns);
+
+        // Heavy-hitter build keys of every stage (skew.h): a probe tuple that meets one is set
+        // aside, and its matches are later split into chunks that any thread continues through
+        // the remaining stages, instead of one thread expanding them all
+        std::vector<HeavyHitters> heavy(stages.size());
+        if (nthreads > 1 && skew_handling_enabled()) {
+            for (size_t s = 0; s < stages.size(); ++s) {
+                const Stage &st = stages[s];
+                if (st.build_rows < kSkewMinMatches) continue;
+                const size_t build_key = st.join->build_left ? st.join->left_attr : st.join->right_attr;
+                heavy[s] = HeavyHitters::detect(*st.table,
+                                                JoinAlgorithm::sample_keys(st.build.columns[build_key], kSkewSampleRows),
+                                                st.build_rows);
+            }
+        }
+
+        // PROBE PHASE: morsels of the driving scan through all stages
+        std::vector<Sink> sinks(nthreads, Sink(stages.size()));
+
+        WorkStealingConfig ws_config{                 // Work stealing settings
+            .total_work = driving.num_rows,
+            .num_threads = nthreads,
+            .min_block_size = std::max(kMorselRows, model.morsel_rows(row_ns)),
+            .blocks_per_thread = 16
+        };
+        NodeAwareCoordinator ws_coordinator(driving.num_rows, ws_config.get_block_size(), numa_num_nodes());
+
+        ThreadPool::current().run(nthreads, [&](size_t tid) {
+            Sink &sink = sinks[tid];
+            Scratch scratch(stages.size());
+            RowIdBatch cur(stages.size() + 1), next(stages.size() + 1);
+
+            const size_t node = current_numa_node();
+            size_t begin_j, end_j;
+            while (ws_coordinator.steal_block(node, begin_j, end_j)) {
+                for (size_t m = begin_j; m < end_j; m += kMorselRows) {
+                    cur.clear();
+                    for (size_t j = m; j < std::min(end_j, m + kMorselRows); ++j)
+                        cur.rows[0].push_back(static_cast<uint32_t>(j));
+                    advance(cur, next, 0, heavy.data(), sink, scratch);
                 }
             }
-        } else {
-            std::vector<size_t> base(nthreads + 1, 0);          // Prefix sums for per-thread offsets
-            for (size_t t = 0; t < nthreads; ++t) base[t + 1] = base[t] + out_by_thread[t].size();
-
-            std::vector<std::thread> threads;
-            threads.reserve(nthreads);
-            for (size_t t = 0; t < nthreads; ++t) {
-                threads.emplace_back([&, t]() {
-                    const size_t start = base[t];
-                    size_t out_idx = start;
-                    std::vector<size_t> caches(num_output_cols, 0); // Page caches for get_cached
-
-                    for (const auto &op : out_by_thread[t]) {
-                        const size_t lidx = op.lidx;
-                        const size_t ridx = op.ridx;
-
-                        const size_t page_idx = out_idx / out_page_sz;
-                        const size_t off = out_idx % out_page_sz;
-
-                        for (size_t col = 0; col < num_output_cols; ++col) {
-                            const auto m = out_map[col];
-                            if (m.from_left)
-                                results.columns[col].pages[page_idx][off] = left.columns[m.idx].get_cached(lidx, caches[col]);
-                            else
-                                results.columns[col].pages[page_idx][off] = right.columns[m.idx].get_cached(ridx, caches[col]);
-                        }
-                        ++out_idx;
+        });
+
+        // HEAVY HITTERS: the set-aside tuples in chunks of kSkewChunkRows matches. Tuple i
+        // expands to matches [heavy_offsets[i], heavy_offsets[i + 1]).
+        std::vector<HeavyTuple> heavy_tuples;
+        std::vector<uint32_t> heavy_rows;
+        for (const Sink &sink : sinks) {
+            for (HeavyTuple t : sink.heavy) {
+                t.rows += heavy_rows.size();
+                heavy_tuples.push_back(t);
+            }
+            heavy_rows.insert(heavy_rows.end(), sink.heavy_rows.begin(), sink.heavy_rows.end());
+        }
+        std::vector<size_t> heavy_offsets{0};
+        std::vector<size_t> heavy_out(stages.size(), 0);
+        for (const HeavyTuple &t : heavy_tuples) {
+            const size_t n = heavy[t.stage].rows(t.h).size();
+            heavy_offsets.push_back(heavy_offsets.back() + n);
+            heavy_out[t.stage] += n;
+        }
+        const size_t num_chunks = (heavy_offsets.back() + kSkewChunkRows - 1) / kSkewChunkRows;
+        std::vector<Sink> chunk_sinks(num_chunks, Sink(stages.size()));
+
+        ThreadPool::current().run(num_chunks, [&](size_t c) {
+            Sink &sink = chunk_sinks[c];
+            Scratch scratch(stages.size());
+            RowIdBatch cur(stages.size() + 1), next(stages.size() + 1);
+            size_t stage = 0;                         // Stage whose matches cur holds
+            auto flush = [&] {
+                if (cur.size()) advance(cur, next, stage + 1, nullptr, sink, scratch);
+                cur.clear();
+            };
+
+            const size_t end = std::min(heavy_offsets.back(), (c + 1) * kSkewChunkRows);
+            size_t pos = c * kSkewChunkRows;
+            size_t i = static_cast<size_t>(
+                std::upper_bound(heavy_offsets.begin(), heavy_offsets.end(), pos) - heavy_offsets.begin()) - 1;
+            for (; pos < end; ++i) {
+                const HeavyTuple &t = heavy_tuples[i];
+                const std::vector<uint32_t> &rows = heavy[t.stage].rows(t.h);
+                if (t.stage != stage) {
+                    flush();
+                    stage = t.stage;
+                }
+                const size_t k_end = std::min(rows.size(), end - heavy_offsets[i]);
+                for (size_t k = pos - heavy_offsets[i]; k < k_end; ++k, ++pos) {
+                    for (size_t src = 0; src <= t.stage; ++src) cur.rows[src].push_back(heavy_rows[t.rows + src]);
+                    cur.rows[t.stage + 1].push_back(rows[k]);
+                    ++sink.matches[t.stage];
+                    if (cur.size() == kMorselRows) flush();
+                }
+            }
+            flush();
+        });
+        for (Sink &sink : chunk_sinks) sinks.push_back(std::move(sink));
+
+        size_t total_out = 0;                         // Total results
+        for (const Sink &sink : sinks) total_out += sink.out.size();
+
+        if (Contest::join_telemetry_enabled()) {      // Only the top stage writes output columns
+            for (size_t s = 0; s < stages.size(); ++s) {
+                size_t probes = 0, matches = 0;
+                for (const Sink &sink : sinks) {
+                    probes += sink.probes[s];
+                    matches += sink.matches[s];
+                }
+                Contest::qt_add_join(static_cast<uint64_t>(stages[s].build_rows),
+                                     static_cast<uint64_t>(probes),
+                                     static_cast<uint64_t>(matches),
+                                     static_cast<uint64_t>(s + 1 == stages.size() ? stages[s].out_cols : 0));
+                if (!heavy[s].empty()) Contest::qt_add_skew(heavy[s].size(), heavy_out[s]);
+            }
+        }
+        if (total_out == 0) return results;           // No matches -> empty result
+
+        // MATERIALIZATION: final output columns only
+        std::vector<OutputSource> sources;
+        sources.reserve(cols.size());
+        for (const ColumnRef &ref : cols) sources.push_back(OutputSource{&column(ref), ref.source});
+
+        std::vector<size_t> base(sinks.size() + 1, 0);  // Sink t owns output rows [base[t], base[t+1])
+        for (size_t t = 0; t < sinks.size(); ++t) base[t + 1] = base[t] + sinks[t].out.size();
+
+        auto fill_rows = [&](uint32_t source, size_t out_begin, size_t out_end, uint32_t *dst) {
+            size_t t = static_cast<size_t>(
+                std::upper_bound(base.begin(), base.end(), out_begin) - base.begin()) - 1;
+            size_t k = out_begin - base[t];           // Cursor over sinks
+            for (size_t out_idx = out_begin; out_idx < out_end; ++out_idx, ++k) {
+                while (k >= sinks[t].out.size()) { ++t; k = 0; } // Skip to next sink's tuples
+                dst[out_idx - out_begin] = sinks[t].out.rows[source][k];
+            }
+        };
+
+        write_join_output(results, sources, total_out, fill_rows);
+        return results;
+    }
+
+private:
+    // Probe tuple set aside at a stage where its key is a heavy hitter
+    struct HeavyTuple {
+        uint32_t stage;                               // Stage index
+        uint32_t h;                                   // Heavy key of the stage (HeavyHitters index)
+        size_t rows;                                  // Its row ids of sources 0..stage in heavy_rows
+    };
+
+    // Output and counters of one probe thread or heavy-hitter chunk
+    struct Sink {
+        RowIdBatch out;
+        std::vector<size_t> probes, matches;          // Per stage
+        std::vector<HeavyTuple> heavy;                // Set-aside tuples
+        std::vector<uint32_t> heavy_rows;
+
+        explicit Sink(size_t num_stages) : out(num_stages + 1), probes(num_stages, 0), matches(num_stages, 0) {}
+    };
+
+    // Per-thread buffers of advance()
+    struct Scratch {
+        std::vector<size_t> page_cache;               // Per stage
+        std::vector<int32_t> keys;                    // Probe keys of one stage
+        std::vector<uint32_t> tuples;                 // Their tuple index in cur
+        std::vector<ProbeMatch> matches;
+
+        explicit Scratch(size_t num_stages) : page_cache(num_stages, 0) {}
+    };
+
+    // Probe the tuples of cur (row ids of sources 0..first) through stages first.. and append
+    // the survivors to sink.out. With heavy (one HeavyHitters per stage), tuples whose key is
+    // heavy at a stage are moved to sink.heavy instead of being expanded. cur and next are
+    // scratch batches.
+    void advance(RowIdBatch &cur, RowIdBatch &next, size_t first, const HeavyHitters *heavy, Sink &sink,
+                 Scratch &scratch) const {
+        for (size_t s = first; s < stages.size() && cur.size(); ++s) {
+            const Stage &st = stages[s];
+            const column_t &key_col = column(st.probe_key);
+            const auto &in_rows = cur.rows[st.probe_key.source];
+            const HeavyHitters *stage_heavy = heavy && !heavy[s].empty() ? &heavy[s] : nullptr;
+            next.clear();
+            sink.probes[s] += cur.size();
+
+            // Gather the non-NULL keys of the batch, then probe them together
+            scratch.keys.clear();
+            scratch.tuples.clear();
+            for (size_t i = 0; i < cur.size(); ++i) {
+                const value_t v = key_col.get_cached(in_rows[i], scratch.page_cache[s]);
+                if (v.is_null()) continue;                       // Ignore NULL
+                const int32_t key = v.as_i32();
+                if (stage_heavy) {
+                    if (const int h = stage_heavy->find(key); h >= 0) {
+                        sink.heavy.push_back(HeavyTuple{static_cast<uint32_t>(s), static_cast<uint32_t>(h),
+                                                        sink.heavy_rows.size()});
+                        for (size_t src = 0; src <= s; ++src) sink.heavy_rows.push_back(cur.rows[src][i]);
+                        continue;
                     }
-                });
+                }
+                scratch.keys.push_back(key);
+                scratch.tuples.push_back(static_cast<uint32_t>(i));
+            }
+            scratch.matches.clear();
+            st.table->probe_batch(scratch.keys.data(), scratch.keys.size(), scratch.matches);
+
+            for (const ProbeMatch &m : scratch.matches) {
+                const uint32_t i = scratch.tuples[m.probe_idx];
+                for (size_t src = 0; src <= s; ++src) next.rows[src].push_back(cur.rows[src][i]);
+                next.rows[s + 1].push_back(m.build_row);
             }
-            for (auto &th : threads) th.join();
+            sink.matches[s] += next.size();
+            std::swap(cur, next);
         }
 
-        results.num_rows = total_out;
+        if (cur.size() == 0) return;
+        for (size_t src = 0; src < cur.rows.size(); ++src)
+            sink.out.rows[src].insert(sink.out.rows[src].end(), cur.rows[src].begin(), cur.rows[src].end());
+    }
+
+    const column_t &column(const ColumnRef &ref) const {
+        return ref.source == 0 ? driving.columns[ref.col] : stages[ref.source - 1].build.columns[ref.col];
+    }
+    column_t &column(const ColumnRef &ref) {
+        return ref.source == 0 ? driving.columns[ref.col] : stages[ref.source - 1].build.columns[ref.col];
     }
 };
 
+// Empty result with the node's schema
+static ExecuteResult empty_result(const std::vector<std::tuple<size_t, DataType>>& output_attrs) {
+    ColumnBuffer results(output_attrs.size(), 0);
+    results.types.reserve(output_attrs.size());
+    for (auto& t : output_attrs) results.types.push_back(std::get<1>(t));
+    return results;
+}
 
-ExecuteResult execute_hash_join(const Plan&                plan,
+ExecuteResult execute_hash_join(QueryState&           query,
     const JoinNode&                                    join,
     const std::vector<std::tuple<size_t, DataType>>& output_attrs)
 {
+    const Plan& plan = query.plan;
     size_t left_idx  = join.left;   // Index of left child
     size_t right_idx = join.right;  // Index of right child
 
     auto& left_node  = plan.nodes[left_idx];   // Plan node for left
     auto& right_node = plan.nodes[right_idx];  // Plan node for right
 
-    auto left  = execute_impl(plan, left_idx);  // Execute left subtree
-    auto right = execute_impl(plan, right_idx); // Execute right subtree
+    // Ensure the join key is INT32 or VARCHAR on the build side
+    const DataType key_type = join.build_left ? std::get<1>(left_node.output_attrs[join.left_attr])
+                                              : std::get<1>(right_node.output_attrs[join.right_attr]);
+    if (key_type != DataType::INT32 && key_type != DataType::VARCHAR)
+        throw std::runtime_error("Only INT32 and VARCHAR join columns supported.");
 
-    bool effective_build_left = join.build_left; // Build side as chosen by planner
+    const size_t build_idx = join.build_left ? left_idx : right_idx;
+    const size_t probe_idx = join.build_left ? right_idx : left_idx;
+    const size_t build_attr = join.build_left ? join.left_attr : join.right_attr;
+    const size_t probe_attr = join.build_left ? join.right_attr : join.left_attr;
+
+    ExecuteResult build, probe;
+    std::shared_ptr<const IHashTable<int32_t>> prebuilt;   // Planner's build side, built beside the probe
+    size_t prebuilt_rows = 0;
+    if (key_type == DataType::INT32 && runtime_filters_enabled()) {
+        // Execute the planner's build side first: its keys filter the probe subtree's scans.
+        // The probe subtree then runs while the table over the build side is built.
+        build = execute_impl(query, build_idx);
+        if (build.num_rows == 0) return empty_result(output_attrs); // Inner join: probe side is irrelevant
+        push_runtime_filter(query, build, build_attr, probe_idx, probe_attr);
+
+        const std::string build_key = table_cache_key(query, build_idx, build, build_attr);
+        const bool prebuild = concurrent_subtrees_enabled() &&
+            JoinAlgorithm::probes_whole_table(build.num_rows, !build_key.empty(), query.join_memory_budget);
+        run_subtrees(prebuild ? 2 : 1, [&](size_t task) {
+            if (task == 0) probe = execute_impl(query, probe_idx);
+            else prebuilt = JoinAlgorithm::cached_int32_table(query.table_cache, build_key,
+                                                              build, build_attr, prebuilt_rows);
+        });
+    } else {
+        // No filter flows between the children: they are independent subtrees
+        run_subtrees(2, [&](size_t task) {
+            if (task == 0) build = execute_impl(query, build_idx);
+            else probe = execute_impl(query, probe_idx);
+        });
+        if (build.num_rows == 0) return empty_result(output_attrs);
+    }
+
+    auto& left  = join.build_left ? build : probe;
+    auto& right = join.build_left ? probe : build;
+
+    // Build side as chosen by planner, flipped when the actual sizes disagree.
+    // JoinAlgorithm maps output_attrs by left/right, so the flip does not change the output.
+    bool effective_build_left = choose_build_left(left, join.left_attr, right, join.right_attr, join.build_left);
 
     // prepare output ColumnBuffer
-    ColumnBuffer results(output_attrs.size(), 0); // Prepare output buffer
-    results.types.reserve(output_attrs.size());
-    for (auto& t : output_attrs) results.types.push_back(std::get<1>(t));
+    ColumnBuffer results = empty_result(output_attrs);
 
     JoinAlgorithm ja {
-        .build_left   = effective_build_left,
-        .left         = left,
-        .right        = right,
-        .results      = results,
-        .left_col     = join.left_attr,
-        .right_col    = join.right_attr,
-        .output_attrs = output_attrs
+        .build_left      = effective_build_left,
+        .left            = left,
+        .right           = right,
+        .results         = results,
+        .left_col        = join.left_attr,
+        .right_col       = join.right_attr,
+        .output_attrs    = output_attrs,
+        .table_cache     = query.table_cache,
+        .left_cache_key  = table_cache_key(query, left_idx, left, join.left_attr),
+        .right_cache_key = table_cache_key(query, right_idx, right, join.right_attr),
+        .plan            = &plan,
+        .memory_budget   = query.join_memory_budget,
+        .prebuilt_table  = prebuilt,
+        .prebuilt_left   = join.build_left,
+        .prebuilt_rows   = prebuilt_rows
     };
 
-    // Ensure the join key is INT32 on the build side
-    if (effective_build_left) {
-        if (std::get<1>(left_node.output_attrs[join.left_attr]) != DataType::INT32)
-            throw std::runtime_error("Only INT32 join columns supported.");
-    } else {
-        if (std::get<1>(right_node.output_attrs[join.right_attr]) != DataType::INT32)
-            throw std::runtime_error("Only INT32 join columns supported.");
-    }
-
-    ja.run_int32(); // Execute hash join
+    if (key_type == DataType::VARCHAR)
+        ja.run_varchar(); // Join on the string bytes
+    else
+        ja.run_int32();   // Execute hash join
 
     return results;
 }
 
 
-ExecuteResult execute_scan(const Plan&                  plan,
+ExecuteResult execute_scan(QueryState&                   query,
+    size_t                                             node_idx,
     const ScanNode&                                    scan,
     const std::vector<std::tuple<size_t, DataType>>& output_attrs)
 {
-    return scan_columnar_to_columnbuffer(plan, scan, output_attrs); // Convert scan to ColumnBuffer
+    const auto& selection = query.scan_selection[node_idx];
+    return scan_columnar_to_columnbuffer(query.plan, scan, output_attrs, // Convert scan to ColumnBuffer
+                                         query.scan_filters[node_idx],
+                                         selection.empty() ? nullptr : &selection);
 }
 
 
-ExecuteResult execute_impl(const Plan& plan, size_t node_idx) {
+ExecuteResult execute_impl(QueryState& query, size_t node_idx) {
+    const Plan& plan = query.plan;
+    if (JoinPipeline::applies(query, node_idx))                  // Left-deep chain -> pipelined
+        return JoinPipeline(query, node_idx).run();
+
     auto& node = plan.nodes[node_idx];                           // Get the node
     return std::visit(                                           // Examine variant
         [&](auto const& value) -> ExecuteResult {
             using T = std::decay_t<decltype(value)>;
             if constexpr (std::is_same_v<T, JoinNode>)           // If it's a Join
-                return execute_hash_join(plan, value, node.output_attrs);
+                return execute_hash_join(query, value, node.output_attrs);
             else                                                 // Otherwise Scan
-                return execute_scan(plan, value, node.output_attrs);
+                return execute_scan(query, node_idx, value, node.output_attrs);
         },
         node.data);
 }
 
-ColumnarTable execute(const Plan& plan, void* context) {
-    (void)context;                                              // Unused
+// Execution context: state that outlives a single query
+struct ExecContext {
+    ThreadPool pool;                                            // Workers shared by all queries
+    HashTableCache table_cache;                                 // Join hash tables over base columns
+    CostModel cost_model;                                       // Thread/morsel decisions on this machine
+    size_t join_memory_budget = join_memory_budget_default();   // Per join, see spill.h
+};
+
+static ColumnarTable execute_query(const Plan& plan, ExecContext* ctx) {
     if (Contest::join_telemetry_enabled()) Contest::qt_begin_query(); // Begin telemetry
-    auto buf = execute_impl(plan, plan.root);                   // Execute plan root
+    QueryState query(plan);                                     // Per-query state
+    if (ctx && ctx->table_cache.budget() > 0) query.table_cache = &ctx->table_cache;
+    if (ctx) query.join_memory_budget = ctx->join_memory_budget;
+    if (semijoin_reduction_enabled())                           // Optional: drop dangling base rows first
+        query.scan_selection = semijoin_reduce(plan);
+    auto buf = execute_impl(query, plan.root);                  // Execute plan root
     if (Contest::join_telemetry_enabled()) Contest::qt_end_query();   // End telemetry
     return Contest::finalize_columnbuffer_to_columnar(          // Convert to ColumnarTable
         plan, buf, plan.nodes[plan.root].output_attrs
     );
 }
 
-void* build_context() { return nullptr; }
-void destroy_context(void*) {}
+ColumnarTable execute(const Plan& plan, void* context) {
+    // Intermediate pages and hash tables of this query come from one arena that is unmapped
+    // in bulk on return; the result (Column pages) is allocated on the heap as before.
+    Arena arena;
+    struct Uninstall {
+        ~Uninstall() { Arena::install(nullptr); }
+    } uninstall;
+    if (Arena::enabled()) Arena::install(&arena);
+    return execute_query(plan, static_cast<ExecContext*>(context));
+}
+
+void* build_context() {
+    auto* ctx = new ExecContext();
+    ThreadPool::install(&ctx->pool);                            // Scans/filters/joins use it from now on
+    ctx->cost_model = CostModel::process_default();             // Calibrated on the pool just installed
+    CostModel::install(&ctx->cost_model);
+    return ctx;
+}
+
+void destroy_context(void* context) {
+    auto* ctx = static_cast<ExecContext*>(context);
+    if (!ctx) return;
+    if (&ThreadPool::current() == &ctx->pool) ThreadPool::install(nullptr);
+    if (&CostModel::current() == &ctx->cost_model) CostModel::install(nullptr);
+    delete ctx;
+}
 
 } // namespace Contest
\ No newline at end of file
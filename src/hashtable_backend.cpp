@@ -0,0 +1,41 @@
+// hashtable_backend.cpp - process-wide hash table backend (HASH_TABLE)
+#include "hashtable_backend.h"
+#include <atomic>
+#include <cstdlib>
+
+namespace Contest {
+
+namespace {
+
+std::atomic<HashTableBackend>& current_backend() {
+    static std::atomic<HashTableBackend> backend{[] {
+        const char* v = std::getenv("HASH_TABLE");
+        return v ? parse_hashtable_backend(v).value_or(HashTableBackend::Unchained) : HashTableBackend::Unchained;
+    }()};
+    return backend;
+}
+
+} // namespace
+
+std::optional<HashTableBackend> parse_hashtable_backend(std::string_view name) {
+    for (HashTableBackend b : {HashTableBackend::Unchained, HashTableBackend::RobinHood, HashTableBackend::Cuckoo,
+                               HashTableBackend::Hopscotch})
+        if (name == hashtable_backend_name(b)) return b;
+    return std::nullopt;
+}
+
+const char* hashtable_backend_name(HashTableBackend backend) {
+    switch (backend) {
+    case HashTableBackend::Unchained: return "unchained";
+    case HashTableBackend::RobinHood: return "robinhood";
+    case HashTableBackend::Cuckoo: return "cuckoo";
+    case HashTableBackend::Hopscotch: return "hopscotch";
+    }
+    return "unchained";
+}
+
+HashTableBackend hashtable_backend() { return current_backend().load(std::memory_order_relaxed); }
+
+void set_hashtable_backend(HashTableBackend backend) { current_backend().store(backend, std::memory_order_relaxed); }
+
+} // namespace Contest
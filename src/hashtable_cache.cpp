@@ -0,0 +1,53 @@
+// hashtable_cache.cpp - LRU cache of join hash tables across queries
+#include "hashtable_cache.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace Contest {
+
+std::size_t HashTableCache::default_budget() {
+    const char* v = std::getenv("HT_CACHE_MB");
+    const std::size_t mb = (v && *v) ? static_cast<std::size_t>(std::atoll(v)) : kHashTableCacheDefaultMB;
+    return mb << 20;
+}
+
+std::shared_ptr<const HashTableCache::Entry> HashTableCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);           // Now most recently used
+    return it->second->second;
+}
+
+void HashTableCache::insert(const std::string& key, std::shared_ptr<const IHashTable<int32_t>> table,
+                            std::size_t build_rows) {
+    // Tables that cannot report their size are charged like a flat (key, row id) array
+    const std::size_t bytes = std::max(table->memory_usage(), build_rows * sizeof(HashEntry<int32_t>));
+    if (bytes > budget_) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {                            // Replace the old table
+        used_ -= it->second->second->bytes;
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+    evict_to(budget_ - bytes);
+    lru_.emplace_front(key, std::make_shared<const Entry>(Entry{std::move(table), build_rows, bytes}));
+    entries_.emplace(key, lru_.begin());
+    used_ += bytes;
+}
+
+void HashTableCache::evict_to(std::size_t bytes) {
+    while (used_ > bytes && !lru_.empty()) {
+        used_ -= lru_.back().second->bytes;
+        entries_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+} // namespace Contest
@@ -0,0 +1,59 @@
+// join_table_choice.cpp - build key statistics -> join table
+#include "join_table_choice.h"
+#include <cmath>
+#include <cstdlib>
+
+#include "dense_array_table.h"
+#include "hashtable_backend.h"
+#include "radix_partition.h"
+
+namespace Contest {
+
+const char* join_table_name(JoinTable table) {
+    switch (table) {
+    case JoinTable::DenseArray: return "array";
+    case JoinTable::Unchained: return "unchained";
+    case JoinTable::LinearProbing: return "linear";
+    case JoinTable::Partitioned: return "partitioned";
+    }
+    return "unchained";
+}
+
+bool join_table_choice_enabled() {
+    static const bool disabled = [] {
+        const char* v = std::getenv("JOIN_TABLE_CHOICE");
+        return v && *v == '0';
+    }();
+    return !disabled;
+}
+
+// Raw HyperLogLog estimate, linear counting while registers are still empty
+double DistinctSketch::estimate() const {
+    const double m = static_cast<double>(registers_.size());
+    double sum = 0;
+    std::size_t zeros = 0;
+    for (uint8_t reg : registers_) {
+        sum += std::ldexp(1.0, -reg);
+        zeros += reg == 0;
+    }
+    const double raw = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    if (raw <= 2.5 * m && zeros) return m * std::log(m / static_cast<double>(zeros));
+    return raw;
+}
+
+JoinTable choose_join_table(const BuildKeyStats& stats, std::size_t probe_rows) {
+    static const bool array_disabled = [] {
+        const char* v = std::getenv("ARRAY_JOIN");
+        return v && *v == '0';
+    }();
+
+    if (probe_rows && choose_radix_plan(stats.rows, probe_rows).enabled()) return JoinTable::Partitioned;
+    if (!array_disabled && dense_array_fits(stats.min_key, stats.max_key, stats.rows)) return JoinTable::DenseArray;
+    if (join_table_choice_enabled() && hashtable_backend() == HashTableBackend::Unchained &&
+        stats.rows >= kLinearProbeMinRows &&
+        static_cast<double>(stats.distinct) >= kLinearProbeMinDistinct * static_cast<double>(stats.rows))
+        return JoinTable::LinearProbing;
+    return JoinTable::Unchained;
+}
+
+} // namespace Contest
@@ -12,6 +12,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <chrono>
+#include "join_table_choice.h"
 
 namespace Contest {
 
@@ -64,6 +65,24 @@ void qt_add_join(uint64_t build_rows,
     g_qt.bytes_likely += bytes_keys + bytes_out_read + bytes_out_write;
 }
 
+void qt_add_scan_filter(uint64_t in_rows, uint64_t kept_rows) {
+    g_qt.filter_scans += 1;
+    g_qt.filter_in_rows += in_rows;
+    g_qt.filter_kept_rows += kept_rows;
+}
+
+void qt_add_skew(uint64_t heavy_keys, uint64_t heavy_out_rows) {
+    g_qt.skew_joins += 1;
+    g_qt.skew_keys += heavy_keys;
+    g_qt.skew_out_rows += heavy_out_rows;
+}
+
+static_assert(sizeof(QueryTelemetry::tables) / sizeof(uint64_t) == kNumJoinTables, "one counter per JoinTable");
+
+void qt_add_join_table(JoinTable table) {
+    g_qt.tables[static_cast<std::size_t>(table)] += 1;
+}
+
 void qt_end_query() {
     const auto now = std::chrono::steady_clock::now();
     const double elapsed_ms = std::chrono::duration<double, std::milli>(now - g_query_start).count();
@@ -102,6 +121,33 @@ void qt_end_query() {
                  selectivity,
                  avg_out_cols);
 
+    // Rows removed by runtime join filters before materialization
+    if (g_qt.filter_scans) {
+        std::fprintf(stderr,
+                     "[telemetry q%llu] runtime_filters scans=%llu in=%llu kept=%llu\n",
+                     (unsigned long long)g_query_id,
+                     (unsigned long long)g_qt.filter_scans,
+                     (unsigned long long)g_qt.filter_in_rows,
+                     (unsigned long long)g_qt.filter_kept_rows);
+    }
+
+    // Output of heavy-hitter keys split across threads (skew.h)
+    if (g_qt.skew_joins) {
+        std::fprintf(stderr,
+                     "[telemetry q%llu] skew joins=%llu heavy_keys=%llu heavy_out=%llu (%.1f%% of out)\n",
+                     (unsigned long long)g_query_id,
+                     (unsigned long long)g_qt.skew_joins,
+                     (unsigned long long)g_qt.skew_keys,
+                     (unsigned long long)g_qt.skew_out_rows,
+                     g_qt.out_rows ? 100.0 * static_cast<double>(g_qt.skew_out_rows) / static_cast<double>(g_qt.out_rows) : 0.0);
+    }
+
+    // Tables the joins were built with (join_table_choice.h)
+    std::fprintf(stderr, "[telemetry q%llu] tables", (unsigned long long)g_query_id);
+    for (std::size_t t = 0; t < kNumJoinTables; ++t)
+        std::fprintf(stderr, " %s=%llu", join_table_name(static_cast<JoinTable>(t)), (unsigned long long)g_qt.tables[t]);
+    std::fprintf(stderr, "\n");
+
     // Estimate data volume in GiB (baseline and likely scenarios)
     std::fprintf(stderr,
                  "[telemetry q%llu] bytes_baseline_min=%.3f GiB  bytes_likely=%.3f GiB\n",
@@ -1,6 +1,9 @@
 #include "late_materialization.h"
 #include "columnar.h"
 #include <hardware.h>
+#include "thread_pool.h"
+#include "join_telemetry.h"
+#include "hash_functions.h"
 #include <plan.h>
 #include <table.h>
 #include <iostream>
@@ -45,13 +48,95 @@ static bool column_has_nulls(const Column& column) {
     return false;
 }
 
+// ----------------------------------------------------------------------------
+// RUNTIME FILTERS
+// ----------------------------------------------------------------------------
+
+// Evaluate the runtime filters on their INT32 base columns, on top of keep.
+// keep[row] = 1 for rows passing all of them (NULL keys never pass); returns the count.
+static size_t evaluate_scan_filters(const ColumnarTable& input,
+                                    const std::vector<ScanFilter>& filters,
+                                    std::vector<uint8_t>& keep) {
+
+    for (const auto& f : filters) {
+        const auto& column = input.columns[f.column];
+        if (column.type != DataType::INT32) continue;   // Only INT32 join keys are filtered
+
+        // First row of every page, so pages can be filtered independently
+        std::vector<size_t> page_start(column.pages.size() + 1, 0);
+        for (size_t p = 0; p < column.pages.size(); ++p)
+            page_start[p + 1] = page_start[p] + *reinterpret_cast<const uint16_t*>(column.pages[p]->data);
+
+        const RuntimeFilter& filter = *f.filter;
+        ThreadPool::current().for_each_morsel(column.pages.size(), 16, [&](size_t page_begin, size_t page_end) {
+            for (size_t p = page_begin; p < page_end; ++p) {
+                auto* page = column.pages[p]->data;
+                uint16_t num_rows_in_page = *reinterpret_cast<const uint16_t*>(page);
+                auto* data_begin = reinterpret_cast<const int32_t*>(page + 4);
+                auto* bitmap = reinterpret_cast<const uint8_t*>(
+                    page + PAGE_SIZE - (num_rows_in_page + 7) / 8);
+                uint8_t* k = keep.data() + page_start[p];
+
+                uint16_t data_idx = 0; // Advance only on valid entries
+                for (uint16_t i = 0; i < num_rows_in_page; ++i) {
+                    if (get_bitmap_local_col(bitmap, i))
+                        k[i] &= filter.may_contain(data_begin[data_idx++]);
+                    else
+                        k[i] = 0;
+                }
+            }
+        });
+    }
+
+    size_t kept = 0;
+    for (uint8_t k : keep) kept += k;
+    return kept;
+}
+
+// Materialize only the rows with keep[row] set (same encoding as the full scan)
+static void materialize_selected_rows(const Column& column, uint8_t table_id, uint8_t in_col_idx,
+                                      const std::vector<uint8_t>& keep, column_t& out_col) {
+    size_t row = 0;                                     // Row of the base table
+    for (size_t page_idx = 0; page_idx < column.pages.size(); ++page_idx) {
+        auto* page = column.pages[page_idx]->data;
+        uint16_t num_rows_in_page = *reinterpret_cast<const uint16_t*>(page);
+
+        if (column.type == DataType::VARCHAR && num_rows_in_page == 0xffff) {
+            // First page of long string block: one row
+            if (keep[row++])
+                out_col.append(value_t::make_str_ref(table_id, in_col_idx, (uint32_t)page_idx, 0xffff));
+            continue;
+        }
+        if (column.type == DataType::VARCHAR && num_rows_in_page == 0xfffe) continue; // Continuation page
+
+        auto* bitmap = reinterpret_cast<const uint8_t*>(page + PAGE_SIZE - (num_rows_in_page + 7) / 8);
+        auto* data_begin = reinterpret_cast<const int32_t*>(page + 4);
+
+        uint16_t data_idx = 0; // Advance only on valid entries
+        for (uint16_t i = 0; i < num_rows_in_page; ++i, ++row) {
+            const bool valid = get_bitmap_local_col(bitmap, i);
+            if (keep[row]) {
+                if (!valid)
+                    out_col.append(value_t::make_null());
+                else if (column.type == DataType::INT32)
+                    out_col.append(value_t::make_i32(data_begin[data_idx]));
+                else
+                    out_col.append(value_t::make_str_ref(table_id, in_col_idx, (uint32_t)page_idx, data_idx));
+            }
+            data_idx += valid;
+        }
+    }
+}
+
 // ----------------------------------------------------------------------------
 // SCAN
 // ----------------------------------------------------------------------------
 ColumnBuffer scan_columnar_to_columnbuffer(
     const Plan& plan,
     const ScanNode& scan,
-    const std::vector<std::tuple<size_t, DataType>>& output_attrs)
+    const std::vector<std::tuple<size_t, DataType>>& output_attrs,
+    const std::vector<ScanFilter>& filters,
+    const std::vector<uint8_t>* selection)
 {
     auto table_id = scan.base_table_id;                         // Input table ID
     const auto& input_columnar = plan.inputs[table_id];         // Columnar source
@@ -60,6 +145,27 @@ ColumnBuffer scan_columnar_to_columnbuffer(
     buf.types.reserve(output_attrs.size());
     for (auto& t : output_attrs) buf.types.push_back(std::get<1>(t));
 
+    // Runtime filters / row selection: materialize the surviving rows only
+    // (zero-copy needs all rows of the pages, so it is kept for unfiltered scans)
+    if (!filters.empty() || selection) {
+        std::vector<uint8_t> keep = selection ? *selection : std::vector<uint8_t>(input_columnar.num_rows, 1);
+        const size_t kept = evaluate_scan_filters(input_columnar, filters, keep);
+        if (join_telemetry_enabled()) qt_add_scan_filter(input_columnar.num_rows, kept);
+
+        // Dropping a few rows does not pay for losing zero-copy columns, unless the
+        // selection must bound the intermediates (semi-join reduction)
+        const bool worth_it = kept * 100 <= input_columnar.num_rows * (100 - kRuntimeFilterMinDropPercent);
+        if (kept < input_columnar.num_rows && (selection || worth_it)) {
+            buf.num_rows = kept;
+            ThreadPool::current().run(output_attrs.size(), [&](size_t col_idx) {
+                const size_t in_col_idx = std::get<0>(output_attrs[col_idx]);
+                materialize_selected_rows(input_columnar.columns[in_col_idx], (uint8_t)table_id,
+                                          (uint8_t)in_col_idx, keep, buf.columns[col_idx]);
+            });
+            return buf;
+        }
+    }
+
     for (size_t col_idx = 0; col_idx < output_attrs.size(); ++col_idx) {
         size_t in_col_idx = std::get<0>(output_attrs[col_idx]);       // Source column
         const auto& column = input_columnar.columns[in_col_idx];      // Input
@@ -201,6 +307,70 @@ StringRefResolver::resolve(uint64_t raw_ref, std::string& buffer) {
     return {buffer.data(), buffer.size()};
 }
 
+// Bytes of a packed ref, in place. Long strings return their first chunk with long_column
+// set and next_page at the following page; normal strings return the whole slot.
+static std::string_view ref_first_chunk(const Plan* plan, uint64_t raw_ref,
+                                        const Column*& long_column, size_t& next_page) {
+    long_column = nullptr;
+    PackedStringRef ref = PackedStringRef::unpack(raw_ref);
+
+    if (ref.parts.table_id >= plan->inputs.size()) return {};
+    const ColumnarTable& ct = plan->inputs[ref.parts.table_id];
+    if (ref.parts.col_id >= ct.columns.size()) return {};
+    const auto& column = ct.columns[ref.parts.col_id];
+    if (ref.parts.page_idx >= column.pages.size()) return {};
+    auto* page_data = column.pages[ref.parts.page_idx]->data;
+
+    uint16_t num_rows = *reinterpret_cast<const uint16_t*>(page_data);
+    if (num_rows == 0xffff || num_rows == 0xfffe) {
+        long_column = &column;
+        next_page = ref.parts.page_idx + 1;
+        return {reinterpret_cast<const char*>(page_data + 4), *reinterpret_cast<const uint16_t*>(page_data + 2)};
+    }
+
+    uint16_t num_offsets = *reinterpret_cast<const uint16_t*>(page_data + 2);
+    if (ref.parts.slot_idx >= num_offsets) return {};
+    auto* offsets = reinterpret_cast<const uint16_t*>(page_data + 4);
+    uint16_t start = (ref.parts.slot_idx == 0) ? 0 : offsets[ref.parts.slot_idx - 1];
+    return {reinterpret_cast<const char*>(page_data + 4 + num_offsets * 2 + start),
+            static_cast<size_t>(offsets[ref.parts.slot_idx] - start)};
+}
+
+// Next chunk of a long string (continuation page), empty at its end
+static std::string_view ref_next_chunk(const Column& column, size_t& page) {
+    if (page >= column.pages.size()) return {};
+    auto* p = column.pages[page]->data;
+    if (*reinterpret_cast<const uint16_t*>(p) != 0xfffe) return {};
+    ++page;
+    return {reinterpret_cast<const char*>(p + 4), *reinterpret_cast<const uint16_t*>(p + 2)};
+}
+
+uint64_t StringRefResolver::hash(uint64_t raw_ref) const {
+    const Column* long_column;
+    size_t page;
+    std::string_view chunk = ref_first_chunk(plan, raw_ref, long_column, page);
+    uint64_t h = Hash::bytes64(chunk.data(), chunk.size());
+    if (long_column)
+        while (!(chunk = ref_next_chunk(*long_column, page)).empty()) h = Hash::bytes64(chunk.data(), chunk.size(), h);
+    return h;
+}
+
+bool StringRefResolver::equal(uint64_t a, uint64_t b) const {
+    if (a == b) return true;                       // Same slot
+    const Column *long_a, *long_b;
+    size_t page_a, page_b;
+    std::string_view ca = ref_first_chunk(plan, a, long_a, page_a);
+    std::string_view cb = ref_first_chunk(plan, b, long_b, page_b);
+    // Strings are long exactly when they exceed one page, so equal strings are chunked alike
+    for (;;) {
+        if (ca != cb) return false;
+        if (!long_a || !long_b) return !long_a && !long_b;
+        ca = ref_next_chunk(*long_a, page_a);
+        cb = ref_next_chunk(*long_b, page_b);
+        if (ca.empty() && cb.empty()) return true;
+    }
+}
+
 // ----------------------------------------------------------------------------
 // FINALIZE
 // ----------------------------------------------------------------------------
@@ -225,10 +395,14 @@ ColumnarTable finalize_columnbuffer_to_columnar(
             continue;
         }
 
+        // Row-id columns gather their values from the base column here
+        const column_t& src = buf.columns[col_idx];
+        size_t page_cache = 0;
+
         if (dtype == DataType::INT32) {
             ColumnInserter<int32_t> inserter(col);              // Inserter for INT32
             for (size_t row_idx = 0; row_idx < buf.num_rows; ++row_idx) {
-                const auto& v = buf.columns[col_idx].get(row_idx);
+                const value_t v = src.get_cached(row_idx, page_cache);
                 if (!v.is_null()) inserter.insert(v.as_i32());
                 else inserter.insert_null();
             }
@@ -237,7 +411,7 @@ ColumnarTable finalize_columnbuffer_to_columnar(
         else if (dtype == DataType::VARCHAR) {
             ColumnInserter<std::string> inserter(col);          // Inserter for strings
             for (size_t row_idx = 0; row_idx < buf.num_rows; ++row_idx) {
-                const auto& v = buf.columns[col_idx].get(row_idx);
+                const value_t v = src.get_cached(row_idx, page_cache);
 
                 if (v.is_null()) {
                     inserter.insert_null();
@@ -274,7 +448,9 @@ void dump_columnar_debug(const ColumnarTable& table) {
 // ----------------------------------------------------------------------------
 
 size_t StringRefHash::operator()(const PackedStringRef& k) const {
-    return std::hash<uint64_t>{}(k.raw); // Hash over the raw reference
+    if (plan == nullptr)
+        return std::hash<uint64_t>{}(k.raw); // Cannot resolve without a plan
+    return StringRefResolver(plan).hash(k.raw); // Equal strings hash equally (matches StringRefEq)
 }
 
 bool StringRefEq::operator()(const PackedStringRef& a,
@@ -286,16 +462,6 @@ bool StringRefEq::operator()(const PackedStringRef& a,
     if (plan == nullptr)
         return false; // Cannot resolve without a plan
 
-    StringRefResolver resolver(plan);
-    std::string sa, sb;
-
-    auto [pa, la] = resolver.resolve(a.raw, sa);
-    auto [pb, lb] = resolver.resolve(b.raw, sb);
-
-    if (!pa || !pb || la != lb)
-        return false; // Not comparable or different length
-
-    return std::memcmp(pa, pb, la) == 0; // Final byte comparison
+    return StringRefResolver(plan).equal(a.raw, b.raw); // Byte comparison in place
 }
-
-} // namespace Contest
\ No newline at end of file
+} // namespace Contest
@@ -0,0 +1,125 @@
+// numa.cpp - sysfs topology, affinity and mbind
+#include "numa.h"
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace Contest {
+
+static constexpr int kMpolInterleave = 3;              // MPOL_INTERLEAVE (linux/mempolicy.h)
+static thread_local int t_pinned_node = -1;             // Node index of a pinned worker
+
+std::vector<int> parse_cpulist(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        if (part.empty() || part == "\n") continue;
+        const std::size_t dash = part.find('-');
+        const int first = std::atoi(part.c_str());
+        const int last = dash == std::string::npos ? first : std::atoi(part.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+NumaTopology NumaTopology::parse(const std::string& sysfs_root) {
+    NumaTopology topo;
+    std::ifstream online(sysfs_root + "/online");
+    std::string list;
+    if (!online || !std::getline(online, list)) return topo;
+
+    for (const int id : parse_cpulist(list)) {
+        std::ifstream cpulist(sysfs_root + "/node" + std::to_string(id) + "/cpulist");
+        std::string cpus;
+        if (!cpulist || !std::getline(cpulist, cpus)) continue;
+        std::vector<int> node = parse_cpulist(cpus);
+        if (node.empty()) continue;                     // Memory-only node
+        topo.node_ids.push_back(id);
+        topo.node_cpus.push_back(std::move(node));
+    }
+    for (std::size_t n = 0; n < topo.node_cpus.size(); ++n) {
+        for (const int cpu : topo.node_cpus[n]) {
+            if (cpu >= static_cast<int>(topo.cpu_node.size())) topo.cpu_node.resize(cpu + 1, -1);
+            topo.cpu_node[cpu] = static_cast<int>(n);
+        }
+    }
+    return topo;
+}
+
+const NumaTopology& NumaTopology::system() {
+    static const NumaTopology topo = [] {
+        NumaTopology all = parse("/sys/devices/system/node");
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return all;
+
+        NumaTopology usable;                            // Nodes this process may run on
+        for (std::size_t n = 0; n < all.node_ids.size(); ++n) {
+            std::vector<int> cpus;
+            for (const int cpu : all.node_cpus[n])
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            if (cpus.empty()) continue;
+            for (const int cpu : cpus) {
+                if (cpu >= static_cast<int>(usable.cpu_node.size())) usable.cpu_node.resize(cpu + 1, -1);
+                usable.cpu_node[cpu] = static_cast<int>(usable.node_ids.size());
+            }
+            usable.node_ids.push_back(all.node_ids[n]);
+            usable.node_cpus.push_back(std::move(cpus));
+        }
+        return usable;
+    }();
+    return topo;
+}
+
+std::size_t numa_num_nodes() {
+    static const std::size_t nodes = [] {
+        const char* v = std::getenv("NUMA");
+        if (v && *v == '0') return std::size_t{1};
+        return NumaTopology::system().num_nodes();
+    }();
+    return nodes;
+}
+
+std::size_t current_numa_node() {
+    if (t_pinned_node >= 0) return static_cast<std::size_t>(t_pinned_node);
+    if (numa_num_nodes() <= 1) return 0;
+    const int cpu = sched_getcpu();
+    const auto& cpu_node = NumaTopology::system().cpu_node;
+    if (cpu < 0 || cpu >= static_cast<int>(cpu_node.size()) || cpu_node[cpu] < 0) return 0;
+    return static_cast<std::size_t>(cpu_node[cpu]);
+}
+
+void pin_thread_to_node(std::size_t node) {
+    if (numa_num_nodes() <= 1) return;
+    const NumaTopology& topo = NumaTopology::system();
+    if (node >= topo.node_cpus.size()) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : topo.node_cpus[node])
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == 0) t_pinned_node = static_cast<int>(node);
+}
+
+void numa_interleave(void* addr, std::size_t bytes) {
+    if (numa_num_nodes() <= 1 || addr == nullptr) return;
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const uintptr_t page = page_size > 0 ? static_cast<uintptr_t>(page_size) : 4096;
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(addr) + page - 1) & ~(page - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + bytes) & ~(page - 1);
+    if (end <= begin) return;                           // Less than a page: leave it alone
+
+    constexpr std::size_t kMaskBits = 8 * sizeof(unsigned long);
+    unsigned long mask[1024 / kMaskBits] = {};          // Up to 1024 node ids
+    for (const int id : NumaTopology::system().node_ids)
+        if (id >= 0 && id < 1024) mask[id / kMaskBits] |= 1ul << (id % kMaskBits);
+    // Best effort: a failing mbind (e.g. seccomp) only loses the placement
+    syscall(SYS_mbind, begin, end - begin, kMpolInterleave, mask, 1024ul + 1, 0u);
+}
+
+} // namespace Contest
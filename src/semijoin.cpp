@@ -0,0 +1,225 @@
+// semijoin.cpp - Yannakakis-style semi-join reduction
+#include "semijoin.h"
+#include "parallel_unchained_hashtable.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <variant>
+
+namespace Contest {
+
+std::pair<std::size_t, std::size_t> trace_to_scan(const Plan& plan, std::size_t node_idx, std::size_t col) {
+    for (;;) {
+        const auto& node = plan.nodes[node_idx];
+        const std::size_t idx = std::get<0>(node.output_attrs[col]);
+        if (const auto* join = std::get_if<JoinNode>(&node.data)) {
+            const std::size_t left_cols = plan.nodes[join->left].output_attrs.size();
+            node_idx = idx < left_cols ? join->left : join->right;
+            col = idx < left_cols ? idx : idx - left_cols;
+        } else {
+            return {node_idx, idx};
+        }
+    }
+}
+
+bool semijoin_reduction_enabled() {
+    // Opt-in: two extra passes over every join key column
+    static const bool enabled = [] {
+        const char* v = std::getenv("SEMIJOIN_REDUCTION");
+        return v && *v && *v != '0';
+    }();
+    return enabled;
+}
+
+namespace {
+
+// One join of the plan as an edge between two scan nodes
+struct SemiJoinEdge {
+    std::size_t scan[2];    // Scan nodes
+    std::size_t column[2];  // Base columns
+};
+
+// Call fn(row, value) for the non-NULL values of pages [page_begin, page_end) of an INT32 column
+template <typename Fn>
+void for_each_int32(const Column& column, const std::vector<std::size_t>& page_start,
+                    std::size_t page_begin, std::size_t page_end, Fn&& fn) {
+    for (std::size_t p = page_begin; p < page_end; ++p) {
+        auto* page = column.pages[p]->data;
+        const uint16_t num_rows_in_page = *reinterpret_cast<const uint16_t*>(page);
+        auto* data_begin = reinterpret_cast<const int32_t*>(page + 4);
+        auto* bitmap = reinterpret_cast<const uint8_t*>(page + PAGE_SIZE - (num_rows_in_page + 7) / 8);
+
+        uint16_t data_idx = 0; // Advance only on valid entries
+        for (uint16_t i = 0; i < num_rows_in_page; ++i) {
+            if (bitmap[i / 8] & (1u << (i % 8))) fn(page_start[p] + i, data_begin[data_idx++]);
+        }
+    }
+}
+
+// Exact set of join keys: a bitmap when the key range is dense, a hash table otherwise
+class KeySet {
+public:
+    explicit KeySet(std::vector<int32_t> keys) {
+        if (keys.empty()) return;
+        const auto [lo, hi] = std::minmax_element(keys.begin(), keys.end());
+        min_ = *lo;
+        max_ = *hi;
+
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max_) - min_) + 1;
+        if (range <= 32 * keys.size()) {                    // At most 32 bits per key
+            dense_.assign((range + 63) / 64, 0);
+            for (int32_t k : keys) {
+                const uint64_t bit = static_cast<uint64_t>(static_cast<int64_t>(k) - min_);
+                dense_[bit / 64] |= 1ull << (bit % 64);
+            }
+            return;
+        }
+
+        // Duplicates would only lengthen the buckets
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<HashEntry<int32_t>> entries(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) entries[i] = HashEntry<int32_t>{keys[i], 0};
+        table_.reserve(entries.size());
+        table_.build_from_entries(entries, parallel_build_threads(entries.size(), table_.directory_size()));
+    }
+
+    bool contains(int32_t key) const {
+        if (key < min_ || key > max_) return false;
+        if (!dense_.empty()) {
+            const uint64_t bit = static_cast<uint64_t>(static_cast<int64_t>(key) - min_);
+            return dense_[bit / 64] & (1ull << (bit % 64));
+        }
+        bool found = false;
+        table_.for_each_match(key, [&](uint32_t) { found = true; });
+        return found;
+    }
+
+private:
+    int32_t min_ = std::numeric_limits<int32_t>::max();
+    int32_t max_ = std::numeric_limits<int32_t>::min();
+    std::vector<uint64_t> dense_;
+    FlatUnchainedHashTable<int32_t> table_;
+};
+
+class SemiJoinReducer {
+public:
+    explicit SemiJoinReducer(const Plan& plan) : plan_(plan), keep_(plan.nodes.size()) {}
+
+    std::vector<std::vector<uint8_t>> run() {
+        if (!collect(plan_.root)) return std::vector<std::vector<uint8_t>>(plan_.nodes.size());
+        if (edges_.empty()) return std::vector<std::vector<uint8_t>>(plan_.nodes.size());
+
+        // Orient the edge tree from the root scan: order[i] is reached through edge via[i]
+        std::vector<std::size_t> order{scans_.front()};
+        std::vector<std::size_t> via{SIZE_MAX};
+        std::vector<uint8_t> edge_used(edges_.size(), 0);
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            for (std::size_t e = 0; e < edges_.size(); ++e) {
+                if (edge_used[e]) continue;
+                for (int side = 0; side < 2; ++side) {
+                    if (edges_[e].scan[side] != order[i]) continue;
+                    edge_used[e] = 1;
+                    order.push_back(edges_[e].scan[1 - side]);
+                    via.push_back(e);
+                    break;
+                }
+            }
+        }
+
+        for (std::size_t scan : scans_) keep_[scan].assign(plan_.inputs[table_of(scan)].num_rows, 1);
+
+        // Bottom-up: every parent keeps the rows that join with its (reduced) child
+        for (std::size_t i = order.size(); i-- > 1;) {
+            const SemiJoinEdge& e = edges_[via[i]];
+            const int child = e.scan[0] == order[i] ? 0 : 1;
+            reduce(e.scan[1 - child], e.column[1 - child], e.scan[child], e.column[child]);
+        }
+        // Top-down: every child keeps the rows that join with its (fully reduced) parent
+        for (std::size_t i = 1; i < order.size(); ++i) {
+            const SemiJoinEdge& e = edges_[via[i]];
+            const int child = e.scan[0] == order[i] ? 0 : 1;
+            reduce(e.scan[child], e.column[child], e.scan[1 - child], e.column[1 - child]);
+        }
+        return std::move(keep_);
+    }
+
+private:
+    std::size_t table_of(std::size_t scan) const {
+        return std::get<ScanNode>(plan_.nodes[scan].data).base_table_id;
+    }
+
+    const Column& column_of(std::size_t scan, std::size_t col) const {
+        return plan_.inputs[table_of(scan)].columns[col];
+    }
+
+    // Record scans and join edges of the subtree; false if a key is not INT32
+    bool collect(std::size_t node_idx) {
+        const auto& node = plan_.nodes[node_idx];
+        const auto* join = std::get_if<JoinNode>(&node.data);
+        if (!join) {
+            scans_.push_back(node_idx);
+            return true;
+        }
+        if (!collect(join->left) || !collect(join->right)) return false;
+
+        const auto [ls, lc] = trace_to_scan(plan_, join->left, join->left_attr);
+        const auto [rs, rc] = trace_to_scan(plan_, join->right, join->right_attr);
+        if (column_of(ls, lc).type != DataType::INT32 || column_of(rs, rc).type != DataType::INT32) return false;
+        edges_.push_back(SemiJoinEdge{{ls, rs}, {lc, rc}});
+        return true;
+    }
+
+    static std::vector<std::size_t> page_starts(const Column& column) {
+        std::vector<std::size_t> start(column.pages.size() + 1, 0);
+        for (std::size_t p = 0; p < column.pages.size(); ++p)
+            start[p + 1] = start[p] + *reinterpret_cast<const uint16_t*>(column.pages[p]->data);
+        return start;
+    }
+
+    // target := target semi-join source on target.target_col = source.source_col
+    void reduce(std::size_t target, std::size_t target_col, std::size_t source, std::size_t source_col) {
+        ThreadPool& pool = ThreadPool::current();
+
+        // Keys of the surviving source rows (per task, then merged)
+        const Column& src = column_of(source, source_col);
+        const auto src_start = page_starts(src);
+        const std::vector<uint8_t>& src_keep = keep_[source];
+        const std::size_t nt = std::max<std::size_t>(1, std::min(pool.num_threads(), src.pages.size()));
+        std::vector<std::vector<int32_t>> parts(nt);
+        pool.run(nt, [&](std::size_t t) {
+            for_each_int32(src, src_start, src.pages.size() * t / nt, src.pages.size() * (t + 1) / nt,
+                           [&](std::size_t row, int32_t v) { if (src_keep[row]) parts[t].push_back(v); });
+        });
+        std::vector<int32_t> keys;
+        for (auto& part : parts) keys.insert(keys.end(), part.begin(), part.end());
+        const KeySet set(std::move(keys));
+
+        // Drop target rows without a partner (NULL keys never join)
+        const Column& dst = column_of(target, target_col);
+        const auto dst_start = page_starts(dst);
+        std::vector<uint8_t>& dst_keep = keep_[target];
+        pool.for_each_morsel(dst.pages.size(), 16, [&](std::size_t page_begin, std::size_t page_end) {
+            std::vector<uint8_t> matched(dst_start[page_end] - dst_start[page_begin], 0);
+            for_each_int32(dst, dst_start, page_begin, page_end, [&](std::size_t row, int32_t v) {
+                matched[row - dst_start[page_begin]] = set.contains(v);
+            });
+            for (std::size_t row = dst_start[page_begin]; row < dst_start[page_end]; ++row)
+                dst_keep[row] &= matched[row - dst_start[page_begin]];
+        });
+    }
+
+    const Plan& plan_;
+    std::vector<std::vector<uint8_t>> keep_;  // Per plan node
+    std::vector<std::size_t> scans_;
+    std::vector<SemiJoinEdge> edges_;
+};
+
+} // namespace
+
+std::vector<std::vector<uint8_t>> semijoin_reduce(const Plan& plan) {
+    return SemiJoinReducer(plan).run();
+}
+
+} // namespace Contest
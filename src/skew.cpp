@@ -0,0 +1,59 @@
+// skew.cpp - heavy-hitter detection over sampled build keys
+#include "skew.h"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace Contest {
+
+bool skew_handling_enabled() {
+    static const bool disabled = [] {
+        const char* v = std::getenv("SKEW_JOIN");
+        return v && *v == '0';
+    }();
+    return !disabled;
+}
+
+HeavyHitters HeavyHitters::detect(const IHashTable<int32_t>& table, std::vector<int32_t> sample,
+                                  std::size_t build_rows) {
+    HeavyHitters heavy;
+    if (sample.empty() || build_rows < kSkewMinMatches) return heavy;
+
+    // A key is a candidate once its sampled share extrapolates to half the threshold;
+    // with a full sample (stride 1) the counts are exact
+    const double stride = static_cast<double>(build_rows) / static_cast<double>(sample.size());
+    const std::size_t min_hits = std::max<std::size_t>(
+        stride > 1 ? 2 : 1, static_cast<std::size_t>(kSkewMinMatches / 2 / stride));
+
+    std::sort(sample.begin(), sample.end());
+    std::vector<std::pair<std::size_t, int32_t>> candidates;    // (hits, key)
+    for (std::size_t i = 0; i < sample.size();) {
+        std::size_t j = i + 1;
+        while (j < sample.size() && sample[j] == sample[i]) ++j;
+        if (j - i >= min_hits) candidates.emplace_back(j - i, sample[i]);
+        i = j;
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<ProbeMatch> matches;
+    for (const auto& [hits, key] : candidates) {
+        if (heavy.size() == kSkewMaxKeys) break;
+        matches.clear();
+        table.probe_batch(&key, 1, matches);
+        if (matches.size() < kSkewMinMatches) continue;         // Sampling overestimated it
+        std::vector<uint32_t> rows(matches.size());
+        for (std::size_t m = 0; m < matches.size(); ++m) rows[m] = matches[m].build_row;
+        heavy.add(key, std::move(rows));
+    }
+    return heavy;
+}
+
+void HeavyHitters::add(int32_t key, std::vector<uint32_t> rows) {
+    std::size_t s = slot_of(key);
+    while (slots_[s] >= 0) s = (s + 1) & (kSlots - 1);
+    slots_[s] = static_cast<int8_t>(keys_.size());
+    keys_.push_back(key);
+    rows_.push_back(std::move(rows));
+}
+
+} // namespace Contest
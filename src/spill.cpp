@@ -0,0 +1,120 @@
+// spill.cpp - temporary partition files of the grace hash join
+#include "spill.h"
+#include <hardware.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+namespace Contest {
+
+std::size_t join_memory_budget_default() {
+    if (const char* v = std::getenv("JOIN_MEMORY_MB"); v && *v)
+        return static_cast<std::size_t>(std::strtoull(v, nullptr, 10)) << 20;
+    std::size_t node_bytes = static_cast<std::size_t>(SPC__NUMA_NODE_DRAM_MB) << 20;
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0)
+        node_bytes = std::min(node_bytes, static_cast<std::size_t>(pages) * static_cast<std::size_t>(page_size));
+    return node_bytes / 2;
+}
+
+std::size_t choose_grace_partitions(std::size_t build_rows, std::size_t budget) {
+    static const int forced = [] {
+        const char* v = std::getenv("GRACE_JOIN");
+        if (!v || !*v) return -1;
+        return *v == '0' ? 0 : 1;
+    }();
+    if (forced == 0 || build_rows == 0) return 0;
+
+    const std::size_t bytes = build_rows * kGraceBytesPerBuildRow;
+    if (forced != 1 && (budget == 0 || bytes <= budget)) return 0;
+
+    // One partition's table should take at most half of the budget
+    const std::size_t per_partition = std::max<std::size_t>(1, budget / 2);
+    std::size_t partitions = 2;
+    while (partitions < kGraceMaxPartitions && partitions * per_partition < bytes) partitions <<= 1;
+    return partitions;
+}
+
+// ----------------------------------------------------------------------------
+// PAGES
+// ----------------------------------------------------------------------------
+
+void write_int32_page(Page& page, const int32_t* values, std::size_t n) {
+    std::byte* data = page.data;
+    *reinterpret_cast<uint16_t*>(data) = static_cast<uint16_t>(n);       // Rows
+    *reinterpret_cast<uint16_t*>(data + 2) = static_cast<uint16_t>(n);   // Non-NULL values
+    std::memcpy(data + 4, values, n * sizeof(int32_t));
+    const std::size_t bitmap_size = (n + 7) / 8;                         // All valid
+    std::byte* bitmap = data + PAGE_SIZE - bitmap_size;
+    std::memset(bitmap, 0xff, bitmap_size);
+    if (n % 8) bitmap[bitmap_size - 1] = static_cast<std::byte>((1u << (n % 8)) - 1);
+}
+
+std::size_t read_int32_page(const Page& page, int32_t* values) {
+    const std::size_t n = *reinterpret_cast<const uint16_t*>(page.data);
+    std::memcpy(values, page.data + 4, n * sizeof(int32_t));
+    return n;
+}
+
+// ----------------------------------------------------------------------------
+// SPILL FILE
+// ----------------------------------------------------------------------------
+
+SpillFile::SpillFile(std::size_t num_partitions)
+    : pages_(num_partitions), page_rows_(num_partitions), rows_(num_partitions, 0) {
+    std::filesystem::path dir;
+    if (const char* v = std::getenv("SPILL_DIR"); v && *v) dir = v;
+    else dir = std::filesystem::temp_directory_path();
+    std::string path = (dir / "join_spill_XXXXXX").string();
+    fd_ = mkstemp(path.data());
+    if (fd_ == -1) throw std::runtime_error("Failed to create spill file in " + dir.string());
+    unlink(path.c_str());                               // Removed with the last descriptor
+}
+
+SpillFile::~SpillFile() {
+    if (fd_ != -1) close(fd_);
+}
+
+void SpillFile::append(std::size_t partition, const int32_t* keys, const uint32_t* rows, std::size_t n) {
+    Page pair[2];
+    write_int32_page(pair[0], keys, n);
+    write_int32_page(pair[1], reinterpret_cast<const int32_t*>(rows), n);
+
+    const uint64_t offset = end_.fetch_add(sizeof(pair), std::memory_order_relaxed);
+    const auto* src = reinterpret_cast<const char*>(pair);
+    for (std::size_t done = 0; done < sizeof(pair);) {
+        const ssize_t w = pwrite(fd_, src + done, sizeof(pair) - done, static_cast<off_t>(offset + done));
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) throw std::runtime_error("Failed to write spill file: " + std::string(std::strerror(errno)));
+        done += static_cast<std::size_t>(w);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pages_[partition].push_back(offset);
+    page_rows_[partition].push_back(static_cast<uint32_t>(n));
+    rows_[partition] += n;
+}
+
+std::size_t SpillFile::read_page(std::size_t partition, std::size_t page, int32_t* keys, uint32_t* rows) const {
+    Page pair[2];
+    const uint64_t offset = pages_[partition][page];
+    auto* dst = reinterpret_cast<char*>(pair);
+    for (std::size_t done = 0; done < sizeof(pair);) {
+        const ssize_t r = pread(fd_, dst + done, sizeof(pair) - done, static_cast<off_t>(offset + done));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) throw std::runtime_error("Failed to read spill file: " + std::string(std::strerror(errno)));
+        done += static_cast<std::size_t>(r);
+    }
+    const std::size_t n = read_int32_page(pair[0], keys);
+    read_int32_page(pair[1], reinterpret_cast<int32_t*>(rows));
+    return n;
+}
+
+} // namespace Contest
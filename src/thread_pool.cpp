@@ -0,0 +1,131 @@
+// thread_pool.cpp - persistent worker pool
+#include "thread_pool.h"
+#include "work_stealing.h"
+#include "numa.h"
+#include <algorithm>
+
+namespace Contest {
+
+static std::atomic<ThreadPool*> g_current_pool{nullptr};
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 4;                 // Fallback
+    workers_.reserve(num_threads - 1);                     // The caller is the last thread
+    for (std::size_t t = 1; t < num_threads; ++t) {
+        // Workers stay on one node (no-op on single-node machines), spread evenly
+        const std::size_t node = NumaTopology::system().node_of_thread(t, num_threads);
+        workers_.emplace_back([this, node]() {
+            pin_thread_to_node(node);
+            worker_loop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& w : workers_) w.join();
+}
+
+void ThreadPool::work_on(Job& job) {
+    for (std::size_t t = job.next.fetch_add(1); t < job.tasks; t = job.next.fetch_add(1)) {
+        if (!job.failed.load(std::memory_order_relaxed)) {
+            try {
+                (*job.fn)(t);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                if (!job.error) job.error = std::current_exception();
+                job.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (job.done.fetch_add(1) + 1 == job.tasks) {      // Last task -> wake the owner
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (stop_) return;
+            job = queue_.front();
+            if (job->next.load() >= job->tasks) {          // Fully claimed -> drop it
+                queue_.pop_front();
+                continue;
+            }
+        }
+        work_on(*job);
+    }
+}
+
+void ThreadPool::run(std::size_t tasks, const std::function<void(std::size_t)>& fn) {
+    if (tasks == 0) return;
+    if (tasks == 1 || workers_.empty()) {                  // Nothing to share
+        for (std::size_t t = 0; t < tasks; ++t) fn(t);
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->tasks = tasks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(job);
+    }
+    if (tasks - 1 >= workers_.size()) wake_.notify_all();
+    else for (std::size_t t = 1; t < tasks; ++t) wake_.notify_one();
+
+    work_on(*job);                                         // The caller takes part
+    {
+        std::lock_guard<std::mutex> lock(mutex_);          // All tasks are claimed: unlist the job
+        auto it = std::find(queue_.begin(), queue_.end(), job);
+        if (it != queue_.end()) queue_.erase(it);
+    }
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job]() { return job->done.load() == job->tasks; });
+    if (job->error) std::rethrow_exception(job->error);   // No thread uses fn any more
+}
+
+void ThreadPool::for_each_morsel(std::size_t total, std::size_t min_block,
+                                 const std::function<void(std::size_t, std::size_t)>& fn) {
+    if (total == 0) return;
+    const std::size_t nt = std::min(num_threads(), (total + min_block - 1) / std::max<std::size_t>(1, min_block));
+    if (nt <= 1) {
+        fn(0, total);
+        return;
+    }
+
+    WorkStealingConfig config{
+        .total_work = total,
+        .num_threads = nt,
+        .min_block_size = min_block,
+        .blocks_per_thread = 4
+    };
+    NodeAwareCoordinator coordinator(total, config.get_block_size(), numa_num_nodes());
+    run(nt, [&](std::size_t) {
+        const std::size_t node = current_numa_node();
+        std::size_t begin, end;
+        while (coordinator.steal_block(node, begin, end)) fn(begin, end);
+    });
+}
+
+ThreadPool& ThreadPool::current() {
+    if (ThreadPool* pool = g_current_pool.load(std::memory_order_acquire)) return *pool;
+    static ThreadPool fallback;                            // Used before/without a context
+    return fallback;
+}
+
+void ThreadPool::install(ThreadPool* pool) {
+    g_current_pool.store(pool, std::memory_order_release);
+}
+
+} // namespace Contest
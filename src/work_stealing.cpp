@@ -26,4 +26,28 @@ bool WorkStealingCoordinator::steal_block(size_t& begin, size_t& end) {
     return true;
 }
 
+NodeAwareCoordinator::NodeAwareCoordinator(size_t total_work, size_t block_size, size_t num_nodes)
+    : block_size_(std::max<size_t>(1, block_size))
+    , num_ranges_(std::max<size_t>(1, num_nodes))
+    , ranges_(new Range[num_ranges_])
+{
+    for (size_t r = 0; r < num_ranges_; ++r) {
+        ranges_[r].begin = total_work * r / num_ranges_;
+        ranges_[r].end = total_work * (r + 1) / num_ranges_;
+        ranges_[r].next.store(ranges_[r].begin, std::memory_order_relaxed);
+    }
+}
+
+bool NodeAwareCoordinator::steal_block(size_t node, size_t& begin, size_t& end) {
+    for (size_t k = 0; k < num_ranges_; ++k) {
+        Range& range = ranges_[(node + k) % num_ranges_];   // Own node first
+        if (range.next.load(std::memory_order_relaxed) >= range.end) continue;
+        begin = range.next.fetch_add(block_size_, std::memory_order_acquire);
+        if (begin >= range.end) continue;                   // Drained meanwhile
+        end = std::min(range.end, begin + block_size_);
+        return true;
+    }
+    return false;
+}
+
 } // namespace Contest
@@ -0,0 +1,365 @@
+// hashtable_bench.cpp - build / probe microbenchmark of the join hash tables
+//
+// Drives every IHashTable implementation (and FlatUnchainedHashTable without the virtual
+// interface) over synthetic INT32 build sides:
+//
+// - distributions: dense (permuted 0..n-1), sparse (random keys), dup4 / dup16 (sparse keys
+//   repeated 4 / 16 times), zipf (n / 4 sparse keys, Zipf(1) frequencies)
+// - build sizes: half of L1, L2 and L3 (hardware.h) and 4x / 16x L3, in 8-byte entries
+// - match rates: 0.1% to 100% of the probe keys hit a build key (uniform over the keys)
+//
+// Reported per core (throughput / threads): build rows/s, count_batch() and probe_batch()
+// keys/s, plus memory_usage() per build row. Every count is checked against the generated
+// key frequencies; a mismatch is reported and makes the exit code non-zero.
+//
+// Usage: hashtable_bench [--threads N] [--max-rows N] [--probes N] [--reps N]
+//                        [--impl a,b,..] [--dist a,b,..] [--csv]
+#include <hardware.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dense_array_table.h"
+#include "hashtable_backend.h"
+#include "linear_probing_table.h"
+#include "parallel_unchained_hashtable.h"
+#include "thread_pool.h"
+
+using namespace Contest;
+
+namespace {
+
+using Key = int32_t;
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kBatch = 1024;                       // Keys per probe_batch() call
+constexpr double kMatchRates[] = {0.001, 0.01, 0.1, 0.5, 1.0};
+
+struct Options {
+    std::size_t threads = 1;
+    std::size_t max_rows = std::size_t{1} << 25;
+    std::size_t probes = std::size_t{1} << 22;
+    std::size_t reps = 1;                                  // Best of reps runs
+    std::vector<std::string> impls;                        // Empty = all
+    std::vector<std::string> dists;
+    bool csv = false;
+};
+
+// Build side: distinct keys with their row counts, and the shuffled rows
+struct Workload {
+    std::string dist;
+    std::vector<Key> keys;
+    std::vector<uint32_t> counts;
+    std::vector<HashEntry<Key>> entries;
+    Key min_key = 0, max_key = 0;
+};
+
+// Probe side of one match rate, with the number of matches it must produce
+struct Probes {
+    double match_rate;
+    std::vector<Key> keys;
+    std::size_t expected = 0;
+};
+
+// One table under test: build() returns false if it does not apply to the workload
+struct Impl {
+    std::string name;
+    std::function<bool(const Workload&)> build;
+    std::function<std::size_t(const Key*, std::size_t)> count;
+    std::function<void(const Key*, std::size_t, std::vector<ProbeMatch>&)> probe;
+    std::function<std::size_t()> memory;
+    std::function<void()> reset;
+};
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::vector<std::string> split(const char* list) {
+    std::vector<std::string> out;
+    for (const char* p = list; *p;) {
+        const char* end = std::strchr(p, ',');
+        out.emplace_back(p, end ? end : p + std::strlen(p));
+        p = end ? end + 1 : p + std::strlen(p);
+    }
+    return out;
+}
+
+bool selected(const std::vector<std::string>& filter, const std::string& name) {
+    return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+}
+
+// Even random keys: odd keys are guaranteed misses
+std::vector<Key> sparse_keys(std::size_t n, std::mt19937_64& rng) {
+    std::vector<Key> keys;
+    keys.reserve(n + n / 8);
+    while (keys.size() < n) {
+        while (keys.size() < n + n / 8) keys.push_back(static_cast<Key>(static_cast<uint32_t>(rng()) & ~1u));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    keys.resize(n);
+    return keys;
+}
+
+Workload make_workload(const std::string& dist, std::size_t rows, std::mt19937_64& rng) {
+    Workload w;
+    w.dist = dist;
+    if (dist == "dense") {
+        w.keys.resize(rows);
+        for (std::size_t i = 0; i < rows; ++i) w.keys[i] = static_cast<Key>(i);
+        w.counts.assign(rows, 1);
+    } else if (dist == "sparse" || dist == "dup4" || dist == "dup16") {
+        const std::size_t dup = dist == "sparse" ? 1 : dist == "dup4" ? 4 : 16;
+        w.keys = sparse_keys(std::max<std::size_t>(1, rows / dup), rng);
+        w.counts.assign(w.keys.size(), static_cast<uint32_t>(dup));
+    } else {                                               // zipf
+        w.keys = sparse_keys(std::max<std::size_t>(1, rows / 4), rng);
+        std::vector<double> cdf(w.keys.size());
+        double sum = 0;
+        for (std::size_t r = 0; r < cdf.size(); ++r) cdf[r] = sum += 1.0 / static_cast<double>(r + 1);
+        w.counts.assign(w.keys.size(), 0);
+        std::uniform_real_distribution<double> u(0, sum);
+        for (std::size_t i = 0; i < rows; ++i)
+            ++w.counts[std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin()];
+    }
+
+    for (std::size_t d = 0; d < w.keys.size(); ++d)
+        for (uint32_t c = 0; c < w.counts[d]; ++c) w.entries.push_back(HashEntry<Key>{w.keys[d], 0});
+    std::shuffle(w.entries.begin(), w.entries.end(), rng);
+    for (std::size_t i = 0; i < w.entries.size(); ++i) w.entries[i].row_id = static_cast<uint32_t>(i);
+    const auto [lo, hi] = std::minmax_element(w.keys.begin(), w.keys.end());
+    w.min_key = *lo;
+    w.max_key = *hi;
+    return w;
+}
+
+Probes make_probes(const Workload& w, double match_rate, std::size_t n, std::mt19937_64& rng) {
+    Probes p{match_rate, {}, 0};
+    p.keys.reserve(n);
+    std::uniform_real_distribution<double> hit(0, 1);
+    std::uniform_int_distribution<std::size_t> pick(0, w.keys.size() - 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (hit(rng) < match_rate) {
+            const std::size_t d = pick(rng);
+            p.keys.push_back(w.keys[d]);
+            p.expected += w.counts[d];
+        } else if (w.dist == "dense") {
+            p.keys.push_back(static_cast<Key>(w.keys.size() + rng() % (1u << 30)));
+        } else {
+            p.keys.push_back(static_cast<Key>(static_cast<uint32_t>(rng()) | 1u));
+        }
+    }
+    return p;
+}
+
+// IHashTable implementation made by make(workload) (nullptr = not applicable)
+Impl interface_impl(const std::string& name, std::function<std::unique_ptr<IHashTable<Key>>(const Workload&)> make) {
+    auto table = std::make_shared<std::unique_ptr<IHashTable<Key>>>();
+    Impl impl;
+    impl.name = name;
+    impl.build = [=](const Workload& w) {
+        *table = make(w);
+        if (!*table) return false;
+        (*table)->reserve(w.entries.size());
+        (*table)->build_from_entries(w.entries);
+        return true;
+    };
+    impl.count = [=](const Key* keys, std::size_t n) { return (*table)->count_batch(keys, n); };
+    impl.probe = [=](const Key* keys, std::size_t n, std::vector<ProbeMatch>& out) { (*table)->probe_batch(keys, n, out); };
+    impl.memory = [=] { return (*table)->memory_usage(); };
+    impl.reset = [=] { table->reset(); };
+    return impl;
+}
+
+std::vector<Impl> all_impls() {
+    std::vector<Impl> impls;
+
+    // FlatUnchainedHashTable itself, no virtual calls
+    auto flat = std::make_shared<std::unique_ptr<FlatUnchainedHashTable<Key>>>();
+    Impl direct;
+    direct.name = "flat";
+    direct.build = [=](const Workload& w) {
+        *flat = std::make_unique<FlatUnchainedHashTable<Key>>();
+        (*flat)->reserve(w.entries.size());
+        (*flat)->build_from_entries(w.entries, parallel_build_threads(w.entries.size(), (*flat)->directory_size()));
+        return true;
+    };
+    direct.count = [=](const Key* keys, std::size_t n) { return (*flat)->count_batch(keys, n); };
+    direct.probe = [=](const Key* keys, std::size_t n, std::vector<ProbeMatch>& out) { (*flat)->probe_batch(keys, n, out); };
+    direct.memory = [=] { return (*flat)->memory_usage(); };
+    direct.reset = [=] { flat->reset(); };
+    impls.push_back(direct);
+
+    for (HashTableBackend b : {HashTableBackend::Unchained, HashTableBackend::RobinHood, HashTableBackend::Cuckoo,
+                               HashTableBackend::Hopscotch})
+        impls.push_back(interface_impl(hashtable_backend_name(b), [b](const Workload&) { return create_hashtable<Key>(b); }));
+
+    impls.push_back(interface_impl("array", [](const Workload& w) -> std::unique_ptr<IHashTable<Key>> {
+        if (!dense_array_fits(w.min_key, w.max_key, w.entries.size())) return nullptr;
+        return std::make_unique<DenseArrayTable>(w.min_key, w.max_key);
+    }));
+
+    // Unique keys only: the build fails on the first repeated key
+    auto linear = std::make_shared<std::unique_ptr<LinearProbingTable>>();
+    Impl lp;
+    lp.name = "linear";
+    lp.build = [=](const Workload& w) {
+        *linear = std::make_unique<LinearProbingTable>(w.entries.size());
+        return (*linear)->try_build_from_entries(w.entries);
+    };
+    lp.count = [=](const Key* keys, std::size_t n) { return (*linear)->count_batch(keys, n); };
+    lp.probe = [=](const Key* keys, std::size_t n, std::vector<ProbeMatch>& out) { (*linear)->probe_batch(keys, n, out); };
+    lp.memory = [=] { return (*linear)->memory_usage(); };
+    lp.reset = [=] { linear->reset(); };
+    impls.push_back(lp);
+    return impls;
+}
+
+// Build rows: half of each cache level, then far beyond the LLC
+std::vector<std::size_t> build_sizes(std::size_t max_rows) {
+    const std::size_t entry = sizeof(HashEntry<Key>);
+    std::vector<std::size_t> sizes = {SPC__LEVEL1_DCACHE_SIZE / entry / 2, SPC__LEVEL2_CACHE_SIZE / entry / 2,
+                                      SPC__LEVEL3_CACHE_SIZE / entry / 2, 4ull * SPC__LEVEL3_CACHE_SIZE / entry,
+                                      16ull * SPC__LEVEL3_CACHE_SIZE / entry};
+    sizes.erase(std::remove_if(sizes.begin(), sizes.end(), [&](std::size_t s) { return s > max_rows; }), sizes.end());
+    return sizes;
+}
+
+// Run fn(t, begin, end) over one contiguous slice [begin, end) of [0, n) per thread t;
+// returns the elapsed seconds
+template <typename Fn>
+double timed_slices(ThreadPool& pool, std::size_t n, Fn&& fn) {
+    const std::size_t nt = pool.num_threads();
+    const auto start = Clock::now();
+    pool.run(nt, [&](std::size_t t) { fn(t, n * t / nt, n * (t + 1) / nt); });
+    return seconds_since(start);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) opt.threads = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-rows" && has_value) opt.max_rows = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--probes" && has_value) opt.probes = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--reps" && has_value) opt.reps = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--impl" && has_value) opt.impls = split(argv[++i]);
+        else if (arg == "--dist" && has_value) opt.dists = split(argv[++i]);
+        else if (arg == "--csv") opt.csv = true;
+        else {
+            fmt::print(stderr,
+                       "Usage: {} [--threads N] [--max-rows N] [--probes N] [--reps N] [--impl a,b] [--dist a,b] [--csv]\n"
+                       "  impl: flat unchained robinhood cuckoo hopscotch array linear\n"
+                       "  dist: dense sparse dup4 dup16 zipf\n",
+                       argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ThreadPool pool(opt.threads);
+    ThreadPool::install(&pool);
+    const double cores = static_cast<double>(pool.num_threads());
+    std::vector<Impl> impls = all_impls();
+    std::mt19937_64 rng(42);
+    bool mismatch = false;
+
+    if (opt.csv)
+        fmt::println("impl,dist,rows,match_rate,build_mrows_per_core,count_mkeys_per_core,probe_mkeys_per_core,bytes_per_row,status");
+    else
+        fmt::println("{:<10} {:<7} {:>9} {:>7} {:>12} {:>12} {:>12} {:>8}  (M/s per core, {} threads)", "impl", "dist",
+                     "rows", "match", "build", "count", "probe", "B/row", pool.num_threads());
+
+    for (const std::string dist : {"dense", "sparse", "dup4", "dup16", "zipf"}) {
+        if (!selected(opt.dists, dist)) continue;
+        for (std::size_t rows : build_sizes(opt.max_rows)) {
+            const Workload w = make_workload(dist, rows, rng);
+            std::vector<Probes> probes;
+            for (double rate : kMatchRates) probes.push_back(make_probes(w, rate, opt.probes, rng));
+
+            for (Impl& impl : impls) {
+                if (!selected(opt.impls, impl.name)) continue;
+
+                double build_s = 1e300;
+                bool built = true;
+                std::string status = "ok";
+                for (std::size_t r = 0; r < opt.reps && built; ++r) {
+                    impl.reset();
+                    const auto start = Clock::now();
+                    try {
+                        built = impl.build(w);
+                    } catch (const std::exception& e) {
+                        built = false;
+                        status = std::string("failed: ") + e.what();
+                    }
+                    build_s = std::min(build_s, seconds_since(start));
+                }
+                if (!built) {
+                    if (status != "ok" && !opt.csv) fmt::println("{:<10} {:<7} {:>9} {}", impl.name, dist, rows, status);
+                    continue;                              // Not applicable (array / linear) or failed
+                }
+                const double build_rate = static_cast<double>(w.entries.size()) / build_s / cores / 1e6;
+                const double bytes_per_row = static_cast<double>(impl.memory()) / static_cast<double>(w.entries.size());
+
+                for (const Probes& p : probes) {
+                    const std::size_t n = p.keys.size();
+                    std::vector<std::size_t> counted(pool.num_threads()), produced(pool.num_threads());
+                    double count_s = 1e300, probe_s = 1e300;
+                    for (std::size_t r = 0; r < opt.reps; ++r) {
+                        count_s = std::min(count_s, timed_slices(pool, n, [&](std::size_t t, std::size_t begin, std::size_t end) {
+                            std::size_t c = 0;
+                            for (std::size_t i = begin; i < end; i += kBatch)
+                                c += impl.count(p.keys.data() + i, std::min(kBatch, end - i));
+                            counted[t] = c;
+                        }));
+                        probe_s = std::min(probe_s, timed_slices(pool, n, [&](std::size_t t, std::size_t begin, std::size_t end) {
+                            std::vector<ProbeMatch> out;
+                            std::size_t c = 0;
+                            for (std::size_t i = begin; i < end; i += kBatch) {
+                                out.clear();
+                                impl.probe(p.keys.data() + i, std::min(kBatch, end - i), out);
+                                c += out.size();
+                            }
+                            produced[t] = c;
+                        }));
+                    }
+                    std::size_t total_counted = 0, total_produced = 0;
+                    for (std::size_t t = 0; t < counted.size(); ++t) {
+                        total_counted += counted[t];
+                        total_produced += produced[t];
+                    }
+                    const bool ok = total_counted == p.expected && total_produced == p.expected;
+                    mismatch |= !ok;
+                    const double count_rate = static_cast<double>(n) / count_s / cores / 1e6;
+                    const double probe_rate = static_cast<double>(n) / probe_s / cores / 1e6;
+                    if (opt.csv)
+                        fmt::println("{},{},{},{},{:.3f},{:.3f},{:.3f},{:.2f},{}", impl.name, dist, rows, p.match_rate,
+                                     build_rate, count_rate, probe_rate, bytes_per_row, ok ? "ok" : "mismatch");
+                    else
+                        fmt::println("{:<10} {:<7} {:>9} {:>6.1f}% {:>12.2f} {:>12.2f} {:>12.2f} {:>8.2f}{}", impl.name, dist,
+                                     rows, 100 * p.match_rate, build_rate, count_rate, probe_rate, bytes_per_row,
+                                     ok ? "" : fmt::format("  MISMATCH: {} / {} matches, expected {}", total_counted,
+                                                           total_produced, p.expected));
+                }
+                impl.reset();
+            }
+        }
+    }
+    ThreadPool::install(nullptr);
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <vector>
+#include <plan.h>
+#include <table.h>
+#include "test_helpers.h"
+
+using namespace Contest;
+
+// ============================================================================
+// ADAPTIVE BUILD SIDE TESTS
+// ============================================================================
+
+// The planner builds on big(id, id * 2) (30000 rows) against probe(k, i) (200 rows): the join
+// flips to build on probe. Output columns follow output_attrs either way, so the rows are the
+// ones ADAPTIVE_BUILD=0 returns.
+TEST_CASE("AdaptiveBuild: a flipped join keeps rows and column order", "[adaptive-build][execute]") {
+    std::vector<std::vector<Data>> big, probe;
+    for (int id = 0; id < 30000; ++id) big.push_back({id, id * 2});
+    for (int i = 0; i < 200; ++i) probe.push_back({i * 173 % 40000, i});
+
+    Plan plan;
+    const size_t tb = add_table(plan, big, {DataType::INT32, DataType::INT32});
+    const size_t tp = add_table(plan, probe, {DataType::INT32, DataType::INT32});
+    const size_t b = plan.new_scan_node(tb, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t p = plan.new_scan_node(tp, {{0, DataType::INT32}, {1, DataType::INT32}});
+    plan.root = plan.new_join_node(true, b, p, 0, 0, {{3, DataType::INT32}, {1, DataType::INT32}, {0, DataType::INT32}});
+
+    std::vector<std::vector<Data>> expected;
+    for (const auto& row : probe) {
+        const int k = std::get<int32_t>(row[0]);
+        if (k < 30000) expected.push_back({row[1], k * 2, k});
+    }
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(run(plan) == expected);
+}
+
+TEST_CASE("AdaptiveBuild: a chain stops at a stage to flip", "[adaptive-build][pipeline]") {
+    // dim(d, d + 1) JOIN (big(id, id * 2) JOIN probe(k, d, i) ON id = k) ON d: a left-deep
+    // chain whose first stage builds on 30000 rows for 200 probe rows
+    std::vector<std::vector<Data>> big, probe, dim;
+    for (int id = 0; id < 30000; ++id) big.push_back({id, id * 2});
+    for (int i = 0; i < 200; ++i) probe.push_back({i * 173 % 40000, i % 7, i});
+    for (int d = 0; d < 5; ++d) dim.push_back({d, d + 1});
+
+    Plan plan;
+    const size_t tb = add_table(plan, big, {DataType::INT32, DataType::INT32});
+    const size_t tp = add_table(plan, probe, {DataType::INT32, DataType::INT32, DataType::INT32});
+    const size_t td = add_table(plan, dim, {DataType::INT32, DataType::INT32});
+    const size_t b = plan.new_scan_node(tb, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t p = plan.new_scan_node(tp, {{0, DataType::INT32}, {1, DataType::INT32}, {2, DataType::INT32}});
+    const size_t d = plan.new_scan_node(td, {{0, DataType::INT32}, {1, DataType::INT32}});
+    // (big.y, probe.d, probe.i), then (dim.e, big.y, probe.i)
+    const size_t bp = plan.new_join_node(true, b, p, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}, {4, DataType::INT32}});
+    plan.root = plan.new_join_node(true, d, bp, 0, 1, {{1, DataType::INT32}, {2, DataType::INT32}, {4, DataType::INT32}});
+
+    std::vector<std::vector<Data>> expected;
+    for (const auto& row : probe) {
+        const int k = std::get<int32_t>(row[0]);
+        const int dd = std::get<int32_t>(row[1]);
+        if (k < 30000 && dd < 5) expected.push_back({dd + 1, k * 2, row[2]});
+    }
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(run(plan) == expected);
+}
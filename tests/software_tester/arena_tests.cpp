@@ -0,0 +1,83 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "arena.h"
+#include "columnar.h"
+#include "parallel_unchained_hashtable.h"
+#include "thread_pool.h"
+
+using namespace Contest;
+
+// ============================================================================
+// ARENA TESTS
+// ============================================================================
+
+TEST_CASE("Arena: aligned blocks from huge-page chunks", "[arena]") {
+    Arena arena;
+    std::vector<char*> blocks;
+    for (size_t i = 1; i < 2000; i += 7) {
+        auto* p = static_cast<char*>(arena.allocate(i));
+        REQUIRE(reinterpret_cast<uintptr_t>(p) % Arena::kAlign == 0);
+        std::memset(p, 0x5a, i);
+        blocks.push_back(p);
+    }
+    for (size_t b = 1; b < blocks.size(); ++b) REQUIRE(blocks[b] != blocks[b - 1]);
+    REQUIRE(arena.bytes_mapped() == Arena::kChunkBytes);
+
+    // Large blocks get their own mapping and are unmapped on free
+    void* large = arena.allocate(3 * Arena::kLargeBytes);
+    REQUIRE(reinterpret_cast<uintptr_t>(large) % Arena::kHugePage == 0);
+    REQUIRE(arena.bytes_mapped() == Arena::kChunkBytes + 2 * Arena::kHugePage);
+    arena.deallocate(large, 3 * Arena::kLargeBytes);
+    REQUIRE(arena.bytes_mapped() == Arena::kChunkBytes);
+
+    arena.release();
+    REQUIRE(arena.bytes_mapped() == 0);
+}
+
+TEST_CASE("Arena: concurrent allocations never overlap", "[arena]") {
+    Arena arena;
+    ThreadPool pool(4);
+    constexpr size_t kPerTask = 4000;
+    std::vector<std::vector<uint64_t*>> blocks(8);
+    pool.run(8, [&](size_t t) {
+        for (size_t i = 0; i < kPerTask; ++i) {
+            auto* p = static_cast<uint64_t*>(arena.allocate(8 * sizeof(uint64_t)));
+            for (size_t k = 0; k < 8; ++k) p[k] = t * kPerTask + i;
+            blocks[t].push_back(p);
+        }
+    });
+    for (size_t t = 0; t < blocks.size(); ++t)
+        for (size_t i = 0; i < kPerTask; ++i)
+            for (size_t k = 0; k < 8; ++k) REQUIRE(blocks[t][i][k] == t * kPerTask + i);
+    REQUIRE(arena.bytes_mapped() >= 8 * kPerTask * 64);
+}
+
+TEST_CASE("Arena: containers follow the arena current at construction", "[arena]") {
+    Arena arena;
+    Arena::install(&arena);
+    ValuePage page;
+    page.reserve(1024);
+    for (int i = 0; i < 1000; ++i) page.push_back(value_t::make_i32(i));
+    REQUIRE(page.get_allocator().arena() == &arena);
+    REQUIRE(arena.bytes_mapped() > 0);
+
+    {
+        const Arena::Scope heap(nullptr);                 // E.g. tables kept across queries
+        ValuePage on_heap(16);
+        REQUIRE(on_heap.get_allocator().arena() == nullptr);
+    }
+    REQUIRE(Arena::current() == &arena);
+
+    // A table built in the arena answers like one on the heap
+    std::vector<HashEntry<int32_t>> entries;
+    for (int i = 0; i < 200000; ++i) entries.push_back(HashEntry<int32_t>{i % 50000, static_cast<uint32_t>(i)});
+    FlatUnchainedHashTable<int32_t> table;
+    table.reserve(entries.size());
+    table.build_from_entries(entries, 4);
+    Arena::install(nullptr);
+    const int32_t keys[] = {7, 49999, 50000};
+    REQUIRE(table.count_batch(keys, 3) == 8);
+    REQUIRE(page[999].raw == value_t::make_i32(999).raw);
+}
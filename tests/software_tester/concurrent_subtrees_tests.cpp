@@ -0,0 +1,114 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <plan.h>
+#include <table.h>
+#include "test_helpers.h"
+
+using namespace Contest;
+
+// ============================================================================
+// CONCURRENT SUBTREE TESTS
+// ============================================================================
+
+// a(id, x) JOIN b(k, y) ON x = k  and  c(z, w) JOIN d(k, v) ON z = k, both (id, y) / (w, v)
+struct BushyInputs {
+    Plan plan;
+    size_t ab = 0, cd = 0, c_scan = 0;
+
+    BushyInputs() {
+        std::vector<std::vector<Data>> a, b, c, d;
+        for (int i = 0; i < 20000; ++i) a.push_back({i, i % 1000});
+        for (int k = 0; k < 1000; ++k) b.push_back({k, k * 3});
+        for (int i = 0; i < 5000; ++i) c.push_back({i % 2000, i});
+        for (int k = 0; k < 2000; ++k) d.push_back({k, 5000 + k});
+        const size_t ta = add_table(plan, a, {DataType::INT32, DataType::INT32});
+        const size_t tb = add_table(plan, b, {DataType::INT32, DataType::INT32});
+        const size_t tc = add_table(plan, c, {DataType::INT32, DataType::INT32});
+        const size_t td = add_table(plan, d, {DataType::INT32, DataType::INT32});
+        const auto both = std::vector<std::tuple<size_t, DataType>>{{0, DataType::INT32}, {1, DataType::INT32}};
+        const size_t sa = plan.new_scan_node(ta, both);
+        const size_t sb = plan.new_scan_node(tb, both);
+        const size_t sc = plan.new_scan_node(tc, both);
+        const size_t sd = plan.new_scan_node(td, both);
+        ab = plan.new_join_node(false, sa, sb, 1, 0, {{0, DataType::INT32}, {3, DataType::INT32}});
+        cd = plan.new_join_node(false, sc, sd, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}});
+        c_scan = plan.new_scan_node(tc, both);
+    }
+};
+
+// Every c row w finds a row id = w: (id, y, v) = (w, (w % 1000) * 3, 5000 + w % 2000)
+static std::vector<std::vector<Data>> bushy_expected() {
+    std::vector<std::vector<Data>> rows;
+    for (int w = 0; w < 5000; ++w) rows.push_back({w, (w % 1000) * 3, 5000 + w % 2000});
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+TEST_CASE("ConcurrentSubtrees: bushy joins return the serial result", "[concurrent][execute]") {
+    // A pipeline of two stages whose build sides (a join and a scan) are built side by side
+    const auto expected = bushy_expected();
+    for (bool build_left : {true, false}) {
+        BushyInputs in;
+        in.plan.root = in.plan.new_join_node(build_left, in.ab, in.cd, 0, 0,
+                                             {{0, DataType::INT32}, {1, DataType::INT32}, {3, DataType::INT32}});
+        REQUIRE(run(in.plan) == expected);
+    }
+}
+
+TEST_CASE("ConcurrentSubtrees: the build table is built beside the probe subtree", "[concurrent][execute]") {
+    // (ab) JOIN c ON id = w: the table over (ab) is built while the scan of c runs
+    BushyInputs in;
+    in.plan.root = in.plan.new_join_node(true, in.ab, in.c_scan, 0, 1,
+                                         {{0, DataType::INT32}, {1, DataType::INT32}, {2, DataType::INT32}});
+    std::vector<std::vector<Data>> expected;
+    for (int w = 0; w < 5000; ++w) expected.push_back({w, (w % 1000) * 3, w % 2000});
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(run(in.plan) == expected);
+}
+
+TEST_CASE("ConcurrentSubtrees: VARCHAR joins run both children side by side", "[concurrent][execute]") {
+    // (p JOIN q ON id) JOIN (r JOIN s ON id) ON name
+    std::vector<std::vector<Data>> p, q, r, s;
+    for (int i = 0; i < 3000; ++i) p.push_back({i, std::string("n") + std::to_string(i % 50)});
+    for (int i = 0; i < 3000; ++i) q.push_back({i, i});
+    for (int i = 0; i < 40; ++i) r.push_back({i, std::string("n") + std::to_string(i)});
+    for (int i = 0; i < 40; ++i) s.push_back({i, 5000 + i});
+
+    Plan plan;
+    const size_t tp = add_table(plan, p, {DataType::INT32, DataType::VARCHAR});
+    const size_t tq = add_table(plan, q, {DataType::INT32, DataType::INT32});
+    const size_t tr = add_table(plan, r, {DataType::INT32, DataType::VARCHAR});
+    const size_t ts = add_table(plan, s, {DataType::INT32, DataType::INT32});
+    const size_t sp = plan.new_scan_node(tp, {{0, DataType::INT32}, {1, DataType::VARCHAR}});
+    const size_t sq = plan.new_scan_node(tq, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t sr = plan.new_scan_node(tr, {{0, DataType::INT32}, {1, DataType::VARCHAR}});
+    const size_t ss = plan.new_scan_node(ts, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t pq = plan.new_join_node(true, sp, sq, 0, 0, {{1, DataType::VARCHAR}, {3, DataType::INT32}});
+    const size_t rs = plan.new_join_node(true, sr, ss, 0, 0, {{1, DataType::VARCHAR}, {3, DataType::INT32}});
+    plan.root = plan.new_join_node(false, pq, rs, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}});
+
+    std::vector<std::vector<Data>> expected;
+    for (int i = 0; i < 3000; ++i)
+        if (i % 50 < 40) expected.push_back({i, 5000 + i % 50});
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(run(plan) == expected);
+}
+
+TEST_CASE("ConcurrentSubtrees: errors of a subtree reach the caller", "[concurrent][execute]") {
+    // The probe subtree joins on FP64 keys, which is rejected while the other side runs
+    std::vector<std::vector<Data>> f, g;
+    for (int i = 0; i < 100; ++i) f.push_back({i, static_cast<double>(i)});
+    for (int i = 0; i < 100; ++i) g.push_back({i, static_cast<double>(i)});
+
+    Plan plan;
+    const size_t tf = add_table(plan, f, {DataType::INT32, DataType::FP64});
+    const size_t tg = add_table(plan, g, {DataType::INT32, DataType::FP64});
+    const size_t sf = plan.new_scan_node(tf, {{0, DataType::INT32}, {1, DataType::FP64}});
+    const size_t sg = plan.new_scan_node(tg, {{0, DataType::INT32}, {1, DataType::FP64}});
+    const size_t sf2 = plan.new_scan_node(tf, {{0, DataType::INT32}, {1, DataType::FP64}});
+    const size_t fg = plan.new_join_node(true, sf, sg, 1, 1, {{0, DataType::INT32}});
+    plan.root = plan.new_join_node(true, sf2, fg, 0, 0, {{0, DataType::INT32}});
+    REQUIRE_THROWS(run(plan));
+}
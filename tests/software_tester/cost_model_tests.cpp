@@ -0,0 +1,93 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "cost_model.h"
+#include "thread_pool.h"
+
+using namespace Contest;
+
+// Profiles are text with 6 significant digits
+static bool close_enough(double a, double b) { return std::abs(a - b) <= 1e-5 * std::abs(b); }
+
+// ============================================================================
+// COST MODEL TESTS
+// ============================================================================
+
+TEST_CASE("CostModel: threads grow with the work and stay within bounds", "[cost-model]") {
+    CostModel model;
+    model.wakeup_ns = 10000;
+
+    REQUIRE(model.threads_for(0, 5, 16) == 1);
+    REQUIRE(model.threads_for(100, 5, 16) == 1);              // 500ns of work: never worth a wake-up
+    REQUIRE(model.threads_for(1u << 30, 5, 16) == 16);        // Capped by the pool
+    REQUIRE(model.threads_for(1u << 30, 5, 1) == 1);
+
+    size_t prev = 1;
+    for (size_t items = 1000; items < (1u << 26); items *= 2) {
+        const size_t t = model.threads_for(items, 5, 64);
+        REQUIRE(t >= prev);
+        prev = t;
+    }
+
+    // Slower probes (DRAM-resident tables) parallelize earlier than cache-resident ones
+    REQUIRE(model.threads_for(20000, model.probe_dram_ns, 64) >= model.threads_for(20000, model.probe_cache_ns, 64));
+    REQUIRE(model.probe_ns(1) == model.probe_cache_ns);
+    REQUIRE(model.probe_ns(size_t{1} << 40) == model.probe_dram_ns);
+}
+
+TEST_CASE("CostModel: morsel sizes are clamped", "[cost-model]") {
+    const CostModel model;
+    REQUIRE(model.morsel_rows(1e9) == CostModel::kMinMorselRows);
+    REQUIRE(model.morsel_rows(0) == CostModel::kMaxMorselRows);
+    const size_t mid = model.morsel_rows(10);
+    REQUIRE(mid >= CostModel::kMinMorselRows);
+    REQUIRE(mid <= CostModel::kMaxMorselRows);
+    REQUIRE(model.morsel_rows(20) <= mid);
+}
+
+TEST_CASE("CostModel: profiles round-trip and calibration measures positive costs", "[cost-model]") {
+    ThreadPool pool(2);
+    const CostModel measured = CostModel::calibrate(pool);
+    REQUIRE(measured.wakeup_ns > 0);
+    REQUIRE(measured.probe_cache_ns > 0);
+    REQUIRE(measured.probe_dram_ns >= measured.probe_cache_ns);
+    REQUIRE(measured.cell_ns > 0);
+
+    const std::string path = "/tmp/cost_model_test.profile";
+    REQUIRE(measured.save(path));
+    CostModel loaded;
+    REQUIRE(loaded.load(path));
+    REQUIRE(close_enough(loaded.wakeup_ns, measured.wakeup_ns));
+    REQUIRE(close_enough(loaded.probe_dram_ns, measured.probe_dram_ns));
+    REQUIRE(close_enough(loaded.cell_ns, measured.cell_ns));
+    std::remove(path.c_str());
+
+    CostModel missing;
+    REQUIRE_FALSE(missing.load("/nonexistent/cost.profile"));
+    REQUIRE(missing.wakeup_ns == CostModel::defaults().wakeup_ns);
+
+    // Installed models are what operators see; nullptr goes back to the defaults
+    CostModel::install(&loaded);
+    REQUIRE(&CostModel::current() == &loaded);
+    CostModel::install(nullptr);
+    REQUIRE(CostModel::current().wakeup_ns == CostModel::defaults().wakeup_ns);
+}
+
+TEST_CASE("CostModel: the profile is kept per pool size unless COST_PROFILE names it", "[cost-model]") {
+    const char* previous = std::getenv("COST_PROFILE");
+    const std::string saved = previous ? previous : "";
+
+    unsetenv("COST_PROFILE");
+    const std::string four = CostModel::profile_path(4);
+    REQUIRE(four.size() > std::string("join_cost_profile_4t").size());
+    REQUIRE(four.compare(four.size() - 20, 20, "join_cost_profile_4t") == 0);
+    REQUIRE(CostModel::profile_path(8) != four);
+
+    setenv("COST_PROFILE", "/tmp/cost_model_named.profile", 1);
+    REQUIRE(CostModel::profile_path(4) == "/tmp/cost_model_named.profile");
+
+    if (previous) setenv("COST_PROFILE", saved.c_str(), 1);
+    else unsetenv("COST_PROFILE");
+}
@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <table.h>
+#include "dense_array_table.h"
+
+using namespace Contest;
+
+// ============================================================================
+// ARRAY JOIN TESTS
+// ============================================================================
+
+// Sorted row ids of the entries probe() returns for key
+static std::vector<uint32_t> rows_of(const DenseArrayTable& table, int32_t key) {
+    size_t len = 0;
+    const auto* group = table.probe(key, len);
+    std::vector<uint32_t> rows;
+    for (size_t k = 0; k < len; ++k) {
+        REQUIRE(group[k].key == key);
+        rows.push_back(group[k].row_id);
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+TEST_CASE("DenseArrayTable: only dense key ranges qualify", "[dense][fits]") {
+    REQUIRE(dense_array_fits(1, 1000, 1000));
+    REQUIRE(dense_array_fits(-10, 3989, 1000));             // Range 4000 = 4 slots per row
+    REQUIRE_FALSE(dense_array_fits(-10, 3990, 1000));
+    REQUIRE_FALSE(dense_array_fits(INT32_MIN, INT32_MAX, 1u << 31));
+    REQUIRE_FALSE(dense_array_fits(5, 5, 0));
+}
+
+TEST_CASE("DenseArrayTable: unique keys map straight to their row", "[dense][unique]") {
+    // Permuted primary key with gaps, enough rows for several build morsels
+    std::vector<HashEntry<int32_t>> entries;
+    for (uint32_t i = 0; i < 200000; ++i) entries.push_back({static_cast<int32_t>((i * 7919u) % 300000) - 50, i});
+
+    DenseArrayTable table(-50, 299949);
+    table.build_from_entries(entries);
+    REQUIRE(table.unique());
+
+    for (uint32_t i = 0; i < 200000; i += 997) REQUIRE(rows_of(table, entries[i].key) == std::vector<uint32_t>{i});
+
+    // Gaps and keys outside [min, max] miss
+    std::vector<uint8_t> used(300000, 0);
+    for (const auto& e : entries) used[e.key + 50] = 1;
+    const int32_t gap = static_cast<int32_t>(std::find(used.begin(), used.end(), 0) - used.begin()) - 50;
+    REQUIRE(rows_of(table, gap).empty());
+    REQUIRE(rows_of(table, -51).empty());
+    REQUIRE(rows_of(table, 299950).empty());
+    REQUIRE(rows_of(table, INT32_MIN).empty());
+    REQUIRE(rows_of(table, INT32_MAX).empty());
+}
+
+TEST_CASE("DenseArrayTable: duplicate keys are grouped", "[dense][duplicates]") {
+    std::vector<HashEntry<int32_t>> entries;
+    for (uint32_t i = 0; i < 30000; ++i) entries.push_back({static_cast<int32_t>(i % 10000), i});
+    entries.push_back({20000, 30000});
+
+    DenseArrayTable table(0, 20000);
+    table.build_from_entries(entries);
+    REQUIRE_FALSE(table.unique());
+
+    REQUIRE(rows_of(table, 17) == std::vector<uint32_t>{17, 10017, 20017});
+    REQUIRE(rows_of(table, 20000) == std::vector<uint32_t>{30000});
+    REQUIRE(rows_of(table, 15000).empty());
+
+    std::vector<int32_t> keys{17, 15000, 20000, -1};
+    std::vector<ProbeMatch> matches;
+    table.probe_batch(keys.data(), keys.size(), matches);
+    REQUIRE(matches.size() == 4);
+    REQUIRE(table.count_batch(keys.data(), keys.size()) == 4);
+    for (const auto& m : matches) REQUIRE(entries[m.build_row].key == keys[m.probe_idx]);
+}
+
+TEST_CASE("DenseArrayTable: build from zero-copy INT32 pages", "[dense][zero-copy]") {
+    std::vector<std::vector<Data>> rows;
+    for (int32_t i = 0; i < 5000; ++i) rows.push_back({5000 - i});
+    ColumnarTable input = Table(rows, {DataType::INT32}).to_columnar();
+    const Column& column = input.columns[0];
+
+    std::vector<size_t> page_offsets{0};
+    for (const auto& page : column.pages)
+        page_offsets.push_back(page_offsets.back() + *reinterpret_cast<const uint16_t*>(page->data));
+    REQUIRE(page_offsets.size() > 2);                       // Several pages
+
+    DenseArrayTable table(1, 5000);
+    REQUIRE(table.build_from_zero_copy_int32(&column, page_offsets, 5000));
+    REQUIRE(table.unique());
+    for (int32_t key = 1; key <= 5000; key += 123)
+        REQUIRE(rows_of(table, key) == std::vector<uint32_t>{static_cast<uint32_t>(5000 - key)});
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+#include <sys/resource.h>
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include <plan.h>
+#include <table.h>
+#include "test_helpers.h"
+#include "spill.h"
+
+using namespace Contest;
+
+// ============================================================================
+// GRACE HASH JOIN TESTS
+// ============================================================================
+
+TEST_CASE("Spill: page pairs round-trip in the INT32 page format", "[grace][spill]") {
+    SpillFile file(4);
+    std::vector<int32_t> keys(kSpillRowsPerPage);
+    std::vector<uint32_t> rows(kSpillRowsPerPage);
+    for (size_t i = 0; i < kSpillRowsPerPage; ++i) {
+        keys[i] = static_cast<int32_t>(i) - 1000;
+        rows[i] = static_cast<uint32_t>(i * 3);
+    }
+    file.append(2, keys.data(), rows.data(), kSpillRowsPerPage);
+    file.append(2, keys.data(), rows.data(), 13);
+    file.append(0, keys.data() + 5, rows.data() + 5, 1);
+
+    REQUIRE(file.num_pages(1) == 0);
+    REQUIRE(file.num_pages(2) == 2);
+    REQUIRE(file.num_rows(2) == kSpillRowsPerPage + 13);
+    REQUIRE(file.page_rows(2, 1) == 13);
+    REQUIRE(file.bytes_written() == 6 * PAGE_SIZE);
+
+    std::vector<int32_t> k(kSpillRowsPerPage);
+    std::vector<uint32_t> r(kSpillRowsPerPage);
+    REQUIRE(file.read_page(2, 0, k.data(), r.data()) == kSpillRowsPerPage);
+    REQUIRE(k == keys);
+    REQUIRE(r == rows);
+    REQUIRE(file.read_page(2, 1, k.data(), r.data()) == 13);
+    REQUIRE(k[12] == keys[12]);
+    REQUIRE(file.read_page(0, 0, k.data(), r.data()) == 1);
+    REQUIRE(k[0] == keys[5]);
+    REQUIRE(r[0] == rows[5]);
+
+    // Same layout as ColumnInserter<int32_t>: rows, values, data at +4, validity at the end
+    Page page;
+    write_int32_page(page, keys.data(), 10);
+    REQUIRE(*reinterpret_cast<uint16_t*>(page.data) == 10);
+    REQUIRE(*reinterpret_cast<uint16_t*>(page.data + 2) == 10);
+    REQUIRE(reinterpret_cast<int32_t*>(page.data + 4)[9] == keys[9]);
+    REQUIRE(static_cast<uint8_t>(page.data[PAGE_SIZE - 2]) == 0xff);
+    REQUIRE(static_cast<uint8_t>(page.data[PAGE_SIZE - 1]) == 0x03);
+}
+
+TEST_CASE("Spill: partitions only beyond the budget", "[grace]") {
+    if (!std::getenv("GRACE_JOIN")) {                               // Not forced on/off
+        REQUIRE(choose_grace_partitions(1000, 0) == 0);              // Unlimited
+        REQUIRE(choose_grace_partitions(1000, 1u << 20) == 0);       // Fits
+    }
+    const size_t parts = choose_grace_partitions(1u << 20, 1u << 20);
+    REQUIRE(parts >= 2);
+    REQUIRE((parts & (parts - 1)) == 0);
+    REQUIRE(parts * (1u << 19) >= (1u << 20) * kGraceBytesPerBuildRow);
+    REQUIRE(choose_grace_partitions(size_t{1} << 34, 1024) == kGraceMaxPartitions);
+
+    std::vector<size_t> hits(8, 0);
+    for (int32_t k = 0; k < 80000; ++k) ++hits[grace_partition_of(k, 8)];
+    for (size_t h : hits) REQUIRE(h > 8000);                         // Sequential keys spread
+}
+
+static std::vector<std::vector<Data>> run_join(size_t budget_mb, bool build_left) {
+    // fact(id % 5000, i) JOIN dim(id, id * 2) with duplicate and NULL keys on both sides
+    std::vector<std::vector<Data>> fact, dim;
+    for (int i = 0; i < 120000; ++i) {
+        if (i % 997 == 0) fact.push_back({std::monostate{}, i});
+        else fact.push_back({i % 5000, i});
+    }
+    for (int d = 0; d < 60000; ++d) dim.push_back({d % 30000, d * 2});
+    dim.push_back({std::monostate{}, -1});
+
+    const std::string mb = std::to_string(budget_mb);
+    setenv("JOIN_MEMORY_MB", mb.c_str(), 1);
+    const ContextGuard context;
+    unsetenv("JOIN_MEMORY_MB");
+
+    Plan plan;
+    const size_t tf = plan.new_input(Table(fact, {DataType::INT32, DataType::INT32}).to_columnar());
+    const size_t td = plan.new_input(Table(dim, {DataType::INT32, DataType::INT32}).to_columnar());
+    const size_t f = plan.new_scan_node(tf, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t d = plan.new_scan_node(td, {{0, DataType::INT32}, {1, DataType::INT32}});
+    plan.root = plan.new_join_node(build_left, d, f, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}});
+    auto rows = Table::from_columnar(execute(plan, context.get())).table();
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+TEST_CASE("GraceJoin: spilled joins return the in-memory result", "[grace][execute]") {
+    for (bool build_left : {true, false}) {
+        const auto in_memory = run_join(0, build_left);
+        REQUIRE(in_memory.size() == (120000 - 121) * 2);             // Every non-NULL fact row, twice
+        REQUIRE(run_join(1, build_left) == in_memory);               // 60000 build rows > 1 MB
+    }
+}
+
+TEST_CASE("GraceJoin: spill I/O errors reach execute()", "[grace][execute]") {
+    // No spill file at all
+    setenv("SPILL_DIR", "/nonexistent/spill/dir", 1);
+    REQUIRE_THROWS_AS(run_join(1, true), std::runtime_error);
+    unsetenv("SPILL_DIR");
+
+    // Writes beyond a few page pairs fail with EFBIG on the pool's threads (disk full)
+    rlimit saved{};
+    getrlimit(RLIMIT_FSIZE, &saved);
+    const auto saved_handler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limited = saved;
+    limited.rlim_cur = 8 * 2 * PAGE_SIZE;
+    setrlimit(RLIMIT_FSIZE, &limited);
+    const auto restore = [&] {
+        setrlimit(RLIMIT_FSIZE, &saved);
+        std::signal(SIGXFSZ, saved_handler);
+    };
+    try {
+        run_join(1, true);
+        restore();
+        FAIL("the spilled join did not fail");
+    } catch (const std::runtime_error&) {
+        restore();
+    }
+
+    REQUIRE(run_join(1, true).size() == (120000 - 121) * 2);       // The executor still works
+}
+
+// small(id, id * 3) JOIN (big(id, id + 7) JOIN (tiny(id * 3, id) JOIN fact ON x) ON b) ON x:
+// a left-deep chain whose middle build side (60000 rows) is beyond a 1 MB budget
+static Plan chain_with_large_build() {
+    std::vector<std::vector<Data>> fact, small, big, tiny;
+    for (int i = 0; i < 150000; ++i) fact.push_back({(i % 100) * 3, i % 70000, i});
+    for (int id = 0; id < 100; ++id) small.push_back({id, id * 3});
+    for (int id = 0; id < 60000; ++id) big.push_back({id, id + 7});
+    for (int id = 0; id < 100; ++id) tiny.push_back({id * 3, id});
+
+    Plan plan;
+    const std::vector<DataType> two = {DataType::INT32, DataType::INT32};
+    const size_t f = plan.new_scan_node(add_table(plan, fact, {DataType::INT32, DataType::INT32, DataType::INT32}),
+                                        {{0, DataType::INT32}, {1, DataType::INT32}, {2, DataType::INT32}});
+    const size_t t = plan.new_scan_node(add_table(plan, tiny, two), {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t b = plan.new_scan_node(add_table(plan, big, two), {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t s = plan.new_scan_node(add_table(plan, small, two), {{0, DataType::INT32}, {1, DataType::INT32}});
+    // (tiny.id, fact.x, fact.b, fact.i) -> (big.y, tiny.id, fact.x, fact.i) -> (small.id, big.y, fact.i)
+    const size_t j1 = plan.new_join_node(true, t, f, 0, 0,
+                                         {{1, DataType::INT32}, {2, DataType::INT32}, {3, DataType::INT32}, {4, DataType::INT32}});
+    const size_t j2 = plan.new_join_node(true, b, j1, 0, 2,
+                                         {{1, DataType::INT32}, {2, DataType::INT32}, {3, DataType::INT32}, {5, DataType::INT32}});
+    plan.root = plan.new_join_node(true, s, j2, 1, 2, {{0, DataType::INT32}, {2, DataType::INT32}, {5, DataType::INT32}});
+    return plan;
+}
+
+TEST_CASE("GraceJoin: a pipelined chain spills the stage beyond the budget", "[grace][pipeline]") {
+    std::vector<std::vector<Data>> expected;
+    for (int i = 0; i < 150000; ++i)
+        if (i % 70000 < 60000) expected.push_back({i % 100, i % 70000 + 7, i});
+    std::sort(expected.begin(), expected.end());
+
+    const Plan plan = chain_with_large_build();
+    setenv("JOIN_MEMORY_MB", "1", 1);
+    setenv("SPILL_DIR", "/nonexistent/spill/dir", 1);            // Only a spilled join fails
+    REQUIRE_THROWS_AS(run(plan), std::runtime_error);
+    unsetenv("SPILL_DIR");
+    const auto spilled = run(plan);
+    unsetenv("JOIN_MEMORY_MB");
+
+    REQUIRE(spilled == expected);
+    REQUIRE(run(plan) == expected);                               // In memory, pipelined
+}
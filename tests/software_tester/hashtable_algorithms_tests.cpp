@@ -2,12 +2,14 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <algorithm>
 #include "hashtable_interface.h"
 #include "hash_common.h"
 
-// Only include the default unchained wrapper to avoid redefinition errors
-// Each wrapper redefines create_hashtable(), so we test them individually
-#include "unchained_hashtable_wrapper.h"
+#include "hashtable_backend.h"
+#include "thread_pool.h"
+#include <plan.h>
+#include <table.h>
 
 // ============================================================================
 // HASH TABLE IMPLEMENTATION TESTS
@@ -102,9 +104,150 @@ TEST_CASE("UnchainedHashTable: missing key", "[hashtable][unchained]") {
     REQUIRE((result == nullptr || len == 0));
 }
 
-// Tests for Robin Hood, Cuckoo, and Hopscotch are disabled to avoid
-// redefinition errors (each wrapper redefines create_hashtable()).
-// They can be tested by changing #include in execute_default.cpp
+// Tests for Robin Hood, Cuckoo, and Hopscotch (through create_hashtable)
+static const Contest::HashTableBackend kOpenAddressingBackends[] = {
+    Contest::HashTableBackend::RobinHood, Contest::HashTableBackend::Cuckoo, Contest::HashTableBackend::Hopscotch};
+
+// Row ids of key in table, sorted
+static std::vector<uint32_t> rows_of(const Contest::IHashTable<int32_t>& table, int32_t key) {
+    size_t len = 0;
+    const auto* bucket = table.probe(key, len);
+    std::vector<uint32_t> rows;
+    for (size_t k = 0; k < len; ++k) {
+        REQUIRE(bucket[k].key == key);
+        rows.push_back(bucket[k].row_id);
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+TEST_CASE("OpenAddressingHashTables: duplicates and misses", "[hashtable][robinhood][cuckoo][hopscotch]") {
+    std::vector<Contest::HashEntry<int32_t>> entries = {{42, 2}, {10, 0}, {42, 1}, {-7, 4}, {42, 0}, {100, 3}};
+    for (auto backend : kOpenAddressingBackends) {
+        INFO(Contest::hashtable_backend_name(backend));
+        auto table = Contest::create_hashtable<int32_t>(backend);
+        table->reserve(entries.size());
+        table->build_from_entries(entries);
+
+        REQUIRE(rows_of(*table, 42) == std::vector<uint32_t>{0, 1, 2});
+        REQUIRE(rows_of(*table, 10) == std::vector<uint32_t>{0});
+        REQUIRE(rows_of(*table, -7) == std::vector<uint32_t>{4});
+        REQUIRE(rows_of(*table, 999).empty());
+        REQUIRE(table->memory_usage() > 0);
+
+        auto empty = Contest::create_hashtable<int32_t>(backend);
+        empty->build_from_entries({});
+        REQUIRE(rows_of(*empty, 42).empty());
+    }
+}
+
+TEST_CASE("OpenAddressingHashTables: parallel partitioned build", "[hashtable][robinhood][cuckoo][hopscotch][parallel]") {
+    // 3 rows per key, enough rows for several partitions per thread
+    const int keys = 60000;
+    std::vector<Contest::HashEntry<int32_t>> entries;
+    for (int i = 0; i < keys * 3; ++i) entries.push_back({(i * 7919) % keys - 100, static_cast<uint32_t>(i)});
+    std::vector<std::vector<uint32_t>> expected(keys);
+    for (const auto& e : entries) expected[e.key + 100].push_back(e.row_id);
+
+    const auto groups = Contest::group_keys<int32_t>(entries);
+    REQUIRE(groups.num_partitions() > 1);
+    REQUIRE(groups.infos.size() == static_cast<size_t>(keys));
+
+    Contest::ThreadPool pool(4);
+    Contest::ThreadPool::install(&pool);
+    for (auto backend : kOpenAddressingBackends) {
+        INFO(Contest::hashtable_backend_name(backend));
+        auto table = Contest::create_hashtable<int32_t>(backend);
+        table->build_from_entries(entries);
+
+        std::vector<int32_t> probe_keys;
+        for (int32_t k = -150; k < keys; k += 3) probe_keys.push_back(k);
+        for (int32_t k : probe_keys) {
+            const std::vector<uint32_t> want = k >= -100 && k < keys - 100 ? expected[k + 100] : std::vector<uint32_t>{};
+            REQUIRE(rows_of(*table, k) == want);
+        }
+
+        // Default batched probe agrees with the single probes
+        std::vector<Contest::ProbeMatch> batched;
+        table->probe_batch(probe_keys.data(), probe_keys.size(), batched);
+        REQUIRE(table->count_batch(probe_keys.data(), probe_keys.size()) == batched.size());
+        size_t want_matches = 0;
+        for (int32_t k : probe_keys) want_matches += k >= -100 && k < keys - 100 ? 3 : 0;
+        REQUIRE(batched.size() == want_matches);
+    }
+    Contest::ThreadPool::install(nullptr);
+}
+
+TEST_CASE("OpenAddressingHashTables: zero-copy build reads the pages", "[hashtable][robinhood][cuckoo][hopscotch][zerocopy]") {
+    // Single INT32 column without NULLs spanning several pages
+    std::vector<std::vector<Data>> rows;
+    for (int i = 0; i < 40000; ++i) rows.push_back({(i * 31) % 9000});
+    ColumnarTable columnar = Table(rows, {DataType::INT32}).to_columnar();
+    const Column& column = columnar.columns[0];
+    REQUIRE(column.pages.size() > 1);
+
+    std::vector<size_t> page_offsets{0};
+    for (const auto& page : column.pages)
+        page_offsets.push_back(page_offsets.back() + *reinterpret_cast<const uint16_t*>(page->data));
+    REQUIRE(page_offsets.back() == rows.size());
+
+    for (auto backend : kOpenAddressingBackends) {
+        INFO(Contest::hashtable_backend_name(backend));
+        auto table = Contest::create_hashtable<int32_t>(backend);
+        REQUIRE_FALSE(table->build_from_zero_copy_int32(&column, page_offsets, 0));
+        REQUIRE(table->build_from_zero_copy_int32(&column, page_offsets, rows.size()));
+        for (int32_t k = 0; k < 9000; k += 97) {
+            std::vector<uint32_t> want;
+            for (uint32_t i = 0; i < rows.size(); ++i)
+                if (std::get<int32_t>(rows[i][0]) == k) want.push_back(i);
+            REQUIRE(rows_of(*table, k) == want);
+        }
+        REQUIRE(rows_of(*table, 9001).empty());
+    }
+}
+
+TEST_CASE("HashTableBackend: names and runtime selection", "[hashtable][backend]") {
+    using Contest::HashTableBackend;
+    for (auto b : {HashTableBackend::Unchained, HashTableBackend::RobinHood, HashTableBackend::Cuckoo,
+                   HashTableBackend::Hopscotch})
+        REQUIRE(Contest::parse_hashtable_backend(Contest::hashtable_backend_name(b)) == b);
+    REQUIRE_FALSE(Contest::parse_hashtable_backend("chained").has_value());
+
+    // dim(k, v) joined with fact(k, i) must not depend on the backend; the keys are too
+    // sparse for the array join
+    std::vector<std::vector<Data>> dim, fact, expected;
+    for (int k = 0; k < 3000; ++k) dim.push_back({k * 7, k});
+    for (int k = 0; k < 500; ++k) dim.push_back({k * 7, 5000 + k});          // Duplicate build keys
+    for (int i = 0; i < 40000; ++i) fact.push_back({i % 25000, i});
+    for (int i = 0; i < 40000; ++i) {
+        const int key = i % 25000;
+        if (key % 7 || key / 7 >= 3000) continue;
+        expected.push_back({key / 7, i});
+        if (key / 7 < 500) expected.push_back({5000 + key / 7, i});
+    }
+    std::sort(expected.begin(), expected.end());
+
+    const HashTableBackend saved = Contest::hashtable_backend();
+    void* context = Contest::build_context();
+    for (auto b : {HashTableBackend::Unchained, HashTableBackend::RobinHood, HashTableBackend::Cuckoo,
+                   HashTableBackend::Hopscotch}) {
+        INFO(Contest::hashtable_backend_name(b));
+        Contest::set_hashtable_backend(b);
+        REQUIRE(Contest::hashtable_backend() == b);
+
+        Plan plan;
+        const size_t td = plan.new_input(Table(dim, {DataType::INT32, DataType::INT32}).to_columnar());
+        const size_t tf = plan.new_input(Table(fact, {DataType::INT32, DataType::INT32}).to_columnar());
+        const size_t d = plan.new_scan_node(td, {{0, DataType::INT32}, {1, DataType::INT32}});
+        const size_t f = plan.new_scan_node(tf, {{0, DataType::INT32}, {1, DataType::INT32}});
+        plan.root = plan.new_join_node(true, d, f, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}});
+        auto result = Table::from_columnar(Contest::execute(plan, context)).table();
+        std::sort(result.begin(), result.end());
+        REQUIRE(result == expected);
+    }
+    Contest::destroy_context(context);
+    Contest::set_hashtable_backend(saved);
+}
 
 TEST_CASE("HashTable: load factor stress test", "[hashtable][stress]") {
     auto unchained = std::make_unique<Contest::UnchainedHashTableWrapper<int32_t>>();
@@ -124,3 +267,144 @@ TEST_CASE("HashTable: load factor stress test", "[hashtable][stress]") {
         REQUIRE(result != nullptr);
     }
 }
+
+TEST_CASE("UnchainedHashTable: parallel build matches serial build", "[hashtable][unchained][parallel]") {
+    std::vector<Contest::HashEntry<int32_t>> entries;
+    for (int i = 0; i < 200000; ++i) {
+        entries.push_back({(i * 7919) % 50000, static_cast<uint32_t>(i)}); // 4 rows per key
+    }
+
+    Contest::UnchainedHashTable<int32_t> serial, parallel;
+    serial.reserve(entries.size());
+    parallel.reserve(entries.size());
+    serial.build_from_entries(entries, 1);
+    parallel.build_from_entries(entries, 4);
+
+    REQUIRE(parallel.size() == serial.size());
+    for (int key = -10; key < 50010; key += 3) {
+        size_t slen = 0, plen = 0;
+        auto* s = serial.probe(key, slen);
+        auto* p = parallel.probe(key, plen);
+        REQUIRE(slen == plen);  // Same bucket sizes and bloom tags
+
+        std::vector<uint32_t> srows, prows;
+        for (size_t k = 0; k < slen; ++k) if (s[k].key == key) srows.push_back(s[k].row_id);
+        for (size_t k = 0; k < plen; ++k) if (p[k].key == key) prows.push_back(p[k].row_id);
+        std::sort(srows.begin(), srows.end());
+        std::sort(prows.begin(), prows.end());
+        REQUIRE(srows == prows);
+    }
+}
+
+TEST_CASE("UnchainedHashTable: batched probe matches single probes", "[hashtable][unchained][batch]") {
+    auto table = std::make_unique<Contest::UnchainedHashTableWrapper<int32_t>>();
+
+    std::vector<Contest::HashEntry<int32_t>> entries;
+    for (uint32_t i = 0; i < 50000; ++i) entries.push_back({static_cast<int32_t>(i % 20000), i}); // Duplicates
+    table->reserve(entries.size());
+    table->build_from_entries(entries);
+
+    // Hits, misses and a batch size that is not a multiple of the prefetch group
+    std::vector<int32_t> keys;
+    for (int32_t k = -500; k < 25000; k += 7) keys.push_back(k);
+
+    std::vector<Contest::ProbeMatch> batched;
+    table->probe_batch(keys.data(), keys.size(), batched);
+
+    std::vector<std::pair<uint32_t, uint32_t>> expected, got;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        size_t len = 0;
+        const auto* bucket = table->probe(keys[i], len);
+        for (size_t k = 0; k < len; ++k)
+            if (bucket[k].key == keys[i]) expected.emplace_back(static_cast<uint32_t>(i), bucket[k].row_id);
+    }
+    for (const auto& m : batched) got.emplace_back(m.probe_idx, m.build_row);
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(got.begin(), got.end());
+    REQUIRE(!expected.empty());
+    REQUIRE(got == expected);
+    REQUIRE(table->count_batch(keys.data(), keys.size()) == expected.size());
+
+    // Empty batch
+    batched.clear();
+    table->probe_batch(keys.data(), 0, batched);
+    REQUIRE(batched.empty());
+}
+
+TEST_CASE("UnchainedHashTable: bucket match over every bucket length", "[hashtable][unchained][simd]") {
+    using Table = Contest::FlatUnchainedHashTable<int32_t>;
+
+    // Full 8-tuple blocks plus every tail length; key 0 checks that masked lanes never match
+    for (size_t len = 0; len <= 27; ++len) {
+        for (int32_t key : {0, 7, -3}) {
+            std::vector<Table::entry_type> bucket(len + 8, Table::entry_type{key, 999}); // Padding must stay unread
+            std::vector<uint32_t> expected;
+            for (size_t k = 0; k < len; ++k) {
+                const bool hit = (k % 3 == 0) || (k % 8 == 7);
+                bucket[k] = Table::entry_type{hit ? key : key + 1 + static_cast<int32_t>(k), static_cast<uint32_t>(k)};
+                if (hit) expected.push_back(static_cast<uint32_t>(k));
+            }
+
+            std::vector<uint32_t> got;
+            Table::match_bucket(bucket.data(), len, key, [&](uint32_t row) { got.push_back(row); });
+            REQUIRE(got == expected);
+        }
+    }
+}
+
+TEST_CASE("UnchainedHashTable: layout follows the key distribution", "[hashtable][unchained][layout]") {
+    using Contest::BucketLayout;
+
+    // Rows per key -> expected layout
+    const std::vector<std::pair<int, BucketLayout>> cases = {
+        {1, BucketLayout::kUnique}, {2, BucketLayout::kRows}, {5, BucketLayout::kGrouped}};
+
+    for (const auto& [rows_per_key, layout] : cases) {
+        // Reserving 0 keeps the minimum directory: buckets of about 40 tuples, sorted when unique
+        for (auto [threads, reserve] : {std::pair<size_t, bool>{1, true}, {4, true}, {1, false}, {4, false}}) {
+            const int keys = 40000;
+            std::vector<Contest::HashEntry<int32_t>> entries;
+            for (int i = 0; i < keys * rows_per_key; ++i)
+                entries.push_back({(i * 7919) % keys - 100, static_cast<uint32_t>(i)});
+
+            Contest::UnchainedHashTable<int32_t> table;
+            table.reserve(reserve ? entries.size() : 0);
+            table.build_from_entries(entries, threads);
+            REQUIRE(table.layout() == layout);
+            REQUIRE(table.size() == entries.size());
+
+            // probe(), for_each_match() and probe_batch() agree with a reference
+            std::vector<int32_t> probe_keys;
+            for (int k = -150; k < keys; k += 3) probe_keys.push_back(k);
+            std::vector<Contest::ProbeMatch> batched;
+            table.probe_batch(probe_keys.data(), probe_keys.size(), batched);
+
+            // Reference: row ids per key, in increasing order
+            std::vector<std::vector<uint32_t>> rows_of_key(keys);
+            for (const auto& e : entries) rows_of_key[e.key + 100].push_back(e.row_id);
+
+            std::vector<std::pair<uint32_t, uint32_t>> expected, from_probe, from_match, from_batch;
+            for (uint32_t i = 0; i < probe_keys.size(); ++i) {
+                const int32_t key = probe_keys[i];
+                if (key >= -100 && key < keys - 100)
+                    for (uint32_t r : rows_of_key[key + 100]) expected.emplace_back(i, r);
+
+                size_t len = 0;
+                const auto* bucket = table.probe(key, len);
+                for (size_t k = 0; k < len; ++k)
+                    if (bucket[k].key == key) from_probe.emplace_back(i, bucket[k].row_id);
+                table.for_each_match(key, [&](uint32_t row) { from_match.emplace_back(i, row); });
+            }
+            for (const auto& m : batched) from_batch.emplace_back(m.probe_idx, m.build_row);
+
+            std::sort(from_probe.begin(), from_probe.end());
+            std::sort(from_match.begin(), from_match.end());
+            std::sort(from_batch.begin(), from_batch.end());
+            REQUIRE(from_probe == expected);
+            REQUIRE(from_match == expected);
+            REQUIRE(from_batch == expected);
+            REQUIRE(table.count_batch(probe_keys.data(), probe_keys.size()) == expected.size());
+        }
+    }
+}
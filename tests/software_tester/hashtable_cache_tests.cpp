@@ -0,0 +1,116 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <plan.h>
+#include <table.h>
+#include "hashtable_cache.h"
+#include "dense_array_table.h"
+#include "thread_pool.h"
+
+using namespace Contest;
+
+// ============================================================================
+// CROSS-QUERY HASH TABLE CACHE TESTS
+// ============================================================================
+
+// Array table over keys [0, n) (n * 8 bytes of slots)
+static std::shared_ptr<const IHashTable<int32_t>> dense_table(int32_t n) {
+    std::vector<HashEntry<int32_t>> entries;
+    for (int32_t k = 0; k < n; ++k) entries.push_back({k, static_cast<uint32_t>(k)});
+    auto table = std::make_shared<DenseArrayTable>(0, n - 1);
+    table->build_from_entries(entries);
+    return table;
+}
+
+TEST_CASE("HashTableCache: hits return the stored table", "[htcache][find]") {
+    HashTableCache cache(1 << 20);
+    REQUIRE(cache.find("a#0") == nullptr);
+
+    auto table = dense_table(100);
+    cache.insert("a#0", table, 100);
+    const auto hit = cache.find("a#0");
+    REQUIRE(hit != nullptr);
+    REQUIRE(hit->table == table);
+    REQUIRE(hit->build_rows == 100);
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 1);
+}
+
+TEST_CASE("HashTableCache: least recently used tables are evicted first", "[htcache][evict]") {
+    const size_t one = dense_table(1000)->memory_usage();
+    HashTableCache cache(3 * one);
+    cache.insert("a", dense_table(1000), 1000);
+    cache.insert("b", dense_table(1000), 1000);
+    cache.insert("c", dense_table(1000), 1000);
+    REQUIRE(cache.size() == 3);
+
+    REQUIRE(cache.find("a") != nullptr);             // b is now the oldest
+    cache.insert("d", dense_table(1000), 1000);
+    REQUIRE(cache.find("b") == nullptr);
+    REQUIRE(cache.find("a") != nullptr);
+    REQUIRE(cache.find("c") != nullptr);
+    REQUIRE(cache.find("d") != nullptr);
+    REQUIRE(cache.memory_usage() <= cache.budget());
+
+    cache.insert("huge", dense_table(4000), 4000);   // Larger than the budget: not kept
+    REQUIRE(cache.find("huge") == nullptr);
+    REQUIRE(cache.size() == 3);
+}
+
+TEST_CASE("HashTableCache: concurrent lookups and evictions", "[htcache][concurrent]") {
+    const size_t one = dense_table(1000)->memory_usage();
+    HashTableCache cache(2 * one);
+    cache.insert("a", dense_table(1000), 1000);
+    const auto held = cache.find("a");
+
+    ThreadPool pool(4);
+    std::atomic<size_t> bad_hits{0};                  // Checked after the join: Catch2 asserts on one thread
+    pool.run(8, [&](size_t t) {
+        for (int i = 0; i < 200; ++i) {
+            const std::string key = std::to_string((t + i) % 5);
+            if (const auto hit = cache.find(key)) bad_hits += hit->build_rows != 1000;
+            else cache.insert(key, dense_table(1000), 1000);
+        }
+    });
+    REQUIRE(bad_hits == 0);
+    REQUIRE(cache.size() <= 2);
+    REQUIRE(cache.hits() + cache.misses() == 1 + 8 * 200);
+    REQUIRE(held->build_rows == 1000);                // Evicted, still valid
+    const int32_t keys[] = {5, 999};
+    REQUIRE(held->table->count_batch(keys, 2) == 2);
+}
+
+TEST_CASE("HashTableCache: repeated queries reuse build tables", "[htcache][execute]") {
+    // dim(id, name) JOIN fact(dim_id) ON id, both loaded "from a cache file"
+    auto make_plan = [] {
+        Plan plan;
+        std::vector<std::vector<Data>> dim, fact;
+        for (int i = 0; i < 50; ++i) dim.push_back({i, std::string("d") + std::to_string(i)});
+        for (int i = 0; i < 2000; ++i) fact.push_back({i % 70});
+        auto dim_table = Table(dim, {DataType::INT32, DataType::VARCHAR}).to_columnar();
+        auto fact_table = Table(fact, {DataType::INT32}).to_columnar();
+        dim_table.source = "cache/dim_1.tbl";
+        fact_table.source = "cache/fact_1.tbl";
+        plan.new_input(std::move(dim_table));
+        plan.new_input(std::move(fact_table));
+        const size_t d = plan.new_scan_node(0, {{0, DataType::INT32}, {1, DataType::VARCHAR}});
+        const size_t f = plan.new_scan_node(1, {{0, DataType::INT32}});
+        plan.root = plan.new_join_node(true, d, f, 0, 0, {{1, DataType::VARCHAR}, {2, DataType::INT32}});
+        return plan;
+    };
+
+    void* context = build_context();
+    std::vector<std::vector<std::vector<Data>>> results;
+    for (int run = 0; run < 2; ++run) {
+        Plan plan = make_plan();                     // Fresh tables, as every query loads its inputs
+        auto rows = Table::from_columnar(execute(plan, context)).table();
+        std::sort(rows.begin(), rows.end());
+        results.push_back(std::move(rows));
+    }
+    destroy_context(context);
+
+    REQUIRE(results[0].size() == 2000 / 70 * 50 + std::min(2000 % 70, 50));
+    REQUIRE(results[0] == results[1]);
+}
@@ -229,3 +229,37 @@ TEST_CASE("Late Materialization: deferred column access concept", "[late-mat][de
     // payload_col accessed only for output rows
     REQUIRE(buf.columns.size() == 2);
 }
+
+TEST_CASE("Late Materialization: row-id column reads through its base", "[late-mat][row-id]") {
+    // Zero-copy base: a scan over an INT32 table without NULLs (several pages)
+    Plan plan;
+    std::vector<std::vector<Data>> rows;
+    for (int i = 0; i < 5000; ++i) rows.push_back({i * 3});
+    plan.new_input(Table(rows, {DataType::INT32}).to_columnar());
+    const ScanNode scan{.base_table_id = 0};
+    ColumnBuffer scanned = scan_columnar_to_columnbuffer(plan, scan, {{0, DataType::INT32}});
+    REQUIRE(scanned.columns[0].is_zero_copy);
+
+    // Materialized base with NULLs
+    column_t materialized;
+    for (int i = 0; i < 5000; ++i)
+        materialized.append(i % 7 == 0 ? value_t::make_null() : value_t::make_i32(-i));
+
+    auto row_ids = std::make_shared<std::vector<uint32_t>>();
+    for (uint32_t i = 0; i < 3000; ++i) row_ids->push_back((i * 2654435761u) % 5000);
+
+    for (const column_t* base : {&scanned.columns[0], &materialized}) {
+        column_t view;
+        view.ref_source = std::make_shared<const column_t>(*base);
+        view.row_ids = row_ids;
+        view.num_values = row_ids->size();
+        REQUIRE(view.is_indirect());
+
+        size_t page_cache = 0, base_cache = 0;
+        for (size_t i = 0; i < view.num_values; ++i) {
+            const value_t expected = base->get_cached((*row_ids)[i], base_cache);
+            REQUIRE(view.get_cached(i, page_cache).raw == expected.raw);
+            REQUIRE(view.get(i).raw == expected.raw);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <plan.h>
+#include <table.h>
+#include "join_table_choice.h"
+#include "linear_probing_table.h"
+#include "thread_pool.h"
+
+using namespace Contest;
+
+// ============================================================================
+// ADAPTIVE JOIN TABLE TESTS
+// ============================================================================
+
+// Stats of keys, read in chunks of 1000
+static BuildKeyStats stats_of(const std::vector<int32_t>& keys) {
+    return collect_build_key_stats((keys.size() + 999) / 1000, [&](size_t c, auto&& emit) {
+        for (size_t i = c * 1000; i < std::min(keys.size(), (c + 1) * 1000); ++i) emit(keys[i], static_cast<uint32_t>(i));
+    });
+}
+
+TEST_CASE("DistinctSketch: estimates within a few percent", "[jointable][sketch]") {
+    for (size_t n : {size_t{10}, size_t{1000}, size_t{50000}, size_t{1000000}}) {
+        DistinctSketch sketch;
+        for (size_t i = 0; i < n; ++i) sketch.add(static_cast<int32_t>(i * 2654435761u));
+        for (size_t i = 0; i < n; ++i) sketch.add(static_cast<int32_t>(i * 2654435761u));   // Repeats change nothing
+        REQUIRE(std::abs(sketch.estimate() - static_cast<double>(n)) <= 0.06 * static_cast<double>(n) + 1);
+    }
+    REQUIRE(DistinctSketch{}.estimate() == 0);
+}
+
+TEST_CASE("BuildKeyStats: one parallel pass", "[jointable][stats]") {
+    std::vector<int32_t> keys;
+    for (int32_t i = 0; i < 100000; ++i) keys.push_back((i % 20000) * 13 - 7000);   // 5 rows per key
+
+    ThreadPool pool(4);
+    ThreadPool::install(&pool);
+    const BuildKeyStats stats = stats_of(keys);
+    ThreadPool::install(nullptr);
+
+    REQUIRE(stats.rows == keys.size());
+    REQUIRE(stats.min_key == -7000);
+    REQUIRE(stats.max_key == 19999 * 13 - 7000);
+    REQUIRE(stats.distinct >= 19000);
+    REQUIRE(stats.distinct <= 21000);
+    REQUIRE(stats_of({}).rows == 0);
+}
+
+TEST_CASE("choose_join_table: statistics pick the table", "[jointable][choice]") {
+    auto stats = [](size_t rows, int32_t min_key, int32_t max_key, size_t distinct) {
+        BuildKeyStats s;
+        s.rows = rows;
+        s.min_key = min_key;
+        s.max_key = max_key;
+        s.distinct = distinct;
+        return s;
+    };
+    // Dense primary key
+    REQUIRE(choose_join_table(stats(100000, 1, 100000, 100000), 0) == JoinTable::DenseArray);
+    // Sparse unique keys; below kLinearProbeMinRows the bloom tags reject misses faster
+    REQUIRE(choose_join_table(stats(100000, 0, 1 << 30, 99000), 0) == JoinTable::LinearProbing);
+    REQUIRE(choose_join_table(stats(1000, 0, 1 << 30, 1000), 0) == JoinTable::Unchained);
+    // Duplicates
+    REQUIRE(choose_join_table(stats(100000, 0, 1 << 30, 25000), 0) == JoinTable::Unchained);
+    // Far beyond L2 with as many probes: partitions, unless the probe side is not known
+    REQUIRE(choose_join_table(stats(20000000, 0, 1 << 30, 20000000), 40000000) == JoinTable::Partitioned);
+    REQUIRE(choose_join_table(stats(20000000, 0, 1 << 30, 20000000), 0) == JoinTable::LinearProbing);
+}
+
+TEST_CASE("LinearProbingTable: unique keys, repeated keys fail the build", "[jointable][linear]") {
+    std::vector<HashEntry<int32_t>> entries;
+    for (uint32_t i = 0; i < 100000; ++i) entries.push_back({static_cast<int32_t>(i * 2654435761u), i});
+
+    ThreadPool pool(4);
+    ThreadPool::install(&pool);
+    LinearProbingTable table(entries.size());
+    REQUIRE(table.try_build_from_entries(entries));
+    REQUIRE(table.memory_usage() >= 2 * entries.size() * sizeof(uint64_t));
+
+    // Hits, mostly misses around 0 and -1, whose packed entry resembles an empty slot
+    std::vector<int32_t> keys;
+    for (uint32_t i = 0; i < 100000; i += 3) keys.push_back(entries[i].key);
+    for (int32_t k = -2000; k < 2000; ++k) keys.push_back(k);
+    std::vector<int32_t> build_keys;
+    for (const auto& e : entries) build_keys.push_back(e.key);
+    std::sort(build_keys.begin(), build_keys.end());
+    size_t hits = 0;
+    for (int32_t k : keys) hits += std::binary_search(build_keys.begin(), build_keys.end(), k);
+
+    std::vector<ProbeMatch> matches;
+    table.probe_batch(keys.data(), keys.size(), matches);
+    REQUIRE(matches.size() == hits);
+    REQUIRE(table.count_batch(keys.data(), keys.size()) == hits);
+    for (const ProbeMatch& m : matches) REQUIRE(entries[m.build_row].key == keys[m.probe_idx]);
+
+    size_t len = 0;
+    const HashEntry<int32_t>* cluster = table.probe(entries[7].key, len);
+    REQUIRE(std::any_of(cluster, cluster + len, [&](const HashEntry<int32_t>& e) { return e.row_id == 7; }));
+
+    entries.push_back({entries[500].key, 100000});               // One repeated key
+    LinearProbingTable repeated(entries.size());
+    REQUIRE_FALSE(repeated.try_build_from_entries(entries));
+    REQUIRE(repeated.count_batch(keys.data(), keys.size()) == 0);
+    ThreadPool::install(nullptr);
+}
+
+TEST_CASE("AdaptiveJoinTable: every table kind joins like the reference", "[jointable][execute]") {
+    // fact(k, i) joined with three build sides: sparse unique keys (linear probing), the same
+    // keys with one repeat the sketch cannot see (falls back to unchained) and 4 rows per key
+    std::vector<std::vector<Data>> fact;
+    for (int i = 0; i < 60000; ++i) fact.push_back({(i % 30000) * 1000, i});
+
+    std::vector<std::vector<std::vector<Data>>> dims(3);
+    for (int k = 0; k < 20000; ++k) dims[0].push_back({k * 1000, k});
+    dims[1] = dims[0];
+    dims[1].push_back({7000, 99999});
+    for (int k = 0; k < 20000; ++k)
+        for (int r = 0; r < 4; ++r) dims[2].push_back({k * 1000, k * 4 + r});
+
+    void* context = build_context();
+    for (const auto& dim : dims) {
+        std::vector<std::vector<Data>> expected;
+        for (const auto& d : dim)
+            for (int i = std::get<int32_t>(d[0]) / 1000; i < 60000; i += 30000) expected.push_back({d[1], i});
+        std::sort(expected.begin(), expected.end());
+
+        Plan plan;
+        const size_t td = plan.new_input(Table(dim, {DataType::INT32, DataType::INT32}).to_columnar());
+        const size_t tf = plan.new_input(Table(fact, {DataType::INT32, DataType::INT32}).to_columnar());
+        const size_t d = plan.new_scan_node(td, {{0, DataType::INT32}, {1, DataType::INT32}});
+        const size_t f = plan.new_scan_node(tf, {{0, DataType::INT32}, {1, DataType::INT32}});
+        plan.root = plan.new_join_node(true, d, f, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}});
+        auto rows = Table::from_columnar(execute(plan, context)).table();
+        std::sort(rows.begin(), rows.end());
+        REQUIRE(rows == expected);
+    }
+    destroy_context(context);
+}
@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "numa.h"
+#include "thread_pool.h"
+#include "work_stealing.h"
+
+using namespace Contest;
+
+// ============================================================================
+// NUMA TESTS
+// ============================================================================
+
+TEST_CASE("NUMA: cpulists and sysfs topology", "[numa]") {
+    REQUIRE(parse_cpulist("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    REQUIRE(parse_cpulist("5") == std::vector<int>{5});
+    REQUIRE(parse_cpulist("").empty());
+
+    // Fake sysfs: two nodes with CPUs, one memory-only node
+    const auto root = std::filesystem::temp_directory_path() / "numa_tests_sysfs";
+    std::filesystem::remove_all(root);
+    for (const char* node : {"node0", "node1", "node2"}) std::filesystem::create_directories(root / node);
+    std::ofstream(root / "online") << "0-2\n";
+    std::ofstream(root / "node0" / "cpulist") << "0-3,8-11\n";
+    std::ofstream(root / "node1" / "cpulist") << "4-7,12-15\n";
+    std::ofstream(root / "node2" / "cpulist") << "\n";
+
+    const NumaTopology topo = NumaTopology::parse(root.string());
+    REQUIRE(topo.num_nodes() == 2);
+    REQUIRE(topo.node_ids == std::vector<int>{0, 1});
+    REQUIRE(topo.node_cpus[1] == std::vector<int>{4, 5, 6, 7, 12, 13, 14, 15});
+    REQUIRE(topo.cpu_node[9] == 0);
+    REQUIRE(topo.cpu_node[13] == 1);
+
+    // Threads are spread evenly in blocks
+    REQUIRE(topo.node_of_thread(0, 8) == 0);
+    REQUIRE(topo.node_of_thread(3, 8) == 0);
+    REQUIRE(topo.node_of_thread(4, 8) == 1);
+    REQUIRE(topo.node_of_thread(7, 8) == 1);
+    std::filesystem::remove_all(root);
+
+    REQUIRE(NumaTopology::parse("/nonexistent").num_nodes() == 1);
+    REQUIRE(numa_num_nodes() >= 1);
+    REQUIRE(current_numa_node() < numa_num_nodes());
+}
+
+TEST_CASE("NUMA: node-aware work stealing claims every item once", "[numa][work-stealing]") {
+    for (size_t nodes : {1, 2, 3, 8}) {
+        const size_t total = 100003;
+        NodeAwareCoordinator coordinator(total, 97, nodes);
+        std::vector<std::atomic<int>> claimed(total);
+        ThreadPool pool(4);
+        pool.run(6, [&](size_t tid) {
+            size_t begin, end;
+            while (coordinator.steal_block(tid % nodes, begin, end))
+                for (size_t i = begin; i < end; ++i) claimed[i].fetch_add(1);
+        });
+        for (size_t i = 0; i < total; ++i) REQUIRE(claimed[i].load() == 1);
+    }
+
+    // A thread starts in its own node's range
+    NodeAwareCoordinator coordinator(1000, 10, 2);
+    size_t begin, end;
+    REQUIRE(coordinator.steal_block(1, begin, end));
+    REQUIRE(begin == 500);
+    REQUIRE(end == 510);
+}
+
+TEST_CASE("NUMA: interleaved vectors keep their contents", "[numa]") {
+    std::vector<uint32_t> v;
+    interleaved_resize(v, 1u << 20);
+    REQUIRE(v.size() == (1u << 20));
+    for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<uint32_t>(i);
+    REQUIRE(v[12345] == 12345);
+}
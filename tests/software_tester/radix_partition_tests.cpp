@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "radix_partition.h"
+#include "parallel_unchained_hashtable.h"
+
+using namespace Contest;
+
+// ============================================================================
+// RADIX PARTITIONING TESTS
+// ============================================================================
+
+// Input of 100 "pages" of 1000 keys each, row_id = position
+static PartitionedRelation<int32_t> partition_pages(const std::vector<int32_t>& keys, const RadixPlan& plan,
+                                                    size_t threads) {
+    const size_t page = 1000;
+    return radix_partition<int32_t>((keys.size() + page - 1) / page,
+        [&](size_t chunk, auto&& emit) {
+            for (size_t i = chunk * page; i < std::min(keys.size(), (chunk + 1) * page); ++i)
+                emit(keys[i], static_cast<uint32_t>(i));
+        },
+        plan, threads);
+}
+
+TEST_CASE("RadixPartition: plan selection from cache sizes", "[radix][plan]") {
+    // Small build sides are cache resident -> no partitioning
+    REQUIRE_FALSE(choose_radix_plan(1000, 1u << 22).enabled());
+
+    // Few probes against a large build -> not worth two extra passes
+    REQUIRE_FALSE(choose_radix_plan(1u << 24, 1000).enabled());
+
+    // Large build: every partition table fits the L2 budget
+    const RadixPlan plan = choose_radix_plan(1u << 24, 1u << 24);
+    REQUIRE(plan.enabled());
+    REQUIRE(plan.bits1 <= kRadixMaxBitsPerPass);
+    REQUIRE(((std::size_t{1} << 24) * kRadixTableBytesPerTuple >> plan.total_bits()) <= kRadixTableBudget);
+
+    // Huge build needs more fan-out than one pass can do
+    const RadixPlan two_pass = choose_radix_plan(std::size_t{1} << 30, std::size_t{1} << 30);
+    REQUIRE(two_pass.bits1 == kRadixMaxBitsPerPass);
+    REQUIRE(two_pass.bits2 > 0);
+}
+
+TEST_CASE("RadixPartition: one and two passes keep every tuple in its partition", "[radix][partition]") {
+    std::vector<int32_t> keys;
+    for (int i = 0; i < 100000; ++i) keys.push_back((i * 2654435761u) % 30000);
+
+    for (RadixPlan plan : {RadixPlan{4, 0}, RadixPlan{3, 2}}) {
+        for (size_t threads : {1, 4}) {
+            auto parts = partition_pages(keys, plan, threads);
+            REQUIRE(parts.num_partitions() == plan.num_partitions());
+            REQUIRE(parts.tuples.size() == keys.size());
+
+            Hash::Hasher32 hasher;
+            std::vector<uint32_t> seen;
+            for (size_t p = 0; p < parts.num_partitions(); ++p) {
+                for (size_t i = 0; i < parts.partition_size(p); ++i) {
+                    const auto& e = parts.partition(p)[i];
+                    const uint64_t h = hasher(e.key);
+                    const size_t radix = (radix_of(h, 0, plan.bits1) << plan.bits2) | radix_of(h, plan.bits1, plan.bits2);
+                    REQUIRE(radix == p);
+                    REQUIRE(keys[e.row_id] == e.key);
+                    seen.push_back(e.row_id);
+                }
+            }
+            std::sort(seen.begin(), seen.end());
+            for (size_t i = 0; i < seen.size(); ++i) REQUIRE(seen[i] == i);
+        }
+    }
+}
+
+TEST_CASE("RadixPartition: partition-wise join equals a single-table join", "[radix][join]") {
+    std::vector<int32_t> build, probe;
+    for (int i = 0; i < 20000; ++i) build.push_back(i % 5000);   // 4 matches per key
+    for (int i = 0; i < 30000; ++i) probe.push_back(i % 7000);   // Keys >= 5000 miss
+
+    const RadixPlan plan{5, 0};
+    auto bp = partition_pages(build, plan, 2);
+    auto pp = partition_pages(probe, plan, 2);
+
+    size_t matches = 0;
+    FlatUnchainedHashTable<int32_t> table;
+    for (size_t p = 0; p < plan.num_partitions(); ++p) {
+        table.reserve(bp.partition_size(p));
+        table.build_from_entries(bp.partition(p), bp.partition_size(p));
+        for (size_t j = 0; j < pp.partition_size(p); ++j) {
+            size_t len = 0;
+            const auto* bucket = table.probe(pp.partition(p)[j].key, len);
+            for (size_t k = 0; k < len; ++k) matches += bucket[k].key == pp.partition(p)[j].key;
+        }
+    }
+
+    size_t expected = 0;
+    for (int32_t k : probe) expected += k < 5000 ? 4 : 0;
+    REQUIRE(matches == expected);
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include <cstdint>
+#include "runtime_filter.h"
+
+using namespace Contest;
+
+// ============================================================================
+// RUNTIME JOIN FILTER TESTS
+// ============================================================================
+
+TEST_CASE("RuntimeFilter: no false negatives", "[runtime-filter][bloom]") {
+    RuntimeFilter filter(50000);
+    for (int32_t k = 0; k < 50000; ++k) filter.insert(k * 7 - 100000);
+
+    for (int32_t k = 0; k < 50000; ++k) REQUIRE(filter.may_contain(k * 7 - 100000));
+    REQUIRE(filter.num_keys() == 50000);
+}
+
+TEST_CASE("RuntimeFilter: false positive rate stays low", "[runtime-filter][bloom]") {
+    RuntimeFilter filter(10000);
+    for (int32_t k = 0; k < 10000; ++k) filter.insert(k * 2);  // Even keys only
+
+    // Odd keys inside [min, max] pass only as Bloom false positives
+    size_t false_positives = 0;
+    for (int32_t k = 1; k < 20000; k += 2) false_positives += filter.may_contain(k);
+    REQUIRE(false_positives < 10000 / 50);                      // < 2%
+
+    REQUIRE(filter.memory_bytes() * 8 >= 10000 * kRuntimeFilterBitsPerKey);
+}
+
+TEST_CASE("RuntimeFilter: min/max range rejects outside keys", "[runtime-filter][range]") {
+    RuntimeFilter filter(100);
+    for (int32_t k = 500; k < 600; ++k) filter.insert(k);
+
+    REQUIRE(filter.min_key() == 500);
+    REQUIRE(filter.max_key() == 599);
+    REQUIRE_FALSE(filter.may_contain(499));
+    REQUIRE_FALSE(filter.may_contain(600));
+    REQUIRE_FALSE(filter.may_contain(-1));
+}
+
+TEST_CASE("RuntimeFilter: empty filter rejects everything", "[runtime-filter][empty]") {
+    RuntimeFilter filter(0);
+    REQUIRE_FALSE(filter.may_contain(0));
+    REQUIRE_FALSE(filter.may_contain(INT32_MIN));
+    REQUIRE_FALSE(filter.may_contain(INT32_MAX));
+}
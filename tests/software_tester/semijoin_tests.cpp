@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include <cstdint>
+#include <plan.h>
+#include <table.h>
+#include "test_helpers.h"
+#include "semijoin.h"
+
+using namespace Contest;
+
+// ============================================================================
+// SEMI-JOIN REDUCTION TESTS
+// ============================================================================
+
+// A(x) JOIN B(x, y) ON x, then JOIN C(y) ON y
+static Plan chain_plan() {
+    Plan plan;
+    const size_t ta = add_table(plan, {{1}, {2}, {3}, {std::monostate{}}}, {DataType::INT32});
+    const size_t tb = add_table(plan, {{1, 10}, {2, 20}, {2, 21}, {4, 10}},
+                                {DataType::INT32, DataType::INT32});
+    const size_t tc = add_table(plan, {{10}, {21}, {30}}, {DataType::INT32});
+
+    const size_t a = plan.new_scan_node(ta, {{0, DataType::INT32}});
+    const size_t b = plan.new_scan_node(tb, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t c = plan.new_scan_node(tc, {{0, DataType::INT32}});
+
+    // Output of ab: a.x, b.x, b.y
+    const size_t ab = plan.new_join_node(true, a, b, 0, 0,
+                                         {{0, DataType::INT32}, {1, DataType::INT32}, {2, DataType::INT32}});
+    plan.root = plan.new_join_node(false, ab, c, 2, 0, {{0, DataType::INT32}, {3, DataType::INT32}});
+    return plan;
+}
+
+TEST_CASE("SemiJoin: join keys trace back to base columns", "[semijoin][trace]") {
+    Plan plan = chain_plan();
+    const auto& root = std::get<JoinNode>(plan.nodes[plan.root].data);
+
+    // Key b.y of the first join output comes from column 1 of scan b
+    const auto [scan, col] = trace_to_scan(plan, root.left, root.left_attr);
+    REQUIRE(scan == 1);
+    REQUIRE(col == 1);
+}
+
+TEST_CASE("SemiJoin: two passes keep exactly the rows of the result", "[semijoin][reduce]") {
+    Plan plan = chain_plan();
+    const auto keep = semijoin_reduce(plan);
+    REQUIRE(keep.size() == plan.nodes.size());
+
+    // Result rows: (1, 1, 10), (2, 2, 21)
+    REQUIRE(keep[0] == std::vector<uint8_t>{1, 1, 0, 0});   // A: 3 has no B partner, NULL never joins
+    REQUIRE(keep[1] == std::vector<uint8_t>{1, 0, 1, 0});   // B: (2,20) misses C, (4,10) misses A
+    REQUIRE(keep[2] == std::vector<uint8_t>{1, 1, 0});      // C: 30 misses B
+
+    // Join nodes carry no selection
+    REQUIRE(keep[3].empty());
+    REQUIRE(keep[4].empty());
+}
+
+TEST_CASE("SemiJoin: sparse keys use the hash set path", "[semijoin][sparse]") {
+    Plan plan;
+    std::vector<std::vector<Data>> left, right;
+    for (int32_t i = 0; i < 1000; ++i) left.push_back({i * 1000003});
+    for (int32_t i = 0; i < 1000; i += 3) right.push_back({i * 1000003});
+    const size_t l = plan.new_scan_node(add_table(plan, left, {DataType::INT32}), {{0, DataType::INT32}});
+    const size_t r = plan.new_scan_node(add_table(plan, right, {DataType::INT32}), {{0, DataType::INT32}});
+    plan.root = plan.new_join_node(true, l, r, 0, 0, {{0, DataType::INT32}});
+
+    const auto keep = semijoin_reduce(plan);
+    for (size_t i = 0; i < left.size(); ++i) REQUIRE(keep[l][i] == (i % 3 == 0));
+    for (size_t i = 0; i < right.size(); ++i) REQUIRE(keep[r][i] == 1);
+}
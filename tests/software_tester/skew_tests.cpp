@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <plan.h>
+#include <table.h>
+#include "skew.h"
+#include "test_helpers.h"
+#include "unchained_hashtable_wrapper.h"
+
+using namespace Contest;
+
+// ============================================================================
+// SKEW HANDLING TESTS
+// ============================================================================
+
+TEST_CASE("HeavyHitters: frequent build keys are found and confirmed", "[skew]") {
+    // Key 7 x 10000, key 9 x 5000, key 11 x 3000 (below the threshold), 60000 unique keys
+    std::vector<HashEntry<int32_t>> entries;
+    for (uint32_t r = 0; r < 10000; ++r) entries.push_back({7, r});
+    for (uint32_t r = 0; r < 5000; ++r) entries.push_back({9, 10000 + r});
+    for (uint32_t r = 0; r < 3000; ++r) entries.push_back({11, 15000 + r});
+    for (int32_t k = 0; k < 60000; ++k) entries.push_back({100 + k, static_cast<uint32_t>(18000 + k)});
+    std::vector<int32_t> keys;
+    for (const auto& e : entries) keys.push_back(e.key);
+    std::reverse(keys.begin(), keys.end());            // Sampling must not depend on the order
+
+    UnchainedHashTableWrapper<int32_t> table;
+    table.reserve(entries.size());
+    table.build_from_entries(entries);
+
+    for (size_t stride : {size_t{1}, size_t{7}}) {    // Exact counts / a sample
+        std::vector<int32_t> sample;
+        for (size_t i = 0; i < keys.size(); i += stride) sample.push_back(keys[i]);
+        const HeavyHitters heavy = HeavyHitters::detect(table, sample, keys.size());
+        REQUIRE(heavy.size() == 2);
+        REQUIRE(heavy.key(0) == 7);                    // Most frequent first
+        REQUIRE(heavy.rows(0).size() == 10000);
+        REQUIRE(heavy.find(9) == 1);
+        REQUIRE(heavy.rows(1).size() == 5000);
+        REQUIRE(*std::min_element(heavy.rows(1).begin(), heavy.rows(1).end()) == 10000);
+        REQUIRE(heavy.find(11) == -1);
+        REQUIRE(heavy.find(100) == -1);
+    }
+
+    REQUIRE(HeavyHitters::detect(table, {}, keys.size()).empty());
+    REQUIRE(HeavyHitters::detect(table, {7, 7, 7}, 3).empty());   // Too small to be skewed
+}
+
+TEST_CASE("SkewJoin: split heavy-hitter output matches the plain join", "[skew][execute]") {
+    // dim(k, v): key 0 x 5000 plus keys 1..999 once; fact(k, i): k = i % 1000
+    std::vector<std::vector<Data>> dim, fact;
+    for (int r = 0; r < 5000; ++r) dim.push_back({0, r});
+    for (int k = 1; k < 1000; ++k) dim.push_back({k, 10000 + k});
+    for (int i = 0; i < 50000; ++i) fact.push_back({i % 1000, i});
+
+    std::vector<std::vector<Data>> expected;
+    for (int i = 0; i < 50000; ++i) {
+        if (i % 1000 == 0)
+            for (int r = 0; r < 5000; ++r) expected.push_back({r, i});
+        else
+            expected.push_back({10000 + i % 1000, i});
+    }
+    std::sort(expected.begin(), expected.end());
+
+    setenv("FORCE_THREADS", "4", 1);                   // Detection needs a parallel probe
+    void* context = build_context();
+    for (bool build_left : {true, false}) {
+        Plan plan;
+        const size_t td = plan.new_input(Table(dim, {DataType::INT32, DataType::INT32}).to_columnar());
+        const size_t tf = plan.new_input(Table(fact, {DataType::INT32, DataType::INT32}).to_columnar());
+        const size_t d = plan.new_scan_node(td, {{0, DataType::INT32}, {1, DataType::INT32}});
+        const size_t f = plan.new_scan_node(tf, {{0, DataType::INT32}, {1, DataType::INT32}});
+        plan.root = build_left
+            ? plan.new_join_node(true, d, f, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}})
+            : plan.new_join_node(false, f, d, 0, 0, {{3, DataType::INT32}, {1, DataType::INT32}});
+        auto rows = Table::from_columnar(execute(plan, context)).table();
+        std::sort(rows.begin(), rows.end());
+        REQUIRE(rows == expected);
+    }
+    destroy_context(context);
+    unsetenv("FORCE_THREADS");
+}
+
+TEST_CASE("SkewJoin: pipelined stages split their heavy-hitter matches", "[skew][pipeline]") {
+    // dimB(k, b) JOIN (dimA(k, a) JOIN fact(k1, k2, i) ON k = k1) ON k = k2. Both dimensions hold
+    // key 0 x 5000: fact rows i % 2000 == 0 meet it in the first stage, i % 2000 == 7 in the second.
+    std::vector<std::vector<Data>> dim_a, dim_b, fact;
+    for (int r = 0; r < 5000; ++r) dim_a.push_back({0, r});
+    for (int k = 1; k < 2000; ++k) dim_a.push_back({k, 10000 + k});
+    for (int r = 0; r < 5000; ++r) dim_b.push_back({0, 20000 + r});
+    for (int k = 1; k < 10; ++k) dim_b.push_back({k, 30000 + k});
+    for (int i = 0; i < 20000; ++i) fact.push_back({i % 2000, i % 2000 == 7 ? 0 : 1 + i % 9, i});
+
+    std::vector<std::vector<Data>> expected;
+    for (int i = 0; i < 20000; ++i) {
+        const int k2 = i % 2000 == 7 ? 0 : 1 + i % 9;
+        std::vector<int> as, bs;
+        if (i % 2000 == 0) for (int r = 0; r < 5000; ++r) as.push_back(r);
+        else as.push_back(10000 + i % 2000);
+        if (k2 == 0) for (int r = 0; r < 5000; ++r) bs.push_back(20000 + r);
+        else bs.push_back(30000 + k2);
+        for (int a : as)
+            for (int b : bs) expected.push_back({b, a, i});
+    }
+    std::sort(expected.begin(), expected.end());
+
+    Plan plan;
+    const size_t ta = add_table(plan, dim_a, {DataType::INT32, DataType::INT32});
+    const size_t tb = add_table(plan, dim_b, {DataType::INT32, DataType::INT32});
+    const size_t tf = add_table(plan, fact, {DataType::INT32, DataType::INT32, DataType::INT32});
+    const size_t a = plan.new_scan_node(ta, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t b = plan.new_scan_node(tb, {{0, DataType::INT32}, {1, DataType::INT32}});
+    const size_t f = plan.new_scan_node(tf, {{0, DataType::INT32}, {1, DataType::INT32}, {2, DataType::INT32}});
+    // (dimA.a, fact.k2, fact.i), then (dimB.b, dimA.a, fact.i)
+    const size_t af = plan.new_join_node(true, a, f, 0, 0, {{1, DataType::INT32}, {3, DataType::INT32}, {4, DataType::INT32}});
+    plan.root = plan.new_join_node(true, b, af, 0, 1, {{1, DataType::INT32}, {2, DataType::INT32}, {4, DataType::INT32}});
+
+    setenv("FORCE_THREADS", "4", 1);                   // Detection needs a parallel probe
+    const auto rows = run(plan);
+    unsetenv("FORCE_THREADS");
+    REQUIRE(rows == expected);
+}
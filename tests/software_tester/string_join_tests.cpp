@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <plan.h>
+#include <table.h>
+#include "test_helpers.h"
+#include "late_materialization.h"
+
+using namespace Contest;
+
+// ============================================================================
+// VARCHAR JOIN KEY TESTS
+// ============================================================================
+
+// Ref of row `row` of a single-page VARCHAR column / of a long string starting at `page`
+static uint64_t slot_ref(size_t table, uint32_t page, uint16_t row) {
+    return PackedStringRef(static_cast<uint8_t>(table), 0, page, row).raw;
+}
+
+TEST_CASE("StringRefResolver: hash and equality follow the bytes, not the refs", "[string-join][resolver]") {
+    Plan plan;
+    const std::string long_a(20000, 'x');
+    std::string long_b = long_a;
+    long_b.back() = 'y';                                  // Same first page, different tail
+    const size_t t0 = add_table(plan, {{"alpha"}, {"beta"}, {""}}, {DataType::VARCHAR});
+    const size_t t1 = add_table(plan, {{"beta"}, {"alpha"}, {"alphabet"}}, {DataType::VARCHAR});
+    const size_t t2 = add_table(plan, {{long_a}}, {DataType::VARCHAR});
+    const size_t t3 = add_table(plan, {{long_a}}, {DataType::VARCHAR});
+    const size_t t4 = add_table(plan, {{long_b}}, {DataType::VARCHAR});
+
+    const StringRefResolver resolver(&plan);
+    REQUIRE(resolver.equal(slot_ref(t0, 0, 0), slot_ref(t1, 0, 1)));
+    REQUIRE(resolver.hash(slot_ref(t0, 0, 0)) == resolver.hash(slot_ref(t1, 0, 1)));
+    REQUIRE(resolver.equal(slot_ref(t0, 0, 1), slot_ref(t1, 0, 0)));
+    REQUIRE_FALSE(resolver.equal(slot_ref(t0, 0, 0), slot_ref(t1, 0, 2)));   // Prefix only
+    REQUIRE_FALSE(resolver.equal(slot_ref(t0, 0, 2), slot_ref(t0, 0, 0)));   // Empty string
+    REQUIRE(resolver.hash(slot_ref(t0, 0, 0)) != resolver.hash(slot_ref(t1, 0, 2)));
+
+    // Long strings span several pages and compare chunk by chunk
+    REQUIRE(resolver.equal(slot_ref(t2, 0, 0xffff), slot_ref(t3, 0, 0xffff)));
+    REQUIRE(resolver.hash(slot_ref(t2, 0, 0xffff)) == resolver.hash(slot_ref(t3, 0, 0xffff)));
+    REQUIRE_FALSE(resolver.equal(slot_ref(t2, 0, 0xffff), slot_ref(t4, 0, 0xffff)));
+    REQUIRE(resolver.hash(slot_ref(t2, 0, 0xffff)) != resolver.hash(slot_ref(t4, 0, 0xffff)));
+    REQUIRE_FALSE(resolver.equal(slot_ref(t2, 0, 0xffff), slot_ref(t0, 0, 0)));
+}
+
+TEST_CASE("StringJoin: VARCHAR keys join on equal strings", "[string-join][execute]") {
+    // person(name, id) JOIN city(name, code) ON name; NULL names never join
+    std::vector<std::vector<Data>> person, city;
+    for (int i = 0; i < 3000; ++i) {
+        if (i % 100 == 7) person.push_back({std::monostate{}, i});
+        else person.push_back({std::string("city-") + std::to_string(i % 40), i});
+    }
+    for (int c = 0; c < 30; ++c) city.push_back({std::string("city-") + std::to_string(c), c});
+    city.push_back({std::monostate{}, -1});
+
+    std::vector<std::vector<Data>> expected;
+    for (auto& row : person) {
+        if (std::holds_alternative<std::monostate>(row[0])) continue;
+        const int code = std::stoi(std::get<std::string>(row[0]).substr(5));
+        if (code < 30) expected.push_back({row[1], code});
+    }
+    std::sort(expected.begin(), expected.end());
+
+    for (bool build_left : {true, false}) {
+        Plan plan;
+        const size_t tp = add_table(plan, person, {DataType::VARCHAR, DataType::INT32});
+        const size_t tc = add_table(plan, city, {DataType::VARCHAR, DataType::INT32});
+        const size_t p = plan.new_scan_node(tp, {{0, DataType::VARCHAR}, {1, DataType::INT32}});
+        const size_t c = plan.new_scan_node(tc, {{0, DataType::VARCHAR}, {1, DataType::INT32}});
+        plan.root = plan.new_join_node(build_left, c, p, 0, 0, {{3, DataType::INT32}, {1, DataType::INT32}});
+        REQUIRE(run(plan) == expected);
+    }
+}
+
+TEST_CASE("StringJoin: VARCHAR join between INT32 joins", "[string-join][pipeline]") {
+    // ((a JOIN b ON id) JOIN c ON name) JOIN d ON code
+    Plan plan;
+    const size_t ta = add_table(plan, {{1}, {2}, {3}}, {DataType::INT32});
+    const size_t tb = add_table(plan, {{1, "x"}, {2, "y"}, {3, "z"}, {3, "x"}}, {DataType::INT32, DataType::VARCHAR});
+    const size_t tc = add_table(plan, {{"x", 10}, {"y", 20}, {"w", 30}}, {DataType::VARCHAR, DataType::INT32});
+    const size_t td = add_table(plan, {{10}, {20}, {20}}, {DataType::INT32});
+    const size_t a = plan.new_scan_node(ta, {{0, DataType::INT32}});
+    const size_t b = plan.new_scan_node(tb, {{0, DataType::INT32}, {1, DataType::VARCHAR}});
+    const size_t c = plan.new_scan_node(tc, {{0, DataType::VARCHAR}, {1, DataType::INT32}});
+    const size_t d = plan.new_scan_node(td, {{0, DataType::INT32}});
+
+    // ab: a.id, b.name; abc: a.id, c.code; root: a.id, d.code
+    const size_t ab = plan.new_join_node(true, a, b, 0, 0, {{0, DataType::INT32}, {2, DataType::VARCHAR}});
+    const size_t abc = plan.new_join_node(false, ab, c, 1, 0, {{0, DataType::INT32}, {3, DataType::INT32}});
+    plan.root = plan.new_join_node(false, abc, d, 1, 0, {{0, DataType::INT32}, {2, DataType::INT32}});
+
+    const std::vector<std::vector<Data>> expected = {{1, 10}, {2, 20}, {2, 20}, {3, 10}};
+    REQUIRE(run(plan) == expected);
+}
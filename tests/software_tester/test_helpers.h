@@ -0,0 +1,39 @@
+// test_helpers.h - plan building and execution helpers shared by the software tester suites
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <plan.h>
+#include <table.h>
+
+namespace Contest {
+
+// Execution context that is destroyed on scope exit, also when execute() throws
+class ContextGuard {
+public:
+    ContextGuard() : context_(build_context()) {}
+    ~ContextGuard() { destroy_context(context_); }
+
+    ContextGuard(const ContextGuard&) = delete;
+    ContextGuard& operator=(const ContextGuard&) = delete;
+
+    void* get() const { return context_; }
+
+private:
+    void* context_;
+};
+
+// Add rows as a new input of plan; returns its index
+inline size_t add_table(Plan& plan, const std::vector<std::vector<Data>>& rows, std::vector<DataType> types) {
+    return plan.new_input(Table(rows, types).to_columnar());
+}
+
+// Rows of plan executed in a fresh context, sorted
+inline std::vector<std::vector<Data>> run(const Plan& plan) {
+    ContextGuard context;
+    auto rows = Table::from_columnar(execute(plan, context.get())).table();
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+} // namespace Contest
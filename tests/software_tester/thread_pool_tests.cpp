@@ -0,0 +1,90 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+#include "thread_pool.h"
+
+using namespace Contest;
+
+// ============================================================================
+// THREAD POOL TESTS
+// ============================================================================
+
+TEST_CASE("ThreadPool: every task runs exactly once", "[thread-pool][run]") {
+    ThreadPool pool(4);
+    REQUIRE(pool.num_threads() == 4);
+
+    std::vector<std::atomic<int>> hits(1000);
+    for (int round = 0; round < 20; ++round) {             // Workers are reused across jobs
+        pool.run(hits.size(), [&](size_t t) { hits[t].fetch_add(1); });
+    }
+    for (auto& h : hits) REQUIRE(h.load() == 20);
+}
+
+TEST_CASE("ThreadPool: nested jobs complete", "[thread-pool][nested]") {
+    ThreadPool pool(3);
+    std::atomic<size_t> sum{0};
+
+    // Every outer task waits for an inner job while all workers may be busy
+    pool.run(8, [&](size_t outer) {
+        pool.run(16, [&](size_t inner) { sum.fetch_add(outer * 16 + inner); });
+    });
+    REQUIRE(sum.load() == (128 * 127) / 2);
+}
+
+TEST_CASE("ThreadPool: morsels cover the range without overlap", "[thread-pool][morsel]") {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> covered(100003);
+
+    std::atomic<int> empty_morsels{0};                     // Catch2 asserts on this thread only
+    pool.for_each_morsel(covered.size(), 1024, [&](size_t begin, size_t end) {
+        if (begin >= end) empty_morsels.fetch_add(1);
+        for (size_t i = begin; i < end; ++i) covered[i].fetch_add(1);
+    });
+    REQUIRE(empty_morsels.load() == 0);
+    for (auto& c : covered) REQUIRE(c.load() == 1);
+
+    // Empty and single-morsel ranges
+    size_t calls = 0;
+    pool.for_each_morsel(0, 1024, [&](size_t, size_t) { ++calls; });
+    REQUIRE(calls == 0);
+    pool.for_each_morsel(10, 1024, [&](size_t begin, size_t end) { calls += end - begin; });
+    REQUIRE(calls == 10);
+}
+
+TEST_CASE("ThreadPool: installed pool becomes current", "[thread-pool][context]") {
+    ThreadPool& fallback = ThreadPool::current();
+    {
+        ThreadPool pool(2);
+        ThreadPool::install(&pool);
+        REQUIRE(&ThreadPool::current() == &pool);
+        ThreadPool::install(nullptr);
+    }
+    REQUIRE(&ThreadPool::current() == &fallback);
+}
+
+TEST_CASE("ThreadPool: a throwing task reaches the caller after the job ends", "[thread-pool][exception]") {
+    ThreadPool pool(4);
+    for (size_t thrower : {size_t{0}, size_t{37}, size_t{999}}) {
+        std::atomic<size_t> ran{0};
+        REQUIRE_THROWS_AS(pool.run(1000, [&](size_t t) {
+            if (t == thrower) throw std::runtime_error("task failed");
+            ran.fetch_add(1);
+        }), std::runtime_error);
+        REQUIRE(ran.load() < 1000);                         // Later tasks may be skipped
+    }
+
+    // Nested jobs and morsels rethrow the same way; the pool stays usable
+    REQUIRE_THROWS_AS(pool.run(8, [&](size_t outer) {
+        pool.run(16, [&](size_t inner) {
+            if (outer == 3 && inner == 5) throw std::runtime_error("inner task failed");
+        });
+    }), std::runtime_error);
+    REQUIRE_THROWS_AS(pool.for_each_morsel(100000, 1024, [](size_t begin, size_t) {
+        if (begin == 0) throw std::runtime_error("morsel failed");
+    }), std::runtime_error);
+
+    std::atomic<size_t> sum{0};
+    pool.run(100, [&](size_t t) { sum.fetch_add(t); });
+    REQUIRE(sum.load() == 99 * 100 / 2);
+}